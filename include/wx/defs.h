@@ -275,6 +275,26 @@ typedef short int WXTYPE;
     #define wxOVERRIDE
 #endif /*  HAVE_OVERRIDE/!HAVE_EXPLICIT */
 
+/* check for rvalue references support */
+#ifndef wxHAS_RVALUE_REF
+    #if __cplusplus >= 201103L || wxCHECK_VISUALC_VERSION(10)
+        #define wxHAS_RVALUE_REF
+    #endif
+#endif /* !wxHAS_RVALUE_REF */
+
+/* check for noexcept support */
+#ifndef wxHAS_NOEXCEPT
+    #if __cplusplus >= 201103L || wxCHECK_VISUALC_VERSION(14)
+        #define wxHAS_NOEXCEPT
+    #endif
+#endif /* !wxHAS_NOEXCEPT */
+
+#ifdef wxHAS_NOEXCEPT
+    #define wxNOEXCEPT noexcept
+#else /* !wxHAS_NOEXCEPT */
+    #define wxNOEXCEPT
+#endif /* wxHAS_NOEXCEPT/!wxHAS_NOEXCEPT */
+
 /* wxFALLTHROUGH is used to notate explicit fallthroughs in switch statements */
 
 #if __cplusplus >= 201103L && defined(__has_warning)
@@ -225,6 +225,9 @@ private:
   // if path doesn't exist and createMissingComponents == false
   bool DoSetPath(const wxString& strPath, bool createMissingComponents);
 
+  // forget the previous path, must be called when it could become invalid
+  void ResetPrevPath();
+
   // set/test the dirty flag
   void SetDirty() { m_isDirty = true; }
   void ResetDirty() { m_isDirty = false; }
@@ -243,6 +246,11 @@ private:
   wxFileConfigGroup *m_pRootGroup,      // the top (unnamed) group
                     *m_pCurrentGroup;   // the current group
 
+  // the path used before the current one and its group (may be NULL), this
+  // is used to switch back to it without looking up the group again
+  wxString    m_strPrevPath;
+  wxFileConfigGroup *m_pPrevGroup;
+
   wxMBConv    *m_conv;
 
 #ifdef __UNIX__
@@ -18,6 +18,7 @@
 #include "wx/selstore.h"
 #include "wx/timer.h"
 #include "wx/settings.h"
+#include "wx/vector.h"
 
 // ============================================================================
 // private classes
@@ -418,6 +419,92 @@ private:
     wxListMainWindow *m_owner;
 };
 
+//-----------------------------------------------------------------------------
+// wxListFindIndex (internal)
+//-----------------------------------------------------------------------------
+
+// This class allows to find the items whose labels start with the given
+// string, ignoring case, without examining all of them: it keeps the lower
+// cased labels of all items sorted alphabetically.
+//
+// It is built on demand, when the items are searched for the first time, and
+// then updated when they change. As each update takes linear time, the index
+// is discarded, to be rebuilt during the next search, if too many changes are
+// done in between, e.g. when filling the control.
+class wxListFindIndex
+{
+public:
+    wxListFindIndex() : m_built(false), m_updates(0) { }
+    ~wxListFindIndex() { Clear(); }
+
+    bool IsBuilt() const { return m_built; }
+
+    // Discard the index, it will need to be rebuilt before being used again.
+    void Clear();
+
+    // Build the index from scratch: call Add() for all the items, in order,
+    // and then EndBuild().
+    void BeginBuild(size_t count);
+    void Add(const wxString& label);
+    void EndBuild();
+
+    // Update the index after the item was inserted, deleted or its label
+    // changed. This does nothing if the index is not built.
+    void OnItemInserted(size_t item, const wxString& label);
+    void OnItemDeleted(size_t item);
+    void OnItemChanged(size_t item, const wxString& label);
+
+    // Return the first item not less than start whose label starts with the
+    // given string (or is equal to it if partial is false), or the first such
+    // item before start if wrap is true, or (size_t)-1 if there is none.
+    size_t Find(size_t start,
+                const wxString& str,
+                bool partial,
+                bool wrap = false);
+
+private:
+    struct Entry
+    {
+        bool operator<(const Entry& other) const
+        {
+            const int rc = label->compare(*other.label);
+            return rc < 0 || (rc == 0 && item < other.item);
+        }
+
+        // lower cased label of the item, owned by this object
+        wxString *label;
+
+        // index of the item in the control
+        size_t item;
+    };
+
+    // Insert the given entry at its sorted position.
+    void Insert(const Entry& entry);
+
+    // Remove the entry for the given item and return its position or
+    // (size_t)-1 if not found, optionally shifting down the following items.
+    size_t Remove(size_t item, bool shift);
+
+    // Account for an update of the index, clearing it if there were too many
+    // of them since the last search, and return true if it's still built.
+    bool CountUpdate();
+
+    // the entries sorted by their labels and then item indices
+    wxVector<Entry> m_entries;
+
+    // the positions of the entries in m_entries indexed by their items,
+    // computed by Find() when needed and empty if they must be recomputed
+    wxVector<size_t> m_positions;
+
+    // false if the index must be rebuilt before using it
+    bool m_built;
+
+    // the number of updates since the last search
+    unsigned m_updates;
+
+    wxDECLARE_NO_COPY_CLASS(wxListFindIndex);
+};
+
 //-----------------------------------------------------------------------------
 // wxListTextCtrlWrapper: wraps a wxTextCtrl to make it work for inline editing
 //-----------------------------------------------------------------------------
@@ -774,6 +861,9 @@ protected:
     // incremental search data
     wxString             m_findPrefix;
     wxTimer             *m_findTimer;
+    // The index used for searching the items of non-virtual controls, it's
+    // mutable as it's built on demand.
+    mutable wxListFindIndex m_findIndex;
     // This flag is set to 0 if the bell is disabled, 1 if it is enabled and -1
     // if it is globally enabled but has been temporarily disabled because we
     // had already beeped for this particular search.
@@ -834,6 +924,9 @@ protected:
     // find the first item starting with the given prefix after the given item
     size_t PrefixFindItem(size_t item, const wxString& prefix) const;
 
+    // get m_findIndex, building it if necessary
+    wxListFindIndex& GetFindIndex() const;
+
     // get the colour to be used for drawing the rules
     wxColour GetRuleColour() const
     {
@@ -0,0 +1,200 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        wx/generic/private/rowheightcache.h
+// Purpose:     wxRowHeightCache helper class.
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_GENERIC_PRIVATE_ROWHEIGHTCACHE_H_
+#define _WX_GENERIC_PRIVATE_ROWHEIGHTCACHE_H_
+
+#include "wx/defs.h"
+
+#if wxUSE_DATAVIEWCTRL
+
+#include "wx/vector.h"
+
+// ----------------------------------------------------------------------------
+// wxRowHeightCache: cumulative heights of rows of variable height
+// ----------------------------------------------------------------------------
+
+// This class stores the heights of the first GetCount() rows of a control
+// in a Fenwick (binary indexed) tree, which allows to find both the vertical
+// position of the given row and the row at the given position in logarithmic
+// time. The heights of the rows after the cached ones are unknown, the owner
+// of the cache is supposed to Append() them when they become needed.
+//
+// Notice that truncating the cache keeps the tree valid as each of its nodes
+// only depends on the heights of the rows preceding it, which is also what
+// makes appending to it cheap.
+class wxRowHeightCache
+{
+public:
+    wxRowHeightCache() { }
+
+    // Return the number of rows with known heights.
+    unsigned GetCount() const { return m_heights.size(); }
+    bool IsEmpty() const { return m_heights.empty(); }
+
+    // Forget all the heights, e.g. because the rows were reordered.
+    void Clear()
+    {
+        m_heights.clear();
+        m_tree.clear();
+    }
+
+    // Forget the heights of all rows starting from the given one.
+    void Truncate(unsigned row)
+    {
+        if ( row < GetCount() )
+        {
+            m_heights.resize(row);
+            m_tree.resize(row);
+        }
+    }
+
+    // Return the height of the given row, which must be less than GetCount().
+    int GetHeight(unsigned row) const { return m_heights[row]; }
+
+    // Return the sum of the heights of all rows preceding the given one, which
+    // can also be equal to GetCount() to return the total height.
+    int GetStart(unsigned row) const
+    {
+        wxASSERT_MSG( row <= GetCount(), "row height is not cached" );
+
+        int start = 0;
+        for ( ; row; row &= row - 1 )
+            start += m_tree[row - 1];
+
+        return start;
+    }
+
+    int GetTotalHeight() const { return GetStart(GetCount()); }
+
+    // Return the row containing the given position or GetCount() if the
+    // position is beyond the last cached row.
+    unsigned FindRow(int y) const
+    {
+        const unsigned count = GetCount();
+
+        unsigned step = 1;
+        while ( step <= count / 2 )
+            step <<= 1;
+
+        unsigned row = 0;
+        for ( ; step && count; step >>= 1 )
+        {
+            const unsigned next = row + step;
+            if ( next <= count && m_tree[next - 1] <= y )
+            {
+                row = next;
+                y -= m_tree[next - 1];
+            }
+        }
+
+        return row;
+    }
+
+    // Add the height of the row with GetCount() index.
+    void Append(int height)
+    {
+        // The new node covers the range of rows (n - lowbit(n), n], in 1-based
+        // numbering, so it's enough to add the heights of the preceding rows
+        // of this range to the height of the new one.
+        const unsigned n = GetCount() + 1;
+        const int sum = height + GetStart(n - 1) - GetStart(n - LowBit(n));
+
+        m_heights.push_back(height);
+        m_tree.push_back(sum);
+    }
+
+    // Change the height of an already cached row.
+    void SetHeight(unsigned row, int height)
+    {
+        if ( row >= GetCount() )
+            return;
+
+        const int delta = height - m_heights[row];
+        if ( !delta )
+            return;
+
+        m_heights[row] = height;
+        for ( unsigned n = row + 1; n <= GetCount(); n += LowBit(n) )
+            m_tree[n - 1] += delta;
+    }
+
+    // Insert the new rows with the given heights before the given row. This
+    // does nothing if the row is not cached as the heights of the rows after
+    // the end of the cache are unknown anyhow.
+    void Insert(unsigned row, const wxVector<int>& heights)
+    {
+        if ( row >= GetCount() || heights.empty() )
+            return;
+
+        const unsigned count = GetCount();
+
+        wxVector<int> all;
+        all.reserve(count + heights.size());
+
+        unsigned n;
+        for ( n = 0; n < row; n++ )
+            all.push_back(m_heights[n]);
+        for ( n = 0; n < heights.size(); n++ )
+            all.push_back(heights[n]);
+        for ( n = row; n < count; n++ )
+            all.push_back(m_heights[n]);
+
+        m_heights.swap(all);
+
+        Rebuild();
+    }
+
+    // Remove the given number of rows starting from the given one.
+    void Remove(unsigned row, unsigned count)
+    {
+        if ( row >= GetCount() || !count )
+            return;
+
+        if ( count >= GetCount() - row )
+        {
+            Truncate(row);
+            return;
+        }
+
+        m_heights.erase(m_heights.begin() + row,
+                        m_heights.begin() + row + count);
+
+        Rebuild();
+    }
+
+private:
+    static unsigned LowBit(unsigned n) { return n & (~n + 1); }
+
+    // Recompute all the tree nodes from m_heights in linear time.
+    void Rebuild()
+    {
+        const unsigned count = GetCount();
+
+        m_tree.assign(m_heights.begin(), m_heights.end());
+        for ( unsigned n = 1; n <= count; n++ )
+        {
+            const unsigned parent = n + LowBit(n);
+            if ( parent <= count )
+                m_tree[parent - 1] += m_tree[n - 1];
+        }
+    }
+
+    // Heights of the individual rows.
+    wxVector<int> m_heights;
+
+    // Fenwick tree nodes: m_tree[n - 1] is the sum of heights of the rows in
+    // (n - lowbit(n), n] range, using 1-based row numbers.
+    wxVector<int> m_tree;
+
+    wxDECLARE_NO_COPY_CLASS(wxRowHeightCache);
+};
+
+#endif // wxUSE_DATAVIEWCTRL
+
+#endif // _WX_GENERIC_PRIVATE_ROWHEIGHTCACHE_H_
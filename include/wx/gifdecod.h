@@ -18,6 +18,7 @@
 #include "wx/image.h"
 #include "wx/animdecod.h"
 #include "wx/dynarray.h"
+#include "wx/vector.h"
 
 // internal utility used to store a frame in 8bit-per-pixel format
 class GIFImage;
@@ -53,6 +54,11 @@ public:
     ~wxGIFDecoder();
 
     // get data of current frame
+    //
+    // Notice that only the frames used most recently are kept in decoded form
+    // and the pointer returned by GetData() may be invalidated by the next
+    // call to it for another frame. It can also return NULL if there is not
+    // enough memory for decoding the frame.
     unsigned char* GetData(unsigned int frame) const;
     unsigned char* GetPalette(unsigned int frame) const;
     unsigned int GetNcolours(unsigned int frame) const;
@@ -90,20 +96,18 @@ private:
     virtual bool DoCanRead( wxInputStream& stream ) const wxOVERRIDE;
         // modifies current stream position (see wxAnimationDecoder::CanRead)
 
-    int getcode(wxInputStream& stream, int bits, int abfin);
-    wxGIFErrorCode dgif(wxInputStream& stream,
-                        GIFImage *img, int interl, int bits);
+    // decode the given frame unless it's already decoded
+    wxGIFErrorCode DecodeFrame(unsigned int frame) const;
 
 
     // array of all frames
     wxArrayPtrVoid m_frames;
 
-    // decoder state vars
-    int           m_restbits;       // remaining valid bits
-    unsigned int  m_restbyte;       // remaining bytes in this block
-    unsigned int  m_lastbyte;       // last byte read
-    unsigned char m_buffer[256];    // buffer for reading
-    unsigned char *m_bufp;          // pointer to next byte in buffer
+    // indices of the decoded frames, from the least to the most recently used
+    mutable wxVector<unsigned int> m_decodedFrames;
+
+    // total size of the data of the decoded frames
+    mutable size_t m_decodedSize;
 
     wxDECLARE_NO_COPY_CLASS(wxGIFDecoder);
 };
@@ -21,7 +21,6 @@
 #define wxIMAGE_OPTION_GIF_COMMENT wxT("GifComment")
 
 struct wxRGB;
-struct GifHashTableType;
 class WXDLLIMPEXP_FWD_CORE wxImageArray; // anidecod.h
 
 class WXDLLIMPEXP_CORE wxGIFHandler : public wxImageHandler
@@ -33,7 +32,6 @@ public:
         m_extension = wxT("gif");
         m_type = wxBITMAP_TYPE_GIF;
         m_mime = wxT("image/gif");
-        m_hashTable = NULL;
     }
 
 #if wxUSE_STREAMS
@@ -55,34 +53,6 @@ protected:
         const wxRGB *pal, int palCount,
         int mask_index);
 #endif // wxUSE_STREAMS
-protected:
-
-    // Declarations for saving
-
-    unsigned long m_crntShiftDWord;   /* For bytes decomposition into codes. */
-    int m_pixelCount;
-    struct GifHashTableType *m_hashTable;
-    wxInt16
-      m_EOFCode,     /* The EOF LZ code. */
-      m_clearCode,   /* The CLEAR LZ code. */
-      m_runningCode, /* The next code algorithm can generate. */
-      m_runningBits, /* The number of bits required to represent RunningCode. */
-      m_maxCode1,    /* 1 bigger than max. possible code, in RunningBits bits. */
-      m_crntCode,    /* Current algorithm code. */
-      m_crntShiftState;    /* Number of bits in CrntShiftDWord. */
-    wxUint8 m_LZBuf[256];   /* Compressed input is buffered here. */
-
-    bool InitHashTable();
-    void ClearHashTable();
-    void InsertHashTable(unsigned long key, int code);
-    int  ExistsHashTable(unsigned long key);
-
-#if wxUSE_STREAMS
-    bool CompressOutput(wxOutputStream *, int code);
-    bool SetupCompress(wxOutputStream *, int bpp);
-    bool CompressLine(wxOutputStream *, const wxUint8 *line, int lineLen);
-#endif
-
 private:
     wxDECLARE_DYNAMIC_CLASS(wxGIFHandler);
 };
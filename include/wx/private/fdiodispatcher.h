@@ -19,7 +19,16 @@ enum wxFDIODispatcherEntryFlags
     wxFDIO_INPUT = 1,
     wxFDIO_OUTPUT = 2,
     wxFDIO_EXCEPTION = 4,
-    wxFDIO_ALL = wxFDIO_INPUT | wxFDIO_OUTPUT | wxFDIO_EXCEPTION
+    wxFDIO_ALL = wxFDIO_INPUT | wxFDIO_OUTPUT | wxFDIO_EXCEPTION,
+
+    // request edge-triggered notifications, i.e. only notify about the
+    // descriptor becoming ready and not as long as it remains ready: the
+    // handler must then read or write until it gets EAGAIN
+    //
+    // this is only supported by wxEpollDispatcher, the other dispatchers
+    // ignore this flag and keep using level-triggered notifications, which is
+    // compatible with the handlers written for edge-triggered ones
+    wxFDIO_EDGE_TRIGGERED = 8
 };
 
 // base class for wxSelectDispatcher and wxEpollDispatcher
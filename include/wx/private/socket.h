@@ -247,6 +247,11 @@ public:
     int Read(void *buffer, int size);
     int Write(const void *buffer, int size);
 
+    // scatter/gather versions of the functions above, they may read or write
+    // less than the total size of all buffers, just as Read/Write() do
+    int ReadV(const wxSocketIOVec *vec, int count);
+    int WriteV(const wxSocketIOVec *vec, int count);
+
     // basically a wrapper for select(): returns the condition of the socket,
     // blocking for not longer than timeout if it is specified (otherwise just
     // poll without blocking at all)
@@ -353,6 +358,13 @@ private:
     int SendStream(const void *buffer, int size);
     int SendDgram(const void *buffer, int size);
 
+    // functions used to implement ReadV/WriteV() for more than one buffer
+    int RecvV(const wxSocketIOVec *vec, int count);
+    int SendV(const wxSocketIOVec *vec, int count);
+
+    // called when the peer closes the connection
+    void OnStreamClosed();
+
 
     // set in ctor and never changed except that it's reset to NULL when the
     // socket is shut down
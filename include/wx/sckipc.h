@@ -52,6 +52,7 @@ class WXDLLIMPEXP_FWD_NET wxTCPServer;
 class WXDLLIMPEXP_FWD_NET wxTCPClient;
 
 class wxIPCSocketStreams;
+class wxIPCPendingRequests;
 
 class WXDLLIMPEXP_NET wxTCPConnection : public wxConnectionBase
 {
@@ -73,6 +74,26 @@ public:
     virtual bool StopAdvise(const wxString& item) wxOVERRIDE;
     virtual bool Disconnect(void) wxOVERRIDE;
 
+    // Send a request without waiting for the reply, which is passed to
+    // OnRequestReply() when it arrives. Many such requests can be sent, the
+    // replies to them are received in the same order, but this function
+    // waits for some replies if too many of them are pending. Returns the
+    // request ID or 0 on failure.
+    wxUint32 RequestAsync(const wxString& item, wxIPCFormat format = wxIPC_TEXT);
+
+    // Called when the reply to a request sent by RequestAsync() is received,
+    // data is NULL if the server failed to process the request.
+    virtual void OnRequestReply(wxUint32 WXUNUSED(id),
+                                const wxString& WXUNUSED(item),
+                                const void *WXUNUSED(data),
+                                size_t WXUNUSED(size),
+                                wxIPCFormat WXUNUSED(format))
+        { }
+
+    // Return the number of requests sent by RequestAsync() and not replied
+    // to yet.
+    size_t GetPendingRequestsCount() const;
+
     // Will be used in the future to enable the compression but does nothing
     // for now.
     void Compress(bool on);
@@ -104,6 +125,13 @@ private:
     // common part of both ctors
     void Init();
 
+    // the requests sent by RequestAsync() and not replied to yet, created on
+    // demand
+    wxIPCPendingRequests *m_pendingRequests;
+
+    // the ID of the last request sent by RequestAsync()
+    wxUint32 m_lastRequestId;
+
     friend class wxTCPServer;
     friend class wxTCPClient;
     friend class wxTCPEventHandler;
@@ -22,6 +22,7 @@
 #include "wx/event.h"
 #include "wx/sckaddr.h"
 #include "wx/list.h"
+#include "wx/buffer.h"
 
 class wxSocketImpl;
 
@@ -106,6 +107,27 @@ enum wxSocketType
 };
 
 
+// --------------------------------------------------------------------------
+// wxSocketIOVec
+// --------------------------------------------------------------------------
+
+// Describes one of the buffers used by wxSocketBase::ReadV() and WriteV().
+//
+// Notice that the buffer pointer is non-const, as for the standard iovec
+// struct, but the buffers are never modified by WriteV().
+struct wxSocketIOVec
+{
+    wxSocketIOVec() : buffer(NULL), size(0) { }
+    wxSocketIOVec(const void *buffer_, wxUint32 size_)
+        : buffer(const_cast<void *>(buffer_)), size(size_)
+    {
+    }
+
+    void *buffer;
+    wxUint32 size;
+};
+
+
 // event
 class WXDLLIMPEXP_FWD_NET wxSocketEvent;
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_NET, wxEVT_SOCKET, wxSocketEvent);
@@ -158,6 +180,17 @@ public:
     wxSocketBase& Write(const void *buffer, wxUint32 nbytes);
     wxSocketBase& WriteMsg(const void *buffer, wxUint32 nbytes);
 
+    // scatter/gather IO: read into or write from several buffers at once
+    wxSocketBase& ReadV(const wxSocketIOVec *vec, int count);
+    wxSocketBase& WriteV(const wxSocketIOVec *vec, int count);
+
+    // if write buffering is on, the data written by any of the functions above
+    // is accumulated in memory and sent when there is enough of it or when
+    // Flush() is called, which is useful for sending many small messages
+    void SetWriteBuffering(bool buffer);
+    bool IsWriteBuffering() const { return m_writeBuffering; }
+    bool Flush();
+
     // all Wait() functions wait until their condition is satisfied or the
     // timeout expires; if seconds == -1 (default) then m_timeout value is used
     //
@@ -234,6 +267,17 @@ private:
     wxUint32 DoRead(void* buffer, wxUint32 nbytes);
     wxUint32 DoWrite(const void *buffer, wxUint32 nbytes);
 
+    // vectored versions of the functions above, they modify the contents of
+    // the array passed to them
+    wxUint32 DoReadV(wxSocketIOVec *vec, int count);
+    wxUint32 DoWriteV(wxSocketIOVec *vec, int count);
+
+    // write the data directly to the socket, bypassing m_writeBuffer
+    wxUint32 DoSendV(wxSocketIOVec *vec, int count);
+
+    // remove the given number of bytes from the start of m_writeBuffer
+    void ConsumeWriteBuffer(wxUint32 nbytes);
+
     // wait until the given flags are set for this socket or the given timeout
     // (or m_timeout) expires
     //
@@ -288,6 +332,10 @@ private:
     wxUint32      m_unrd_size;        // pushback buffer size
     wxUint32      m_unrd_cur;         // pushback pointer (index into buffer)
 
+    // write buffer
+    wxMemoryBuffer m_writeBuffer;     // data not sent yet
+    bool          m_writeBuffering;   // accumulate the data in m_writeBuffer?
+
     // events
     int           m_id;               // socket id
     wxEvtHandler *m_handler;          // event handler
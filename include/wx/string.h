@@ -33,6 +33,10 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#ifdef wxHAS_RVALUE_REF
+    #include <utility>      // for std::move()
+#endif
+
 #include "wx/wxcrtbase.h"   // for wxChar, wxStrlen() etc.
 #include "wx/strvararg.h"
 #include "wx/buffer.h"      // for wxCharBuffer
@@ -438,6 +442,44 @@ private:
 
       // the last used index
       unsigned lastUsed;
+
+      // the elements above only help with accessing the strings sequentially,
+      // so for the random access to long strings we also build, on demand, a
+      // sparse index of the positions in m_impl of every step-th character of
+      // the last such string, which is discarded whenever it is modified
+      //
+      // notice that the index is only extended up to the position being
+      // looked up and so never covers the part of the string after it: this
+      // is important as many modifying functions invalidate the cache before
+      // calling PosToImpl() and then change the string after the returned
+      // position only
+      struct PosIndex
+      {
+          // the index is only used for the strings of at least MIN_LENGTH
+          // bytes and when going more than MIN_STEP characters forward from
+          // the cached position, and it has at most SIZE entries
+          enum { MIN_LENGTH = 1024, MIN_STEP = 64, SIZE = 64 };
+
+          const wxString *str;  // the string to which the index applies
+          size_t ascii,         // length of its ASCII-only prefix
+                 step,          // number of characters between the offsets
+                 count;         // number of valid entries in offsets
+
+          // offsets[n] is the position in m_impl of the character
+          // ascii + (n + 1)*step, only used if hasNonASCII is true
+          size_t offsets[SIZE];
+
+          // true if the character at ascii position is known not to be ASCII
+          bool hasNonASCII;
+
+          void Reset()
+          {
+              str = NULL;
+              ascii =
+              count = 0;
+              hasNonASCII = false;
+          }
+      } posIndex;
   };
 
 #ifndef wxHAS_COMPILER_TLS
@@ -570,6 +612,29 @@ private:
       return c;
   }
 
+  // return the position index if it is used for this string or NULL
+  Cache::PosIndex *FindPosIndex() const
+  {
+#ifndef wxHAS_COMPILER_TLS
+      // see the comment in FindCacheElement()
+      if ( GetCacheBegin() == NULL )
+        return NULL;
+#endif
+      Cache::PosIndex& index = GetCache().posIndex;
+      return index.str == this ? &index : NULL;
+  }
+
+  void InvalidatePosIndex() const
+  {
+      Cache::PosIndex * const index = FindPosIndex();
+      if ( index )
+          index->Reset();
+  }
+
+  // move the cached position closer to the given one using the position
+  // index, (re)building it for this string if necessary
+  void SeekUsingPosIndex(Cache::Element *cache, size_t pos) const;
+
   size_t DoPosToImpl(size_t pos) const
   {
       wxCACHE_PROFILE_FIELD_INC(postot);
@@ -594,6 +659,11 @@ private:
       if ( pos == cache->pos )
           return cache->impl;
 
+      // if the string has as many characters as bytes, it contains only ASCII
+      // and there is no need to look for the position at all
+      if ( cache->len == m_impl.length() )
+          return pos;
+
       // this seems to happen only rarely so just reset the cache in this case
       // instead of complicating code even further by seeking backwards in this
       // case
@@ -604,8 +674,12 @@ private:
           cache->ResetPos();
       }
 
-      wxCACHE_PROFILE_FIELD_ADD(sumofs, pos - cache->pos);
+      // avoid iterating over many characters of long strings
+      if ( pos - cache->pos > Cache::PosIndex::MIN_STEP &&
+                m_impl.length() >= Cache::PosIndex::MIN_LENGTH )
+          SeekUsingPosIndex(cache, pos);
 
+      wxCACHE_PROFILE_FIELD_ADD(sumofs, pos - cache->pos);
 
       wxStringImpl::const_iterator i(m_impl.begin() + cache->impl);
       for ( size_t n = cache->pos; n < pos; n++ )
@@ -622,6 +696,8 @@ private:
 
   void InvalidateCache()
   {
+      InvalidatePosIndex();
+
       Cache::Element * const cache = FindCacheElement();
       if ( cache )
           cache->Reset();
@@ -629,6 +705,8 @@ private:
 
   void InvalidateCachedLength()
   {
+      InvalidatePosIndex();
+
       Cache::Element * const cache = FindCacheElement();
       if ( cache )
           cache->len = npos;
@@ -636,15 +714,24 @@ private:
 
   void SetCachedLength(size_t len)
   {
+      InvalidatePosIndex();
+
       // we optimistically cache the length here even if the string wasn't
       // present in the cache before, this seems to do no harm and the
       // potential for avoiding length recomputation for long strings looks
       // interesting
-      GetCacheElement()->len = len;
+      //
+      // notice that this is only used when the string contents is replaced,
+      // so the cached position is not valid any more
+      Cache::Element * const cache = GetCacheElement();
+      cache->ResetPos();
+      cache->len = len;
   }
 
   void UpdateCachedLength(ptrdiff_t delta)
   {
+      InvalidatePosIndex();
+
       Cache::Element * const cache = FindCacheElement();
       if ( cache && cache->len != npos )
       {
@@ -1103,6 +1190,18 @@ public:
     // copy ctor
   wxString(const wxString& stringSrc) : m_impl(stringSrc.m_impl) { }
 
+#ifdef wxHAS_RVALUE_REF
+    // move ctor: notice that the conversion buffers are not taken from the
+    // other string as they're only valid for as long as it is not modified
+  wxString(wxString&& stringSrc) wxNOEXCEPT
+      : m_impl(std::move(stringSrc.m_impl))
+  {
+#if wxUSE_STRING_POS_CACHE
+      stringSrc.InvalidateCache();
+#endif // wxUSE_STRING_POS_CACHE
+  }
+#endif // wxHAS_RVALUE_REF
+
     // string containing nRepeat copies of ch
   wxString(wxUniChar ch, size_t nRepeat = 1 )
     { assign(nRepeat, ch); }
@@ -1366,7 +1465,8 @@ public:
     {
         wxSTRING_INVALIDATE_CACHED_LENGTH();
 
-        m_impl.resize(nSize, (wxStringCharType)ch);
+        // notice that m_impl length in bytes may be different from len
+        m_impl.resize(m_impl.length() + nSize - len, (wxStringCharType)ch);
     }
   }
 
@@ -1643,11 +1743,10 @@ public:
     // internal UTF-8 representation
     size_t utf8_length() const { return m_impl.length(); }
 #elif wxUSE_UNICODE_WCHAR
-    static wxString FromUTF8(const char *utf8, size_t len = npos)
-      { return wxString(utf8, wxMBConvUTF8(), len); }
+    static wxString FromUTF8(const char *utf8, size_t len = npos);
     static wxString FromUTF8Unchecked(const char *utf8, size_t len = npos)
     {
-        const wxString s(utf8, wxMBConvUTF8(), len);
+        const wxString s(FromUTF8(utf8, len));
         wxASSERT_MSG( !utf8 || !*utf8 || !s.empty(),
                       "string must be valid UTF-8" );
         return s;
@@ -1802,6 +1901,24 @@ public:
     return *this;
   }
 
+#ifdef wxHAS_RVALUE_REF
+    // from a temporary wxString
+  wxString& operator=(wxString&& stringSrc) wxNOEXCEPT
+  {
+    if ( this != &stringSrc )
+    {
+        wxSTRING_INVALIDATE_CACHE();
+#if wxUSE_STRING_POS_CACHE
+        stringSrc.InvalidateCache();
+#endif // wxUSE_STRING_POS_CACHE
+
+        m_impl = std::move(stringSrc.m_impl);
+    }
+
+    return *this;
+  }
+#endif // wxHAS_RVALUE_REF
+
   wxString& operator=(const wxCStrData& cstr)
     { return *this = cstr.AsString(); }
     // from a character
@@ -3350,24 +3467,31 @@ private:
   // existing code and consistency with std::string::c_str() so returning a
   // temporary buffer won't do and we need to cache the conversion results
 
-  // TODO-UTF8: benchmark various approaches to keeping compatibility buffers
+  // the buffers are only ever enlarged and reused for all the subsequent
+  // conversions, so converting the same string many times doesn't allocate
+  // any memory
   template<typename T>
   struct ConvertedBuffer
   {
-      // notice that there is no need to initialize m_len here as it's unused
-      // as long as m_str is NULL
+      // notice that there is no need to initialize m_len and m_size here as
+      // they're unused as long as m_str is NULL
       ConvertedBuffer() : m_str(NULL) {}
       ~ConvertedBuffer()
           { free(m_str); }
 
       bool Extend(size_t len)
       {
-          // add extra 1 for the trailing NUL
-          void * const str = realloc(m_str, sizeof(T)*(len + 1));
-          if ( !str )
-              return false;
+          if ( !m_str || len > m_size )
+          {
+              // add extra 1 for the trailing NUL
+              void * const str = realloc(m_str, sizeof(T)*(len + 1));
+              if ( !str )
+                  return false;
+
+              m_str = static_cast<T *>(str);
+              m_size = len;
+          }
 
-          m_str = static_cast<T *>(str);
           m_len = len;
 
           return true;
@@ -3378,8 +3502,9 @@ private:
           return wxScopedCharTypeBuffer<T>::CreateNonOwned(m_str, m_len);
       }
 
-      T *m_str;     // pointer to the string data
-      size_t m_len; // length, not size, i.e. in chars and without last NUL
+      T *m_str;      // pointer to the string data
+      size_t m_len;  // length, not size, i.e. in chars and without last NUL
+      size_t m_size; // allocated length, also without the last NUL
   };
 
 
@@ -3582,6 +3707,58 @@ struct wxStringAsBufHelper<wchar_t>
 
 } // namespace wxPrivate
 
+// ----------------------------------------------------------------------------
+// wxParsedFormatString: format string which can be reused efficiently
+// ----------------------------------------------------------------------------
+
+// This class can be used instead of a plain string as the format argument of
+// wxString::Format() and all the other functions taking wxFormatString, when
+// the same format is used many times: all the work done with the format string
+// itself, i.e. its conversion to the form expected by the underlying printf()
+// implementation and finding the types of arguments for checking them, is done
+// only once, by its ctor, instead of during each call.
+//
+// The object must remain alive while it's used, as it's not copied, but it can
+// be used from several threads simultaneously as it's never modified.
+class WXDLLIMPEXP_BASE wxParsedFormatString
+{
+public:
+    wxParsedFormatString(const char *format);
+    wxParsedFormatString(const wchar_t *format);
+    wxParsedFormatString(const wxString& format);
+
+    ~wxParsedFormatString();
+
+    // return the format string this object was created from
+    const wxString& GetFormat() const { return m_format; }
+
+private:
+    // common part of all ctors, uses m_format
+    void Init();
+
+    // return the type of the n-th (counting from 1) argument
+    wxFormatString::ArgumentType GetArgumentType(unsigned n) const;
+
+
+    const wxString m_format;
+
+    // the format converted as wxFormatString::AsChar() and AsWChar() do it
+#if !wxUSE_UNICODE_WCHAR
+    wxCharBuffer m_convertedChar;
+#endif
+#if wxUSE_UNICODE && !wxUSE_UTF8_LOCALE_ONLY
+    wxWCharBuffer m_convertedWChar;
+#endif
+
+    // the types of all arguments used by the format string
+    wxFormatString::ArgumentType *m_argTypes;
+    unsigned m_argCount;
+
+    friend class wxFormatString;
+
+    wxDECLARE_NO_COPY_CLASS(wxParsedFormatString);
+};
+
 // ----------------------------------------------------------------------------
 // wxStringBuffer: a tiny class allowing to get a writable pointer into string
 // ----------------------------------------------------------------------------
@@ -3741,7 +3918,12 @@ public:
     wxStringInternalBuffer(wxString& str, size_t lenWanted = 1024)
         : wxStringTypeBufferBase<wxStringCharType>(str, lenWanted) {}
     ~wxStringInternalBuffer()
-        { m_str.m_impl.assign(m_buf.data()); }
+    {
+#if wxUSE_STRING_POS_CACHE
+        m_str.InvalidateCache();
+#endif // wxUSE_STRING_POS_CACHE
+        m_str.m_impl.assign(m_buf.data());
+    }
 
     wxDECLARE_NO_COPY_CLASS(wxStringInternalBuffer);
 };
@@ -3755,6 +3937,9 @@ public:
 
     ~wxStringInternalBufferLength()
     {
+#if wxUSE_STRING_POS_CACHE
+        m_str.InvalidateCache();
+#endif // wxUSE_STRING_POS_CACHE
         m_str.m_impl.assign(m_buf.data(), m_len);
     }
 
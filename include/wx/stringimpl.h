@@ -297,6 +297,14 @@ public:
       GetStringData()->Lock();                    // => one more copy
     }
   }
+#ifdef wxHAS_RVALUE_REF
+    // move ctor: just take the data of the other string
+  wxStringImpl(wxStringImpl&& stringSrc) wxNOEXCEPT
+  {
+    m_pchData = stringSrc.m_pchData;
+    stringSrc.Init();
+  }
+#endif // wxHAS_RVALUE_REF
     // string containing nRepeat copies of ch
   wxStringImpl(size_type nRepeat, wxStringCharType ch);
     // ctor takes first nLength characters from C string
@@ -348,6 +356,14 @@ public:
   // overloaded assignment
     // from another wxString
   wxStringImpl& operator=(const wxStringImpl& stringSrc);
+#ifdef wxHAS_RVALUE_REF
+    // from a temporary string
+  wxStringImpl& operator=(wxStringImpl&& stringSrc) wxNOEXCEPT
+  {
+    swap(stringSrc);
+    return *this;
+  }
+#endif // wxHAS_RVALUE_REF
     // from a character
   wxStringImpl& operator=(wxStringCharType ch);
     // from a C string
@@ -30,6 +30,7 @@
 
 class WXDLLIMPEXP_FWD_BASE wxCStrData;
 class WXDLLIMPEXP_FWD_BASE wxString;
+class WXDLLIMPEXP_FWD_BASE wxParsedFormatString;
 
 // ----------------------------------------------------------------------------
 // WX_DEFINE_VARARG_FUNC* macros
@@ -134,17 +135,21 @@ class WXDLLIMPEXP_BASE wxFormatString
 {
 public:
     wxFormatString(const char *str)
-        : m_char(wxScopedCharBuffer::CreateNonOwned(str)), m_str(NULL), m_cstr(NULL) {}
+        : m_char(wxScopedCharBuffer::CreateNonOwned(str)),
+          m_str(NULL), m_cstr(NULL), m_parsed(NULL) {}
     wxFormatString(const wchar_t *str)
-        : m_wchar(wxScopedWCharBuffer::CreateNonOwned(str)), m_str(NULL), m_cstr(NULL) {}
+        : m_wchar(wxScopedWCharBuffer::CreateNonOwned(str)),
+          m_str(NULL), m_cstr(NULL), m_parsed(NULL) {}
     wxFormatString(const wxString& str)
-        : m_str(&str), m_cstr(NULL) {}
+        : m_str(&str), m_cstr(NULL), m_parsed(NULL) {}
     wxFormatString(const wxCStrData& str)
-        : m_str(NULL), m_cstr(&str) {}
+        : m_str(NULL), m_cstr(&str), m_parsed(NULL) {}
     wxFormatString(const wxScopedCharBuffer& str)
-        : m_char(str), m_str(NULL), m_cstr(NULL)  {}
+        : m_char(str), m_str(NULL), m_cstr(NULL), m_parsed(NULL)  {}
     wxFormatString(const wxScopedWCharBuffer& str)
-        : m_wchar(str), m_str(NULL), m_cstr(NULL) {}
+        : m_wchar(str), m_str(NULL), m_cstr(NULL), m_parsed(NULL) {}
+    wxFormatString(const wxParsedFormatString& str)
+        : m_str(NULL), m_cstr(NULL), m_parsed(&str) {}
 
     // Possible argument types. These are or-combinable for wxASSERT_ARG_TYPE
     // convenience. Some of the values are or-combined with another value, this
@@ -233,6 +238,9 @@ private:
     //     passed to the ctor
     const wxString * const m_str;
     const wxCStrData * const m_cstr;
+    const wxParsedFormatString * const m_parsed;
+
+    friend class wxParsedFormatString;
 
     wxDECLARE_NO_ASSIGN_CLASS(wxFormatString);
 };
@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/threadpool.h
+// Purpose:     wxThreadPool and related classes for running tasks in parallel
+// Author:      wxWidgets team
+// Created:     2018-10-18
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_THREADPOOL_H_
+#define _WX_THREADPOOL_H_
+
+#include "wx/defs.h"
+
+#if wxUSE_THREADS
+
+#include "wx/atomic.h"
+#include "wx/object.h"
+
+class WXDLLIMPEXP_FWD_BASE wxTaskGroup;
+class WXDLLIMPEXP_FWD_BASE wxThreadPool;
+class wxThreadPoolImpl;
+
+// ----------------------------------------------------------------------------
+// wxThreadPoolTask: a unit of work executed by wxThreadPool
+// ----------------------------------------------------------------------------
+
+// The tasks are reference counted as they can be referenced both by the pool
+// and by the code which queued them and wants to wait for them or cancel them
+// later, use wxThreadPoolTaskPtr for keeping a reference to a task.
+class WXDLLIMPEXP_BASE wxThreadPoolTask
+{
+public:
+    wxThreadPoolTask();
+
+    // Do the work, this is called in one of the pool threads.
+    virtual void Run() = 0;
+
+    // Called in the main thread, from the event loop, after Run() returns,
+    // unless the task was cancelled before starting to run or SetNotifyDone()
+    // was used to disable it.
+    virtual void OnDone() { }
+
+
+    // Prevent the task from running if it hasn't started yet, otherwise Run()
+    // can check IsCancelled() and return early if it wants to.
+    void Cancel();
+
+    // Return true if Cancel() was called either for this task or for the
+    // group it belongs to.
+    bool IsCancelled() const;
+
+    // Return true if the task has either finished running or was discarded
+    // because it had been cancelled before starting to run.
+    bool IsDone() const { return m_pending == 0; }
+
+    // Wait until IsDone() becomes true, running other pending tasks of the
+    // pool in the calling thread in the meanwhile. This can be called from any
+    // thread, including from inside another task.
+    void Wait();
+
+
+    // Reference counting functions for wxObjectDataPtr<>, they can be called
+    // from any thread.
+    void IncRef() { wxAtomicInc(m_refCount); }
+    void DecRef()
+    {
+        if ( !wxAtomicDec(m_refCount) )
+            delete this;
+    }
+
+protected:
+    // The task can only be deleted by DecRef().
+    virtual ~wxThreadPoolTask() { }
+
+    // Disable calling OnDone(), which avoids the overhead of queuing an event
+    // for the tasks which don't need it. This must be called before queuing
+    // the task.
+    void SetNotifyDone(bool notify) { m_notifyDone = notify; }
+
+private:
+    wxAtomicInt m_refCount;
+    wxAtomicInt m_cancelled;
+
+    // This is 1 until the task is done and becomes 0 then.
+    wxAtomicInt m_pending;
+
+    // These fields are set when the task is queued.
+    wxThreadPool *m_pool;
+    wxTaskGroup *m_group;
+
+    bool m_notifyDone;
+
+    friend class wxThreadPool;
+    friend class wxThreadPoolImpl;
+
+    wxDECLARE_NO_COPY_CLASS(wxThreadPoolTask);
+};
+
+typedef wxObjectDataPtr<wxThreadPoolTask> wxThreadPoolTaskPtr;
+
+// ----------------------------------------------------------------------------
+// wxThreadPool: a fixed number of threads running the queued tasks
+// ----------------------------------------------------------------------------
+
+// Each pool thread has its own queue of tasks, the tasks queued from inside
+// another task are added to the queue of the current thread and the threads
+// without any tasks of their own steal them from the other ones.
+class WXDLLIMPEXP_BASE wxThreadPool
+{
+public:
+    // Create a pool with the given number of threads or, by default, with as
+    // many threads as there are CPUs.
+    explicit wxThreadPool(int numThreads = 0);
+
+    // Wait for the currently running tasks and discard all the other ones.
+    ~wxThreadPool();
+
+    // Return the global pool, which is created on first use.
+    static wxThreadPool& Get();
+
+    int GetThreadCount() const { return m_numThreads; }
+
+    // Queue the task, which must be allocated on the heap, for running in one
+    // of the pool threads. The pool takes ownership of the task and returns a
+    // pointer which can be used to wait for it or cancel it, if necessary.
+    wxThreadPoolTaskPtr Queue(wxThreadPoolTask *task);
+
+    // Call func(from, to) for consecutive subranges of [begin, end) range in
+    // parallel, using the pool threads and the calling thread, and return
+    // when all of them are done. The subranges are never shorter than the
+    // given grain size, which can be increased to reduce the overhead when
+    // processing a single element is very fast.
+    template <typename F>
+    void ParallelFor(int begin, int end, const F& func, int grain = 1);
+
+private:
+    // Run one pending task, if any, in the calling thread and return true or
+    // return false if there are no pending tasks.
+    bool RunPendingTask();
+
+    // Wait until the given counter of pending tasks drops to 0, this is used
+    // by wxTaskGroup::Wait() and wxThreadPoolTask::Wait().
+    void WaitForPending(wxAtomicInt& pending);
+
+    // Common part of Queue() and wxTaskGroup::Run(), takes ownership of the
+    // task and doesn't return any pointer to it.
+    void DoQueue(wxThreadPoolTask *task, wxTaskGroup *group);
+
+    int m_numThreads;
+    wxThreadPoolImpl *m_impl;
+
+    friend class wxTaskGroup;
+    friend class wxThreadPoolTask;
+    friend class wxThreadPoolImpl;
+
+    wxDECLARE_NO_COPY_CLASS(wxThreadPool);
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskGroup: a set of tasks which can be waited for or cancelled together
+// ----------------------------------------------------------------------------
+
+class WXDLLIMPEXP_BASE wxTaskGroup
+{
+public:
+    explicit wxTaskGroup(wxThreadPool& pool = wxThreadPool::Get())
+        : m_pool(pool)
+    {
+        m_pending = 0;
+        m_cancelled = 0;
+    }
+
+    // Cancel all the tasks which haven't started running yet and wait for the
+    // other ones: the group can't be destroyed while its tasks are running.
+    ~wxTaskGroup();
+
+    wxThreadPool& GetPool() const { return m_pool; }
+
+    // Queue the task in the pool as part of this group, taking ownership of
+    // it, as wxThreadPool::Queue() does.
+    wxThreadPoolTaskPtr Run(wxThreadPoolTask *task);
+
+    // Cancel all the tasks of this group, including the ones added later.
+    void Cancel() { wxAtomicInc(m_cancelled); }
+    bool IsCancelled() const { return m_cancelled != 0; }
+
+    // Return true if all the tasks of this group are done.
+    bool IsDone() const { return m_pending == 0; }
+
+    // Wait until all the tasks of this group are done, running the pending
+    // tasks in the calling thread in the meanwhile.
+    void Wait();
+
+private:
+    wxThreadPool& m_pool;
+
+    // The number of tasks of this group which are not done yet.
+    wxAtomicInt m_pending;
+    wxAtomicInt m_cancelled;
+
+    friend class wxThreadPool;
+    friend class wxThreadPoolImpl;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskGroup);
+};
+
+// ----------------------------------------------------------------------------
+// wxThreadPool::ParallelFor() implementation
+// ----------------------------------------------------------------------------
+
+// This is an implementation detail of ParallelFor().
+template <typename F>
+class wxParallelForTask : public wxThreadPoolTask
+{
+public:
+    wxParallelForTask(const F& func, int from, int to)
+        : m_func(func), m_from(from), m_to(to)
+    {
+        SetNotifyDone(false);
+    }
+
+    virtual void Run() wxOVERRIDE { m_func(m_from, m_to); }
+
+private:
+    F m_func;
+    const int m_from,
+              m_to;
+};
+
+template <typename F>
+inline void wxThreadPool::ParallelFor(int begin, int end, const F& func, int grain)
+{
+    if ( end <= begin )
+        return;
+
+    if ( grain < 1 )
+        grain = 1;
+
+    // Use a few subranges per thread to balance the load if some of them
+    // take longer than others.
+    int numChunks = (end - begin) / grain;
+    if ( numChunks > 4*(m_numThreads + 1) )
+        numChunks = 4*(m_numThreads + 1);
+
+    if ( numChunks <= 1 )
+    {
+        func(begin, end);
+        return;
+    }
+
+    const int chunkSize = (end - begin) / numChunks,
+              extra = (end - begin) % numChunks;
+
+    wxTaskGroup group(*this);
+
+    // Queue all subranges except for the last one, which is processed in the
+    // calling thread itself.
+    int from = begin;
+    for ( int n = 0; n < numChunks - 1; n++ )
+    {
+        const int to = from + chunkSize + (n < extra ? 1 : 0);
+        DoQueue(new wxParallelForTask<F>(func, from, to), &group);
+        from = to;
+    }
+
+    func(from, end);
+
+    group.Wait();
+}
+
+#endif // wxUSE_THREADS
+
+#endif // _WX_THREADPOOL_H_
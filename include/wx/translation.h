@@ -22,6 +22,7 @@
 #include "wx/hashmap.h"
 #include "wx/strconv.h"
 #include "wx/scopedptr.h"
+#include "wx/arrstr.h"
 
 // ============================================================================
 // global decls
@@ -54,6 +55,8 @@ class WXDLLIMPEXP_FWD_BASE wxLocale;
 class wxPluralFormsCalculator;
 wxDECLARE_SCOPED_PTR(wxPluralFormsCalculator, wxPluralFormsCalculatorPtr)
 
+class wxMsgCatalogFile;
+
 // ----------------------------------------------------------------------------
 // wxMsgCatalog corresponds to one loaded message catalog.
 // ----------------------------------------------------------------------------
@@ -63,9 +66,7 @@ class WXDLLIMPEXP_BASE wxMsgCatalog
 public:
     // Ctor is protected, because CreateFromXXX functions must be used,
     // but destruction should be unrestricted
-#if !wxUSE_UNICODE
     ~wxMsgCatalog();
-#endif
 
     // load the catalog from disk or from data; caller is responsible for
     // deleting them if not NULL
@@ -83,7 +84,7 @@ public:
 
 protected:
     wxMsgCatalog(const wxString& domain)
-        : m_pNext(NULL), m_domain(domain)
+        : m_pNext(NULL), m_domain(domain), m_file(NULL)
 #if !wxUSE_UNICODE
         , m_conv(NULL)
 #endif
@@ -93,10 +94,26 @@ private:
     // variable pointing to the next element in a linked list (or NULL)
     wxMsgCatalog *m_pNext;
     friend class wxTranslations;
+    friend class wxMsgCatalogFile;
+
+    // all plural forms of the messages having them
+    WX_DECLARE_STRING_HASH_MAP(wxArrayString, PluralFormsMap);
+
+    // all messages in the catalog or, if m_file is non-NULL, only the ones
+    // which were already looked up in it (including the ones which were not
+    // found and are stored as empty strings)
+    mutable wxStringToStringHashMap m_messages;
+    mutable PluralFormsMap          m_plurals;
 
-    wxStringToStringHashMap m_messages; // all messages in the catalog
     wxString                m_domain;   // name of the domain
 
+    // the catalog file used for looking up the messages on demand or NULL if
+    // all of them were loaded in m_messages and m_plurals
+    wxMsgCatalogFile *m_file;
+
+    // find the already loaded translation
+    const wxString *FindString(const wxString& str, int index) const;
+
 #if !wxUSE_UNICODE
     // the conversion corresponding to this catalog charset if we installed it
     // as the global one
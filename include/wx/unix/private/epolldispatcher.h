@@ -15,6 +15,7 @@
 #ifdef wxUSE_EPOLL_DISPATCHER
 
 #include "wx/private/fdiodispatcher.h"
+#include "wx/vector.h"
 
 struct epoll_event;
 
@@ -44,8 +45,46 @@ private:
     // given timeout
     int DoPoll(epoll_event *events, int numEvents, int timeout) const;
 
+    // return the handler registered for the given fd or NULL
+    wxFDIOHandler *FindHandler(int fd) const
+    {
+        return fd >= 0 && static_cast<size_t>(fd) < m_handlers.size()
+                ? m_handlers[fd].handler
+                : NULL;
+    }
+
+    // update m_handlers after successfully registering or modifying fd
+    void SetHandler(int fd, wxFDIOHandler *handler, int flags);
+
+    // call DoPoll() to fill m_events and grow the buffer if it was filled
+    // completely, return the number of events retrieved or -1 on error
+    int RetrieveEvents(int timeout) const;
+
 
     int m_epollDescriptor;
+
+    // the handlers and flags of the registered descriptors indexed by the
+    // descriptors themselves: unlike the pointers stored directly in the
+    // events, this allows to ignore the events for the descriptors which were
+    // unregistered after the events had been retrieved
+    wxVector<wxFDIOHandlerEntry> m_handlers;
+
+    // the number of currently registered descriptors
+    size_t m_numFDs;
+
+    // the buffer for epoll_wait(), it starts small and grows if it gets filled
+    // as this means that more events are probably waiting
+    mutable epoll_event *m_events;
+    mutable int m_eventsSize;
+
+    // the events in [m_eventsFirst, m_eventsCount) range of m_events were
+    // already retrieved, but not dispatched yet: this is the case after
+    // HasPending() returned true and the next Dispatch() call then uses them
+    // instead of calling epoll_wait() again
+    mutable int m_eventsFirst,
+                m_eventsCount;
+
+    wxDECLARE_NO_COPY_CLASS(wxEpollDispatcher);
 };
 
 #endif // wxUSE_EPOLL_DISPATCHER
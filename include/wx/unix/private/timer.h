@@ -13,11 +13,14 @@
 #if wxUSE_TIMER
 
 #include "wx/private/timer.h"
+#include "wx/vector.h"
 
 // the type used for milliseconds is large enough for microseconds too but
 // introduce a synonym for it to avoid confusion
 typedef wxMilliClock_t wxUsecClock_t;
 
+struct wxTimerSchedule;
+
 // ----------------------------------------------------------------------------
 // wxTimer implementation class for Unix platforms
 // ----------------------------------------------------------------------------
@@ -43,8 +46,17 @@ public:
         m_isRunning = false;
     }
 
+    // for wxTimerScheduler only: get or set the schedule of this timer, which
+    // is used as its handle while it's running and allows to find it in the
+    // scheduler without searching for it
+    wxTimerSchedule *GetSchedule() const { return m_schedule; }
+    void SetSchedule(wxTimerSchedule *schedule) { m_schedule = schedule; }
+
 private:
     bool m_isRunning;
+
+    // the schedule of this timer, owned by wxTimerScheduler, or NULL
+    wxTimerSchedule *m_schedule;
 };
 
 // ----------------------------------------------------------------------------
@@ -55,7 +67,9 @@ struct wxTimerSchedule
 {
     wxTimerSchedule(wxUnixTimerImpl *timer, wxUsecClock_t expiration)
         : m_timer(timer),
-          m_expiration(expiration)
+          m_expiration(expiration),
+          m_serial(0),
+          m_index(0)
     {
     }
 
@@ -64,10 +78,17 @@ struct wxTimerSchedule
 
     // the time of its next expiration, in usec
     wxUsecClock_t m_expiration;
+
+    // the sequential number of this schedule, used to notify the timers
+    // expiring at the same time in the order in which they were scheduled
+    unsigned long m_serial;
+
+    // the position of this schedule in wxTimerScheduler heap
+    size_t m_index;
 };
 
-// the linked list of all active timers, we keep it sorted by expiration time
-WX_DECLARE_LIST(wxTimerSchedule, wxTimerList);
+// all active timers, organized as a binary min-heap by expiration time
+typedef wxVector<wxTimerSchedule *> wxTimerHeap;
 
 // ----------------------------------------------------------------------------
 // wxTimerScheduler: class responsible for updating all timers
@@ -118,17 +139,44 @@ public:
 private:
     // ctor and dtor are private, this is a singleton class only created by
     // Get() and destroyed by Shutdown()
-    wxTimerScheduler() { }
+    wxTimerScheduler() { m_serial = 0; }
     ~wxTimerScheduler();
 
-    // add the given timer schedule to the list in the right place
+    // add the given timer schedule to the heap
     //
     // we take ownership of the pointer "s" which must be heap-allocated
     void DoAddTimer(wxTimerSchedule *s);
 
+    // remove the schedule at the given position from the heap without
+    // deleting it
+    void DoRemoveAt(size_t n);
+
+    // heap helpers: return true if the first schedule must be notified before
+    // the second one, store the schedule at the given position and move the
+    // schedule at the given position up or down to restore the heap order
+    static bool IsBefore(const wxTimerSchedule *s1, const wxTimerSchedule *s2)
+    {
+        if ( s1->m_expiration != s2->m_expiration )
+            return s1->m_expiration < s2->m_expiration;
+
+        return s1->m_serial < s2->m_serial;
+    }
+
+    void DoSetAt(size_t n, wxTimerSchedule *s)
+    {
+        m_timers[n] = s;
+        s->m_index = n;
+    }
+
+    void SiftUp(size_t n);
+    void SiftDown(size_t n);
+
+
+    // all currently active timers, m_timers[0] expires first
+    wxTimerHeap m_timers;
 
-    // the list of all currently active timers sorted by expiration
-    wxTimerList m_timers;
+    // the serial number to use for the next added timer
+    unsigned long m_serial;
 
     static wxTimerScheduler *ms_instance;
 };
@@ -352,6 +352,58 @@ private:
     wxDECLARE_CLASS(wxXmlDocument);
 };
 
+
+// Types of the items returned by wxXmlReader::Next().
+enum wxXmlReaderItemType
+{
+    wxXML_READER_END,               // end of document or parsing error
+    wxXML_READER_START_ELEMENT,     // start tag of an element
+    wxXML_READER_END_ELEMENT,       // end tag of an element
+    wxXML_READER_TEXT               // text, including CDATA sections
+};
+
+class wxXmlReaderData;
+
+// This class parses XML data incrementally and returns the items found in it
+// one by one without building the document tree in memory.
+
+class WXDLLIMPEXP_XML wxXmlReader
+{
+public:
+    // The flags are the same as for wxXmlDocument::Load().
+    wxXmlReader(wxInputStream& stream, int flags = wxXMLDOC_NONE);
+    ~wxXmlReader();
+
+    // Advances to the next item and returns its type.
+    wxXmlReaderItemType Next();
+
+    // Returns false if a parsing error occurred.
+    bool IsOk() const;
+
+    // Accessors for the current item. All the strings are in UTF-8 and
+    // are only valid until the next call to Next().
+    wxXmlReaderItemType GetType() const;
+    int GetLineNumber() const;
+
+    // Element name, only for wxXML_READER_{START,END}_ELEMENT.
+    const char *GetName() const;
+
+    // Element attributes, only for wxXML_READER_START_ELEMENT.
+    size_t GetAttributesCount() const;
+    const char *GetAttributeName(size_t n) const;
+    const char *GetAttributeValue(size_t n) const;
+    const char *GetAttribute(const char *name) const; // NULL if not found
+
+    // Text contents, only for wxXML_READER_TEXT.
+    const char *GetText() const;
+    size_t GetTextLength() const;
+
+private:
+    wxXmlReaderData *m_data;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlReader);
+};
+
 #endif // wxUSE_XML
 
 #endif // _WX_XML_H_
@@ -14,7 +14,9 @@
 #if wxUSE_ZIPSTREAM
 
 #include "wx/archive.h"
+#include "wx/buffer.h"
 #include "wx/filename.h"
+#include "wx/vector.h"
 
 // some methods from wxZipInputStream and wxZipOutputStream stream do not get
 // exported/imported when compiled with Mingw versions before 3.4.2. So they
@@ -305,6 +307,11 @@ public:
     int  GetLevel() const                       { return m_level; }
     void WXZIPFIX SetLevel(int level);
 
+    // compress the entries in the background, using several threads if
+    // available, and write them out in order once they're done
+    void WXZIPFIX SetParallelCompression(bool parallel = true);
+    bool IsParallelCompression() const          { return m_parallel != NULL; }
+
 protected:
     virtual size_t WXZIPFIX OnSysWrite(const void *buffer, size_t size) wxOVERRIDE;
     virtual wxFileOffset OnSysTell() const wxOVERRIDE      { return m_entrySize; }
@@ -332,6 +339,13 @@ private:
     void CreatePendingEntry(const void *buffer, size_t size);
     void CreatePendingEntry();
 
+    bool IsDeferred() const;
+    void WriteLocalSignature();
+    void StreamDeferredEntry(const void *buffer = NULL, size_t size = 0);
+    void QueueDeferredEntry();
+    void WriteQueuedEntry();
+    bool WriteQueuedEntries();
+
     class wxStoredOutputStream *m_store;
     class wxZlibOutputStream2 *m_deflate;
     class wxZipStreamLink *m_backlink;
@@ -349,6 +363,7 @@ private:
     wxFileOffset m_offsetAdjustment;
     wxString m_Comment;
     bool m_endrecWritten;
+    class wxZipParallelQueue *m_parallel;
 
     wxDECLARE_NO_COPY_CLASS(wxZipOutputStream);
 };
@@ -375,6 +390,11 @@ public:
     wxString WXZIPFIX GetComment();
     int WXZIPFIX GetTotalEntries();
 
+    // read the contents of all the given entries, decompressing them in
+    // parallel, the stream must be seekable
+    bool WXZIPFIX ReadEntries(const wxVector<wxZipEntry*>& entries,
+                              wxVector<wxMemoryBuffer>& data);
+
     virtual wxFileOffset GetLength() const wxOVERRIDE { return m_entry.GetSize(); }
 
 protected:
@@ -1737,6 +1737,20 @@ template <typename T> wxDELETEA(T*& array);
  */
 #define wxOVERRIDE
 
+/**
+    @c wxNOEXCEPT expands to the C++11 @c noexcept specifier if it's supported
+    by the compiler or nothing otherwise.
+
+    It is used for the functions which never throw, notably the move
+    constructors and assignment operators, as the standard containers only
+    move their elements when reallocating if these functions are @c noexcept.
+
+    @header{wx/defs.h}
+
+    @since 3.1.1
+ */
+#define wxNOEXCEPT
+
 /**
     GNU C++ compiler gives a warning for any class whose destructor is private
     unless it has a friend. This warning may sometimes be useful but it doesn't
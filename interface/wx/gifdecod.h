@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        gifdecod.h
+// Purpose:     interface of wxGIFDecoder
+// Author:      wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+    Error codes returned by wxGIFDecoder::LoadGIF().
+*/
+enum wxGIFErrorCode
+{
+    wxGIF_OK = 0,                   ///< Everything was OK.
+    wxGIF_INVFORMAT,                ///< Error in GIF header.
+    wxGIF_MEMERR,                   ///< Error allocating memory.
+
+    /**
+        The file appears to be truncated.
+
+        The image itself is most probably OK, but the decoder didn't reach
+        the end of the data stream, so the stream is not correctly positioned
+        after it.
+     */
+    wxGIF_TRUNCATED
+};
+
+/**
+    @class wxGIFDecoder
+
+    Decoder of GIF images, both static and animated ones, used by wxImage
+    and wxAnimation.
+
+    Only the first frame is decoded when the image is loaded, the other ones
+    are decoded when they are used for the first time. To limit the memory
+    used by long animations, only the most recently used frames are kept in
+    decoded form and the other ones are decoded again when they're needed.
+
+    @library{wxcore}
+    @category{gdi}
+
+    @see wxAnimation, wxImage
+*/
+class wxGIFDecoder : public wxAnimationDecoder
+{
+public:
+    /**
+        Default constructor, call LoadGIF() or Load() to actually load an
+        image.
+     */
+    wxGIFDecoder();
+
+    /**
+        Loads all the frames of the image from the given stream.
+
+        Notice that only the first frame is decoded by this function, so the
+        errors in the data of the other frames are not detected by it: such
+        frames are decoded as far as possible and their remaining part is
+        filled with the colour with index 0 when they're used.
+     */
+    wxGIFErrorCode LoadGIF(wxInputStream& stream);
+
+    /**
+        Returns the pixels of the given frame as indices into its palette.
+
+        The returned pointer is only valid until the next call to this
+        function, or to ConvertToImage(), for another frame, as the data of
+        the frames not used recently may be freed then. Notice that in
+        wxWidgets 3.1.0 and earlier it remained valid for as long as the
+        decoder itself.
+
+        @return The frame data or @NULL if there is not enough memory to
+            decode it.
+     */
+    unsigned char* GetData(unsigned int frame) const;
+
+    /// Returns the palette of the given frame, in RGB format.
+    unsigned char* GetPalette(unsigned int frame) const;
+
+    /// Returns the number of colours in the palette of the given frame.
+    unsigned int GetNcolours(unsigned int frame) const;
+
+    /// Returns the index of the transparent colour or -1 if there is none.
+    int GetTransparentColourIndex(unsigned int frame) const;
+
+    /// Returns @true if the image has more than one frame.
+    bool IsAnimation() const;
+
+    /// Frees all the frames.
+    void Destroy();
+
+    /**
+        Converts the given frame to wxImage.
+
+        Returns @false if the frame couldn't be decoded.
+     */
+    bool ConvertToImage(unsigned int frame, wxImage *image) const;
+};
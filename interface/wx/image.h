@@ -452,6 +452,24 @@ const unsigned char wxIMAGE_ALPHA_THRESHOLD = 0x80;
     Saving GIFs requires images of maximum 8 bpp (see wxQuantize), and the alpha channel converted to a mask (see wxImage::ConvertAlphaToMask).
     Saving an animated GIF requires images of the same size (see wxGIFHandler::SaveAnimation)
 
+
+    @section image_threads Using wxImage in multiple threads
+
+    Unlike wxBitmap, wxImage doesn't use any platform-specific resources and
+    can be used from worker threads, e.g. to load, scale and save many images
+    in parallel. All the standard image handlers listed above are reentrant,
+    i.e. they keep all the state of loading or saving an image in local
+    variables, so the same handler can be used by several threads at once.
+
+    However the list of the image handlers itself is global and not protected
+    by any lock, so all the handlers must be added, using wxImage::AddHandler()
+    or ::wxInitAllImageHandlers(), in the main thread before starting any other
+    threads using them, and not added or removed while they are running. Also
+    notice that wxImage objects use reference counting which is not thread-safe,
+    so an image can't be shared between the threads: it must be either used by
+    only one of them at a time, without keeping any copies of it in the other
+    threads, or explicitly copied using Copy().
+
     @library{wxcore}
     @category{gdi}
 
@@ -1197,12 +1215,13 @@ public:
             max width given if it is not 0 @em and its height is less than the
             max height given if it is not 0. This is typically used for loading
             thumbnails and the advantage of using these options compared to
-            calling Rescale() after loading is that some handlers (only JPEG
-            one right now) support rescaling the image during loading which is
-            vastly more efficient than loading the entire huge image and
-            rescaling it later (if these options are not supported by the
-            handler, this is still what happens however). These options must be
-            set before calling LoadFile() to have any effect.
+            calling Rescale() after loading is that some handlers (JPEG and,
+            for non-interlaced images, PNG ones right now) support rescaling
+            the image during loading which is vastly more efficient than
+            loading the entire huge image and rescaling it later (if these
+            options are not supported by the handler, this is still what
+            happens however). These options must be set before calling
+            LoadFile() to have any effect.
 
         @li @c wxIMAGE_OPTION_ORIGINAL_WIDTH and @c wxIMAGE_OPTION_ORIGINAL_HEIGHT:
             These options will return the original size of the image if either
@@ -5,6 +5,26 @@
 // Licence:     wxWindows licence
 /////////////////////////////////////////////////////////////////////////////
 
+/// Use the Windows system colours in the palette, this is only used by wxMSW.
+#define wxQUANTIZE_INCLUDE_WINDOWS_COLOURS      0x01
+
+/// Return the image as palette indices in the @c eightBitData parameter.
+#define wxQUANTIZE_RETURN_8BIT_DATA             0x02
+
+/// Store the quantized image in the destination image.
+#define wxQUANTIZE_FILL_DESTINATION_IMAGE       0x04
+
+/**
+    Use ordered dithering instead of the default Floyd-Steinberg one.
+
+    Ordered dithering produces slightly worse results, but is several times
+    faster and, as each pixel is processed independently of the others, it
+    can also use several threads for big images.
+
+    @since 3.1.1
+ */
+#define wxQUANTIZE_ORDERED_DITHER               0x08
+
 /**
     @class wxQuantize
 
@@ -31,10 +51,15 @@ public:
         (@a in_rows contains @a w * 3 bytes per row, @a out_rows @a w bytes per row).
         Fills @a out_rows with indexes into palette (which is also stored into @a palette
         variable).
+
+        The only flag used by this function is ::wxQUANTIZE_ORDERED_DITHER,
+        all the other ones are ignored. The @a flags parameter is new since
+        wxWidgets 3.1.1.
     */
     static void DoQuantize(unsigned int w, unsigned int h,
                            unsigned char** in_rows, unsigned char** out_rows,
-                           unsigned char* palette, int desiredNoColours);
+                           unsigned char* palette, int desiredNoColours,
+                           int flags = 0);
 
     /**
         Reduce the colours in the source image and put the result into the destination image.
@@ -42,6 +67,10 @@ public:
 
         Specify an optional palette pointer to receive the resulting palette.
         This palette may be passed to ConvertImageToBitmap, for example.
+
+        The @a flags parameter is a combination of @c wxQUANTIZE_XXX
+        constants, notably ::wxQUANTIZE_ORDERED_DITHER can be used to
+        quantize big images faster.
     */
     static bool Quantize(const wxImage& src, wxImage& dest,
                          wxPalette** pPalette, int desiredNoColours = 236,
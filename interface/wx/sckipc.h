@@ -164,6 +164,16 @@ public:
     wxTCPConnection, in order to override the communication event handlers
     to do something interesting.
 
+    Besides the synchronous Request(), which waits for the reply of the server
+    before returning, this class also provides RequestAsync() which allows to
+    send many requests without waiting for the replies, which are passed to
+    OnRequestReply() when they arrive. This is much faster when many requests
+    need to be sent, especially if the server is on another machine.
+
+    Under Unix, the server name containing a slash is interpreted as the path
+    of a Unix domain socket, which is more efficient than a TCP socket for
+    communicating with another process on the same machine.
+
     @library{wxnet}
     @category{net}
 
@@ -238,6 +248,14 @@ public:
     bool Execute(const wxString data);
     //@}
 
+    /**
+        Return the number of requests sent by RequestAsync() for which the
+        reply was not received yet.
+
+        @since 3.1.1
+    */
+    size_t GetPendingRequestsCount() const;
+
     /**
         Message sent to the client application when the server notifies it of a
         change in the data associated with the given item.
@@ -284,6 +302,40 @@ public:
                                   size_t* size,
                                   wxIPCFormat format);
 
+    /**
+        Message sent to the client application when the reply to a request
+        sent using RequestAsync() is received.
+
+        The replies are always received in the same order as the requests were
+        sent. If the server failed to process the request, @a data is @NULL and
+        @a size is 0. This is also the case for all the pending requests if the
+        connection is lost, in which case this function is called for them
+        before OnDisconnect().
+
+        Notice that the @a data pointer is only valid until this function
+        returns.
+
+        The default implementation does nothing.
+
+        @param id
+            The ID returned by RequestAsync().
+        @param item
+            The item which was requested.
+        @param data
+            The data returned by the server or @NULL.
+        @param size
+            The size of the data.
+        @param format
+            The format which was requested.
+
+        @since 3.1.1
+    */
+    virtual void OnRequestReply(wxUint32 id,
+                                const wxString& item,
+                                const void* data,
+                                size_t size,
+                                wxIPCFormat format);
+
     /**
         Message sent to the server application by the client, when the client
         wishes to start an 'advise loop' for the given topic and item.
@@ -324,6 +376,29 @@ public:
     virtual const void* Request(const wxString& item, size_t* size = 0,
                         wxIPCFormat format = wxIPC_TEXT);
 
+    /**
+        Send a request to the server without waiting for the reply.
+
+        This function causes the server connection's OnRequest() member to be
+        called, just as Request() does, but returns immediately. The reply is
+        passed to OnRequestReply() when it is received, which happens when the
+        events are dispatched by the event loop.
+
+        Any number of requests can be sent in this way, however if too many of
+        them are still waiting for the reply, this function waits until some
+        of the replies arrive, calling OnRequestReply() for them, before
+        sending the new request.
+
+        Notice that Request(), StartAdvise() and StopAdvise() can't be called
+        while there are pending requests, see GetPendingRequestsCount().
+
+        Returns the ID of the request, which is also passed to
+        OnRequestReply(), or 0 if the request couldn't be sent.
+
+        @since 3.1.1
+    */
+    wxUint32 RequestAsync(const wxString& item, wxIPCFormat format = wxIPC_TEXT);
+
     /**
         Called by the client application to ask if an advise loop can be started
         with the server.
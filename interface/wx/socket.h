@@ -696,6 +696,33 @@ enum
 };
 
 
+/**
+    Describes one of the buffers used by wxSocketBase::ReadV() and
+    wxSocketBase::WriteV().
+
+    This is similar to the standard @c iovec struct: the buffer pointer is not
+    const, but the buffers passed to WriteV() are never modified.
+
+    @library{wxnet}
+    @category{net}
+
+    @since 3.1.1
+*/
+struct wxSocketIOVec
+{
+    /// Default constructor creates an empty buffer.
+    wxSocketIOVec();
+
+    /// Constructor initializing the buffer pointer and size.
+    wxSocketIOVec(const void *buffer, wxUint32 size);
+
+    /// The buffer pointer, may be @NULL if the size is 0.
+    void *buffer;
+
+    /// The size of the buffer in bytes.
+    wxUint32 size;
+};
+
 /**
     @class wxSocketBase
 
@@ -1086,6 +1113,30 @@ public:
     */
     wxSocketBase& ReadMsg(void* buffer, wxUint32 nbytes);
 
+    /**
+        Read into several buffers at once.
+
+        This function is similar to Read() but fills the given buffers one
+        after another, using a single system call when possible instead of
+        calling Read() for each of them. This is useful for reading a
+        fixed size header and the data following it directly into separate
+        buffers, for example.
+
+        Use LastReadCount() to verify the total number of bytes actually read.
+
+        @param vec
+            Array of buffers, some of which may be empty.
+        @param count
+            Number of elements in @a vec.
+
+        @return Returns a reference to the current object.
+
+        @see Read(), WriteV()
+
+        @since 3.1.1
+    */
+    wxSocketBase& ReadV(const wxSocketIOVec* vec, int count);
+
     /**
         Use SetFlags to customize IO operation for this socket.
 
@@ -1325,6 +1376,81 @@ public:
     */
     wxSocketBase& WriteMsg(const void* buffer, wxUint32 nbytes);
 
+    /**
+        Write the data from several buffers at once.
+
+        This function is similar to Write() but sends the contents of all the
+        given buffers, in order, using a single system call when possible,
+        which is more efficient than calling Write() for each of them or
+        copying them into a single buffer first.
+
+        Use LastWriteCount() to verify the total number of bytes actually
+        written.
+
+        @param vec
+            Array of buffers, some of which may be empty.
+        @param count
+            Number of elements in @a vec.
+
+        @return Returns a reference to the current object.
+
+        @see Write(), ReadV()
+
+        @since 3.1.1
+    */
+    wxSocketBase& WriteV(const wxSocketIOVec* vec, int count);
+
+    /**
+        Enable or disable write buffering.
+
+        When write buffering is on, the data passed to Write(), WriteMsg() and
+        WriteV() is not sent immediately but accumulated in an internal buffer
+        and sent when there is enough of it or when Flush() is called. This
+        reduces the number of system calls and network packets when sending
+        many small messages, but Flush() must be called to ensure that the
+        data is sent.
+
+        The write functions behave as if all the data was sent in this mode,
+        unless an error occurs. If @b wxSOCKET_NOWAIT is used, the data which
+        can't be sent immediately remains in the buffer until the next call
+        to one of these functions or Flush().
+
+        Buffering only applies to the stream sockets. Close() tries to send
+        the data remaining in the buffer, as Flush() would do, and discards
+        whatever couldn't be sent.
+
+        Disabling buffering flushes the buffer.
+
+        @since 3.1.1
+    */
+    void SetWriteBuffering(bool buffer);
+
+    /**
+        Return @true if write buffering is enabled.
+
+        @see SetWriteBuffering()
+
+        @since 3.1.1
+    */
+    bool IsWriteBuffering() const;
+
+    /**
+        Send the data accumulated in the write buffer.
+
+        This function waits until all the data is sent, unless
+        @b wxSOCKET_NOWAIT flag is used, in which case it only sends as much
+        data as possible without blocking.
+
+        @return @true if the buffer is empty after this call, @false if some
+            data remains in it, either because an error occurred or because
+            the socket is not ready for writing in @b wxSOCKET_NOWAIT mode.
+
+        @see SetWriteBuffering()
+
+        @since 3.1.1
+    */
+    bool Flush();
+
     //@}
 
 
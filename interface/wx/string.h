@@ -352,6 +352,18 @@ public:
     */
     wxString(const wxString& stringSrc);
 
+    /**
+       Creates a string taking over the contents of a temporary string.
+
+       The contents of @a stringSrc is unspecified after calling this
+       constructor.
+
+       This constructor is only available when using C++11 compiler.
+
+       @since 3.1.1
+    */
+    wxString(wxString&& stringSrc);
+
     /**
        Construct a string consisting of @a nRepeat copies of ch.
     */
@@ -445,6 +457,13 @@ public:
     */
     wxString operator =(const wxString& str);
 
+    /**
+        Move assignment, only available when using C++11 compiler.
+
+        @since 3.1.1
+    */
+    wxString& operator =(wxString&& str);
+
     /**
         Assignment: see the relative wxString constructor.
     */
@@ -1724,6 +1743,9 @@ public:
         This static function returns the string containing the result of calling
         Printf() with the passed parameters on it.
 
+        If the same format is used many times, consider using
+        wxParsedFormatString for it.
+
         @see FormatV(), Printf()
     */
     static wxString Format(const wxString& format, ...);
@@ -1909,6 +1931,55 @@ wxString wxEmptyString;
 
 
 
+/**
+    @class wxParsedFormatString
+
+    Format string which can be used efficiently many times.
+
+    Objects of this class can be passed to wxString::Format(), wxPrintf(),
+    wxLogMessage() and all the other functions taking printf()-like format
+    string instead of a plain string. The difference is that the work
+    depending only on the format string itself, such as finding the types of
+    the arguments expected by it and converting it to the form used by the
+    underlying printf() implementation, is done only once, when the object is
+    created, and not during each call. This can make a noticeable difference
+    for the code formatting many strings using the same format, e.g.
+
+    @code
+        static const wxParsedFormatString s_format("Item %zu of %s: %s");
+
+        for ( size_t n = 0; n < items.size(); n++ )
+            wxLogMessage(s_format, n, listName, items[n].GetName());
+    @endcode
+
+    The object must exist for as long as it is used, but it is never modified
+    after being constructed, so it is safe to use the same object from several
+    threads simultaneously.
+
+    @since 3.1.1
+
+    @library{wxbase}
+    @category{data}
+*/
+class wxParsedFormatString
+{
+public:
+    //@{
+    /**
+        Creates the object for the given format string.
+    */
+    wxParsedFormatString(const char *format);
+    wxParsedFormatString(const wchar_t *format);
+    wxParsedFormatString(const wxString& format);
+    //@}
+
+    /**
+        Returns the format string this object was created with.
+    */
+    const wxString& GetFormat() const;
+};
+
+
 /**
     @class wxStringBufferLength
 
@@ -0,0 +1,342 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        threadpool.h
+// Purpose:     interface of wxThreadPool and related classes
+// Author:      wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+    @class wxThreadPoolTask
+
+    Base class for the tasks executed by wxThreadPool.
+
+    Derive from this class and override its Run() method to do the work in one
+    of the pool threads. Optionally override OnDone() too to be notified, in
+    the main thread, when the task finishes running.
+
+    The tasks must be allocated on the heap and are reference counted: the
+    pool keeps a reference to the task until it is done and the code which
+    queued the task may keep another one, using wxThreadPoolTaskPtr returned
+    by wxThreadPool::Queue() or wxTaskGroup::Run(), to wait for it, cancel it
+    or retrieve its results. The task is deleted when the last reference to
+    it is released.
+
+    Example:
+    @code
+    class ChecksumTask : public wxThreadPoolTask
+    {
+    public:
+        explicit ChecksumTask(const wxString& filename)
+            : m_filename(filename), m_checksum(0)
+        {
+        }
+
+        virtual void Run() wxOVERRIDE
+        {
+            // Compute m_checksum, checking IsCancelled() periodically.
+        }
+
+        virtual void OnDone() wxOVERRIDE
+        {
+            // This is executed in the main thread, so it can update the UI.
+            wxLogMessage("Checksum of %s is %08x", m_filename, m_checksum);
+        }
+
+    private:
+        const wxString m_filename;
+        wxUint32 m_checksum;
+    };
+
+    wxThreadPool::Get().Queue(new ChecksumTask("file.dat"));
+    @endcode
+
+    @library{wxbase}
+    @category{threading}
+
+    @see wxThreadPool, wxTaskGroup
+
+    @since 3.1.1
+*/
+class wxThreadPoolTask
+{
+public:
+    /**
+        Default constructor.
+    */
+    wxThreadPoolTask();
+
+    /**
+        Do the work of this task.
+
+        This function is called in one of the pool threads, or in a thread
+        waiting for the pool tasks to complete, and so must not use any GUI
+        functions.
+
+        It is not called at all if the task is cancelled before it starts
+        running.
+    */
+    virtual void Run() = 0;
+
+    /**
+        Called after Run() returns.
+
+        This function is called from the event loop of the main thread, using
+        wxEvtHandler::CallAfter(), so it's safe to update the GUI from it.
+
+        It is not called if the task was cancelled before running, if
+        SetNotifyDone() was used to disable it or if there is no application
+        object.
+
+        The default implementation does nothing.
+    */
+    virtual void OnDone();
+
+    /**
+        Cancel the task.
+
+        If the task hasn't started running yet, it will be discarded without
+        calling Run(). Otherwise the task keeps running, but Run() may check
+        IsCancelled() and return early.
+    */
+    void Cancel();
+
+    /**
+        Return @true if Cancel() was called for this task or for the group
+        it belongs to.
+    */
+    bool IsCancelled() const;
+
+    /**
+        Return @true if the task has finished running or was discarded
+        because it had been cancelled before starting to run.
+    */
+    bool IsDone() const;
+
+    /**
+        Wait until the task is done.
+
+        Instead of simply blocking, the calling thread executes the other
+        pending tasks of the pool while waiting, so this function can be
+        safely called from inside another task.
+
+        Notice that this function doesn't wait for OnDone() to be called.
+    */
+    void Wait();
+
+    /**
+        Increment the reference count.
+
+        This function is used by wxThreadPoolTaskPtr and is thread-safe.
+    */
+    void IncRef();
+
+    /**
+        Decrement the reference count and delete the task if it drops to 0.
+
+        This function is used by wxThreadPoolTaskPtr and is thread-safe.
+    */
+    void DecRef();
+
+protected:
+    /**
+        Protected destructor: the tasks are deleted by DecRef() only.
+    */
+    virtual ~wxThreadPoolTask();
+
+    /**
+        Enable or disable calling OnDone().
+
+        By default OnDone() is called for all tasks, which requires queuing an
+        event to the main thread. Tasks which don't override OnDone() may call
+        this function with @false argument to avoid this overhead.
+
+        This function must be called before queuing the task, typically from
+        the derived class constructor.
+    */
+    void SetNotifyDone(bool notify);
+};
+
+/**
+    Smart pointer keeping a reference to a wxThreadPoolTask.
+
+    @since 3.1.1
+*/
+typedef wxObjectDataPtr<wxThreadPoolTask> wxThreadPoolTaskPtr;
+
+/**
+    @class wxThreadPool
+
+    A pool of threads executing wxThreadPoolTask objects.
+
+    The pool uses a fixed number of threads, by default equal to the number
+    of CPUs. Each of them has its own queue of tasks: the tasks queued from
+    inside another task are added to the queue of the thread running it and
+    are executed by this thread in the last-in first-out order, while the idle
+    threads steal the oldest tasks from the queues of the busy ones. The tasks
+    queued from the other threads are put in a shared queue and executed in
+    the order they were queued in.
+
+    The global pool returned by Get() is sufficient in most cases, but it is
+    also possible to create pools with a different number of threads.
+
+    @library{wxbase}
+    @category{threading}
+
+    @see wxTaskGroup, wxThreadPoolTask
+
+    @since 3.1.1
+*/
+class wxThreadPool
+{
+public:
+    /**
+        Create a pool with the given number of threads.
+
+        If @a numThreads is 0, the number of threads is equal to the number of
+        CPUs, as returned by wxThread::GetCPUCount().
+    */
+    explicit wxThreadPool(int numThreads = 0);
+
+    /**
+        Destroy the pool.
+
+        This waits for the currently running tasks to finish and discards all
+        the tasks which haven't started running yet.
+    */
+    ~wxThreadPool();
+
+    /**
+        Return the global thread pool.
+
+        The global pool is created on first use and destroyed when the library
+        is shut down.
+    */
+    static wxThreadPool& Get();
+
+    /**
+        Return the number of threads in this pool.
+    */
+    int GetThreadCount() const;
+
+    /**
+        Queue the task for execution in one of the pool threads.
+
+        The pool takes ownership of the task, which must have been allocated
+        on the heap. The returned pointer may be used to wait for the task
+        completion or to cancel it and can be ignored if this is not needed.
+    */
+    wxThreadPoolTaskPtr Queue(wxThreadPoolTask *task);
+
+    /**
+        Process the given range of integers in parallel.
+
+        The range [@a begin, @a end) is split into consecutive subranges and
+        @a func is called with the bounds of each of them, i.e. as
+        @c func(from,to), in the pool threads and in the calling thread. This
+        function returns only after all of them have been processed.
+
+        The @a func object is copied for each subrange, so it must be cheap
+        to copy, and it must be safe to call it from several threads at once.
+
+        The subranges contain at least @a grain elements, which can be
+        increased if processing a single element is very fast to reduce the
+        overhead of scheduling.
+
+        Example:
+        @code
+        struct Brighten
+        {
+            void operator()(int from, int to) const
+            {
+                for ( int y = from; y < to; y++ )
+                    ... process the row y of the image ...
+            }
+        };
+
+        wxThreadPool::Get().ParallelFor(0, height, Brighten());
+        @endcode
+
+        With a C++11 compiler, a lambda can be used as well.
+    */
+    template <typename F>
+    void ParallelFor(int begin, int end, const F& func, int grain = 1);
+};
+
+/**
+    @class wxTaskGroup
+
+    A group of tasks which can be waited for or cancelled together.
+
+    The group must outlive its tasks, so its destructor cancels all the tasks
+    which haven't started running yet and waits for the ones which are still
+    running. This makes it convenient to create the group on the stack:
+    @code
+    void ProcessFiles(const wxArrayString& files)
+    {
+        wxTaskGroup group;
+        for ( size_t n = 0; n < files.size(); n++ )
+            group.Run(new ProcessFileTask(files[n]));
+
+        group.Wait();
+    }
+    @endcode
+
+    @library{wxbase}
+    @category{threading}
+
+    @see wxThreadPool, wxThreadPoolTask
+
+    @since 3.1.1
+*/
+class wxTaskGroup
+{
+public:
+    /**
+        Create a group of tasks running in the given pool.
+    */
+    explicit wxTaskGroup(wxThreadPool& pool = wxThreadPool::Get());
+
+    /**
+        Cancel the tasks which haven't started yet and wait for the rest.
+    */
+    ~wxTaskGroup();
+
+    /**
+        Return the pool used by this group.
+    */
+    wxThreadPool& GetPool() const;
+
+    /**
+        Queue the task as part of this group.
+
+        This is the same as wxThreadPool::Queue() except that the task also
+        becomes part of the group.
+    */
+    wxThreadPoolTaskPtr Run(wxThreadPoolTask *task);
+
+    /**
+        Cancel all the tasks of this group.
+
+        This affects the tasks added to the group later too and works in the
+        same way as calling wxThreadPoolTask::Cancel() for all of them.
+    */
+    void Cancel();
+
+    /**
+        Return @true if Cancel() was called.
+    */
+    bool IsCancelled() const;
+
+    /**
+        Return @true if all the tasks of this group are done.
+    */
+    bool IsDone() const;
+
+    /**
+        Wait until all the tasks of this group are done.
+
+        As with wxThreadPoolTask::Wait(), the calling thread executes the
+        pending tasks of the pool while waiting.
+    */
+    void Wait();
+};
@@ -908,3 +908,161 @@ public:
     */
     static wxVersionInfo GetLibraryVersionInfo();
 };
+
+
+
+/**
+    Types of the items returned by wxXmlReader::Next().
+
+    @since 3.1.1
+*/
+enum wxXmlReaderItemType
+{
+    /// End of the document was reached or a parsing error occurred.
+    wxXML_READER_END,
+
+    /// Start tag of an element, possibly having attributes.
+    wxXML_READER_START_ELEMENT,
+
+    /// End tag of an element, also returned for the empty elements.
+    wxXML_READER_END_ELEMENT,
+
+    /// Text contents of an element, including CDATA sections.
+    wxXML_READER_TEXT
+};
+
+/**
+    @class wxXmlReader
+
+    This class parses XML data incrementally, reading the input stream in
+    chunks, and returns the items found in it one by one.
+
+    Unlike wxXmlDocument, it doesn't build the tree of all the nodes in memory,
+    which makes it more suitable for processing big documents or for looking
+    for just a few elements in them. Comments, processing instructions and the
+    document type declaration are skipped.
+
+    Example:
+    @code
+    wxFileInputStream stream("data.xml");
+    wxXmlReader reader(stream);
+
+    for ( ;; )
+    {
+        wxXmlReaderItemType type = reader.Next();
+        if ( type == wxXML_READER_END )
+            break;
+
+        if ( type == wxXML_READER_START_ELEMENT &&
+                strcmp(reader.GetName(), "item") == 0 )
+        {
+            const char* id = reader.GetAttribute("id");
+            ...
+        }
+    }
+
+    if ( !reader.IsOk() )
+        ... handle the error ...
+    @endcode
+
+    Notice that all the strings returned by this class are in UTF-8 and remain
+    valid only until the next call to Next().
+
+    @since 3.1.1
+
+    @library{wxxml}
+    @category{xml}
+
+    @see wxXmlDocument
+*/
+class wxXmlReader
+{
+public:
+    /**
+        Creates the reader for the given stream.
+
+        The stream must remain valid during the entire lifetime of the reader.
+
+        @param stream
+            The stream to read XML data from.
+        @param flags
+            Same as for wxXmlDocument::Load(), i.e. whitespace-only text is
+            skipped unless wxXMLDOC_KEEP_WHITESPACE_NODES is specified.
+    */
+    wxXmlReader(wxInputStream& stream, int flags = wxXMLDOC_NONE);
+
+    /**
+        Destructor.
+    */
+    ~wxXmlReader();
+
+    /**
+        Advances to the next item and returns its type.
+
+        Adjacent text and CDATA sections are returned as a single text item.
+        Once wxXML_READER_END is returned, all subsequent calls return it too.
+    */
+    wxXmlReaderItemType Next();
+
+    /**
+        Returns @false if a parsing error occurred.
+
+        This should be checked after Next() returns wxXML_READER_END to
+        distinguish between the end of a well-formed document and an error.
+    */
+    bool IsOk() const;
+
+    /**
+        Returns the type of the current item.
+    */
+    wxXmlReaderItemType GetType() const;
+
+    /**
+        Returns the line number at which the current item starts.
+    */
+    int GetLineNumber() const;
+
+    /**
+        Returns the name of the element.
+
+        Can only be called for wxXML_READER_START_ELEMENT and
+        wxXML_READER_END_ELEMENT items.
+    */
+    const char* GetName() const;
+
+    /**
+        Returns the number of the attributes of the element.
+
+        This and the other attribute accessors can only be called for
+        wxXML_READER_START_ELEMENT items.
+    */
+    size_t GetAttributesCount() const;
+
+    /**
+        Returns the name of the attribute with the given index.
+    */
+    const char* GetAttributeName(size_t n) const;
+
+    /**
+        Returns the value of the attribute with the given index.
+    */
+    const char* GetAttributeValue(size_t n) const;
+
+    /**
+        Returns the value of the attribute with the given name or @NULL if the
+        element doesn't have such attribute.
+    */
+    const char* GetAttribute(const char* name) const;
+
+    /**
+        Returns the text, with all the entities already expanded.
+
+        Can only be called for wxXML_READER_TEXT items.
+    */
+    const char* GetText() const;
+
+    /**
+        Returns the length of the text in bytes.
+    */
+    size_t GetTextLength() const;
+};
@@ -423,6 +423,33 @@ public:
         @see overview_archive_byname
     */
     bool OpenEntry(wxZipEntry& entry);
+
+    /**
+        Reads the contents of all the given entries at once.
+
+        The compressed data of the entries is read from the stream one entry
+        after another, but the entries using the store or deflate methods are
+        then decompressed, and their CRC and length checked, in parallel using
+        the threads of wxThreadPool::Get(). Entries using the other methods
+        are decompressed in the calling thread, as with OpenEntry().
+
+        As with OpenEntry(), the @a entries should be from the same zip file
+        and the zip must be on a seekable stream.
+
+        @param entries
+            The entries to read, typically returned by GetNextEntry().
+        @param data
+            Filled with the contents of the entries, in the same order.
+            The buffers of the entries which couldn't be read are left empty.
+        @return
+            @true if all the entries were read successfully, @false if
+            there was an error, which is logged as when reading the entries
+            normally.
+
+        @since 3.1.1
+    */
+    bool ReadEntries(const wxVector<wxZipEntry*>& entries,
+                     wxVector<wxMemoryBuffer>& data);
 };
 
 
@@ -538,6 +565,29 @@ public:
     void SetLevel(int level);
     //@}
 
+    //@{
+    /**
+        Enable or disable compressing the entries in parallel.
+
+        In parallel mode the data written to each entry is kept in memory
+        until the entry is closed, it is then compressed in the background
+        using the threads of wxThreadPool::Get() while the next entries are
+        being written. The entries are still written to the underlying stream
+        in the order in which they were created, as soon as their compression
+        is done.
+
+        Entries bigger than 16MB, entries for which Sync() is called and the
+        entries created by CopyEntry() are written out directly, after all the
+        entries before them, as in normal mode.
+
+        Disabling parallel mode writes out all the pending entries.
+
+        @since 3.1.1
+    */
+    void SetParallelCompression(bool parallel = true);
+    bool IsParallelCompression() const;
+    //@}
+
     /**
         Create a new directory entry (see wxArchiveEntry::IsDir) with the given
         name and timestamp.
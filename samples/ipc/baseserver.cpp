@@ -87,6 +87,10 @@ public:
                         const void *data,
                         size_t size,
                         wxIPCFormat format) wxOVERRIDE;
+    virtual const void *OnRequest(const wxString& topic,
+                                  const wxString& item,
+                                  size_t *size,
+                                  wxIPCFormat format) wxOVERRIDE;
     virtual bool OnStartAdvise(const wxString& topic, const wxString& item) wxOVERRIDE;
     virtual bool OnStopAdvise(const wxString& topic, const wxString& item) wxOVERRIDE;
 
@@ -100,6 +104,9 @@ private:
     // the item which can be manipulated by the client via Poke() calls
     wxString m_item;
 
+    // the data returned by the last OnRequest() call
+    wxCharBuffer m_requestData;
+
     // should we notify the client about changes to m_item?
     bool m_advise;
 
@@ -382,6 +389,26 @@ bool BenchConnection::OnPoke(const wxString& topic,
     return true;
 }
 
+const void *BenchConnection::OnRequest(const wxString& topic,
+                                       const wxString& item,
+                                       size_t *size,
+                                       wxIPCFormat format)
+{
+    if ( !IsSupportedTopicAndItem("OnRequest", topic, item) )
+        return NULL;
+
+    if ( format != wxIPC_TEXT )
+    {
+        wxLogMessage("Unexpected format %d in OnRequest().", format);
+        return NULL;
+    }
+
+    m_requestData = m_item.mb_str();
+    *size = m_requestData.length() + 1; // include the trailing NUL
+
+    return m_requestData.data();
+}
+
 bool BenchConnection::OnStartAdvise(const wxString& topic, const wxString& item)
 {
     if ( !IsSupportedTopicAndItem("OnStartAdvise", topic, item) )
@@ -50,6 +50,7 @@
 
 #if wxUSE_BASE
     #include "wx/scopedptr.h"
+    #include "wx/weakref.h"
 
     wxDECLARE_SCOPED_PTR(wxEvent, wxEventPtr)
     wxDEFINE_SCOPED_PTR(wxEvent, wxEventPtr)
@@ -1099,6 +1100,105 @@ void wxEventHashTable::GrowEventTypeTable()
     delete[] oldEventTypeTable;
 }
 
+// ----------------------------------------------------------------------------
+// wxPendingEvents
+// ----------------------------------------------------------------------------
+
+// The events queued for a single wxEvtHandler.
+//
+// The events can be queued from any thread and are stored in the queue
+// protected by wxEvtHandler::m_pendingEventsLock. They are processed in the
+// main thread only, after moving all of the currently queued events to the
+// batch, which is done under the lock, while the events are taken from the
+// batch without locking. This means that the lock needs to be acquired only
+// once for processing all the events queued before, instead of doing it for
+// every event.
+class wxPendingEvents
+{
+public:
+    wxPendingEvents() { m_batchFirst = 0; m_delayed = false; }
+    ~wxPendingEvents() { DeleteAll(); }
+
+    // The functions working with the queue must be called with the lock held.
+    bool HasQueued() const { return !m_queue.empty(); }
+
+    void Queue(wxEvent *event) { m_queue.push_back(event); }
+
+    void MoveQueuedToBatch()
+    {
+        if ( !HasBatched() )
+        {
+            // reuse the memory of the old batch for the new queue to avoid
+            // reallocating it when the events keep being queued
+            m_batch.clear();
+            m_batchFirst = 0;
+            m_batch.swap(m_queue);
+        }
+        else
+        {
+            for ( size_t n = 0; n < m_queue.size(); n++ )
+                m_batch.push_back(m_queue[n]);
+
+            m_queue.clear();
+        }
+    }
+
+    // The functions working with the batch are only used from the main thread.
+    bool HasBatched() const { return m_batchFirst < m_batch.size(); }
+
+    // Take the first event of the batch which can be processed now or return
+    // NULL if there are none.
+    wxEvent *TakeFromBatch()
+    {
+        if ( !HasBatched() )
+            return NULL;
+
+        const wxEventLoopBase * const evtLoop = wxEventLoopBase::GetActive();
+        if ( !evtLoop || !evtLoop->IsYielding() )
+            return m_batch[m_batchFirst++];
+
+        for ( size_t n = m_batchFirst; n < m_batch.size(); n++ )
+        {
+            wxEvent * const event = m_batch[n];
+            if ( evtLoop->IsEventAllowedInsideYield(event->GetEventCategory()) )
+            {
+                m_batch.erase(m_batch.begin() + n);
+                return event;
+            }
+        }
+
+        return NULL;
+    }
+
+    // Delete all the events, both queued and batched ones.
+    void DeleteAll()
+    {
+        size_t n;
+        for ( n = 0; n < m_queue.size(); n++ )
+            delete m_queue[n];
+        m_queue.clear();
+
+        for ( n = m_batchFirst; n < m_batch.size(); n++ )
+            delete m_batch[n];
+        m_batch.clear();
+        m_batchFirst = 0;
+    }
+
+    // True if our handler is in the list of handlers with delayed events, as
+    // it must be appended to the list of handlers with pending events again
+    // when a new event is queued even if the queue is not empty then.
+    bool m_delayed;
+
+private:
+    wxVector<wxEvent *> m_queue;
+
+    // The events in the batch before m_batchFirst were already processed.
+    wxVector<wxEvent *> m_batch;
+    size_t m_batchFirst;
+
+    wxDECLARE_NO_COPY_CLASS(wxPendingEvents);
+};
+
 // ----------------------------------------------------------------------------
 // wxEvtHandler
 // ----------------------------------------------------------------------------
@@ -1252,14 +1352,21 @@ void wxEvtHandler::QueueEvent(wxEvent *event)
     wxENTER_CRIT_SECT( m_pendingEventsLock );
 
     if ( !m_pendingEvents )
-        m_pendingEvents = new wxList;
+        m_pendingEvents = new wxPendingEvents;
+
+    const bool wasEmpty = !m_pendingEvents->HasQueued();
 
-    m_pendingEvents->Append(event);
+    m_pendingEvents->Queue(event);
 
     // 2) Add this event handler to list of event handlers that
     //    have pending events.
-
-    wxTheApp->AppendPendingEventHandler(this);
+    //
+    // The handler is always in this list if it has any queued events, unless
+    // it's in the list of handlers with delayed events, so we only need to do
+    // it for the first one. This avoids locking the global list for all the
+    // events when many of them are queued from another thread.
+    if ( wasEmpty || m_pendingEvents->m_delayed )
+        wxTheApp->AppendPendingEventHandler(this);
 
     // only release m_pendingEventsLock now because otherwise there is a race
     // condition as described in the ticket #9093: we could process the event
@@ -1276,8 +1383,6 @@ void wxEvtHandler::QueueEvent(wxEvent *event)
 
 void wxEvtHandler::DeletePendingEvents()
 {
-    if (m_pendingEvents)
-        m_pendingEvents->DeleteContents(true);
     wxDELETE(m_pendingEvents);
 }
 
@@ -1291,65 +1396,77 @@ void wxEvtHandler::ProcessPendingEvents()
         return;
     }
 
-    // we need to process only a single pending event in this call because
-    // each call to ProcessEvent() could result in the destruction of this
-    // same event handler (see the comment at the end of this function)
-
+    // take all the events queued until now at once, the events queued while
+    // we're processing them will be processed during the next call
     wxENTER_CRIT_SECT( m_pendingEventsLock );
 
+    const bool hasEvents = m_pendingEvents &&
+                            (m_pendingEvents->HasBatched() ||
+                                m_pendingEvents->HasQueued());
+    if ( hasEvents )
+        m_pendingEvents->MoveQueuedToBatch();
+
+    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
+
     // this method is only called by wxApp if this handler does have
     // pending events
-    wxCHECK_RET( m_pendingEvents && !m_pendingEvents->IsEmpty(),
-                 "should have pending events if called" );
+    wxCHECK_RET( hasEvents, "should have pending events if called" );
 
-    wxList::compatibility_iterator node = m_pendingEvents->GetFirst();
-    wxEvent* pEvent = static_cast<wxEvent *>(node->GetData());
+    // each call to ProcessEvent() could result in the destruction of this
+    // same event handler, in which case it also deletes all the remaining
+    // events and we must not access any of its fields any more
+    wxWeakRef<wxEvtHandler> self(this);
 
-    // find the first event which can be processed now:
-    wxEventLoopBase* evtLoop = wxEventLoopBase::GetActive();
-    if (evtLoop && evtLoop->IsYielding())
+    // notice that m_pendingEvents must be checked on every iteration as the
+    // event handler could have called DeletePendingEvents()
+    while ( m_pendingEvents )
     {
-        while (node && pEvent && !evtLoop->IsEventAllowedInsideYield(pEvent->GetEventCategory()))
-        {
-            node = node->GetNext();
-            pEvent = node ? static_cast<wxEvent *>(node->GetData()) : NULL;
-        }
+        // it's important we remove event from the batch before processing it,
+        // else a nested event loop, for example from a modal dialog, might
+        // process the same event again.
+        wxEventPtr event(m_pendingEvents->TakeFromBatch());
+        if ( !event.get() )
+            break;
+
+        ProcessEvent(*event);
+
+        if ( !self )
+            return;
+    }
+
+    wxENTER_CRIT_SECT( m_pendingEventsLock );
 
-        if (!node)
+    if ( !m_pendingEvents || !m_pendingEvents->HasQueued() )
+    {
+        if ( m_pendingEvents && m_pendingEvents->HasBatched() )
         {
-            // all our events are NOT processable now... signal this:
+            // all our remaining events are NOT processable now... signal this:
+            m_pendingEvents->m_delayed = true;
             wxTheApp->DelayPendingEventHandler(this);
 
             // see the comment at the beginning of evtloop.h header for the
             // logic behind YieldFor() and behind DelayPendingEventHandler()
-
-            wxLEAVE_CRIT_SECT( m_pendingEventsLock );
-
-            return;
+        }
+        else
+        {
+            // if there are no more pending events left, we don't need to
+            // stay in this list
+            wxTheApp->RemovePendingEventHandler(this);
+
+            // and the next queued event must add us to it again, but only
+            // that one: it's not delayed any more
+            if ( m_pendingEvents )
+                m_pendingEvents->m_delayed = false;
         }
     }
-
-    wxEventPtr event(pEvent);
-
-    // it's important we remove event from list before processing it, else a
-    // nested event loop, for example from a modal dialog, might process the
-    // same event again.
-    m_pendingEvents->Erase(node);
-
-    if ( m_pendingEvents->IsEmpty() )
+    else
     {
-        // if there are no more pending events left, we don't need to
-        // stay in this list
-        wxTheApp->RemovePendingEventHandler(this);
+        // we remain in the list of handlers with pending events and will be
+        // called again to process the newly queued events
+        m_pendingEvents->m_delayed = false;
     }
 
     wxLEAVE_CRIT_SECT( m_pendingEventsLock );
-
-    ProcessEvent(*event);
-
-    // careful: this object could have been deleted by the event handler
-    // executed by the above ProcessEvent() call, so we can't access any fields
-    // of this object any more
 }
 
 /* static */
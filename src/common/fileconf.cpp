@@ -63,8 +63,11 @@
 // ----------------------------------------------------------------------------
 
 // compare functions for sorting the arrays
-static int LINKAGEMODE CompareEntries(wxFileConfigEntry *p1, wxFileConfigEntry *p2);
-static int LINKAGEMODE CompareGroups(wxFileConfigGroup *p1, wxFileConfigGroup *p2);
+static int LINKAGEMODE CompareEntries(wxFileConfigEntry **pp1, wxFileConfigEntry **pp2);
+static int LINKAGEMODE CompareGroups(wxFileConfigGroup **pp1, wxFileConfigGroup **pp2);
+
+// return the key used for the entry or group name in the hash maps
+static wxString GetHashKey(const wxString& name);
 
 // filter strings
 static wxString FilterInValue(const wxString& str);
@@ -85,15 +88,19 @@ static wxString GetAppName(const wxString& appname);
 // ----------------------------------------------------------------------------
 
 #ifdef WXMAKINGDLL_BASE
-    WX_DEFINE_SORTED_USER_EXPORTED_ARRAY(wxFileConfigEntry *, ArrayEntries,
-                                         WXDLLIMPEXP_BASE);
-    WX_DEFINE_SORTED_USER_EXPORTED_ARRAY(wxFileConfigGroup *, ArrayGroups,
-                                         WXDLLIMPEXP_BASE);
+    WX_DEFINE_USER_EXPORTED_ARRAY_PTR(wxFileConfigEntry *, ArrayEntries,
+                                      WXDLLIMPEXP_BASE);
+    WX_DEFINE_USER_EXPORTED_ARRAY_PTR(wxFileConfigGroup *, ArrayGroups,
+                                      WXDLLIMPEXP_BASE);
 #else
-    WX_DEFINE_SORTED_ARRAY(wxFileConfigEntry *, ArrayEntries);
-    WX_DEFINE_SORTED_ARRAY(wxFileConfigGroup *, ArrayGroups);
+    WX_DEFINE_ARRAY_PTR(wxFileConfigEntry *, ArrayEntries);
+    WX_DEFINE_ARRAY_PTR(wxFileConfigGroup *, ArrayGroups);
 #endif
 
+// hash maps used for finding the entries and groups by name
+WX_DECLARE_STRING_HASH_MAP(wxFileConfigEntry *, HashEntries);
+WX_DECLARE_STRING_HASH_MAP(wxFileConfigGroup *, HashGroups);
+
 // ----------------------------------------------------------------------------
 // wxFileConfigLineList
 // ----------------------------------------------------------------------------
@@ -176,8 +183,18 @@ class wxFileConfigGroup
 private:
   wxFileConfig *m_pConfig;          // config object we belong to
   wxFileConfigGroup  *m_pParent;    // parent group (NULL for root group)
-  ArrayEntries  m_aEntries;         // entries in this group
-  ArrayGroups   m_aSubgroups;       // subgroups
+
+  // entries and subgroups of this group: the arrays are only sorted on
+  // demand, when they're used for enumerating them, to avoid the cost of
+  // keeping them sorted when adding many items, and the hashes are used for
+  // finding them by name
+  mutable ArrayEntries  m_aEntries; // entries in this group
+  mutable ArrayGroups   m_aSubgroups; // subgroups
+  mutable bool  m_bEntriesSorted,   // true if the arrays above are sorted
+                m_bSubgroupsSorted;
+  HashEntries   m_hashEntries;      // entries by their (hash key) names
+  HashGroups    m_hashSubgroups;    // subgroups by their (hash key) names
+
   wxString      m_strName;          // group's name
   wxFileConfigLineList *m_pLine;    // pointer to our line in the linked list
   wxFileConfigEntry *m_pLastEntry;  // last entry/subgroup of this group in the
@@ -201,9 +218,10 @@ public:
   wxFileConfigGroup    *Parent()  const { return m_pParent; }
   wxFileConfig   *Config()  const { return m_pConfig; }
 
-  const ArrayEntries& Entries() const { return m_aEntries;   }
-  const ArrayGroups&  Groups()  const { return m_aSubgroups; }
-  bool  IsEmpty() const { return Entries().IsEmpty() && Groups().IsEmpty(); }
+  // return the entries/subgroups sorted by name
+  const ArrayEntries& Entries() const;
+  const ArrayGroups&  Groups()  const;
+  bool  IsEmpty() const { return m_aEntries.IsEmpty() && m_aSubgroups.IsEmpty(); }
 
   // find entry/subgroup (NULL if not found)
   wxFileConfigGroup *FindSubgroup(const wxString& name) const;
@@ -323,6 +341,11 @@ void wxFileConfig::Init()
     m_pCurrentGroup =
     m_pRootGroup    = new wxFileConfigGroup(NULL, wxEmptyString, this);
 
+    // the current path must correspond to the current group, notably when
+    // Init() is called again from DeleteAll()
+    m_strPath.Empty();
+    ResetPrevPath();
+
     m_linesHead =
     m_linesTail = NULL;
 
@@ -425,6 +448,9 @@ wxFileConfig::wxFileConfig(wxInputStream &inStream, const wxMBConv& conv)
     m_pCurrentGroup =
     m_pRootGroup    = new wxFileConfigGroup(NULL, wxEmptyString, this);
 
+    m_strPath.Empty();
+    ResetPrevPath();
+
     m_linesHead =
     m_linesTail = NULL;
 
@@ -680,6 +706,11 @@ void wxFileConfig::Parse(const wxTextBuffer& buffer, bool bLocal)
 
 void wxFileConfig::SetRootPath()
 {
+    if ( m_pCurrentGroup != m_pRootGroup ) {
+        m_strPrevPath.swap(m_strPath);
+        m_pPrevGroup = m_pCurrentGroup;
+    }
+
     m_strPath.Empty();
     m_pCurrentGroup = m_pRootGroup;
 }
@@ -694,6 +725,20 @@ wxFileConfig::DoSetPath(const wxString& strPath, bool createMissingComponents)
         return true;
     }
 
+    // m_strPath and m_strPrevPath are always absolute and normalized, so if
+    // the new path is the same as one of them, it must correspond to the same
+    // group: check for this first as it's common to switch between the same
+    // paths repeatedly when reading or writing entries using absolute paths
+    // (see wxConfigPathChanger)
+    if ( strPath == m_strPath )
+        return true;
+
+    if ( m_pPrevGroup && strPath == m_strPrevPath ) {
+        m_strPrevPath.swap(m_strPath);
+        wxSwap(m_pPrevGroup, m_pCurrentGroup);
+        return true;
+    }
+
     if ( strPath[0] == wxCONFIG_PATH_SEPARATOR ) {
         // absolute path
         wxSplitPath(aParts, strPath);
@@ -705,22 +750,29 @@ wxFileConfig::DoSetPath(const wxString& strPath, bool createMissingComponents)
         wxSplitPath(aParts, strFullPath);
     }
 
-    // change current group
+    // find the new group
     size_t n;
-    m_pCurrentGroup = m_pRootGroup;
+    wxFileConfigGroup *pGroup = m_pRootGroup;
     for ( n = 0; n < aParts.GetCount(); n++ ) {
-        wxFileConfigGroup *pNextGroup = m_pCurrentGroup->FindSubgroup(aParts[n]);
+        wxFileConfigGroup *pNextGroup = pGroup->FindSubgroup(aParts[n]);
         if ( pNextGroup == NULL )
         {
             if ( !createMissingComponents )
                 return false;
 
-            pNextGroup = m_pCurrentGroup->AddSubgroup(aParts[n]);
+            pNextGroup = pGroup->AddSubgroup(aParts[n]);
         }
 
-        m_pCurrentGroup = pNextGroup;
+        pGroup = pNextGroup;
     }
 
+    // remember the current path to be able to return to it quickly and
+    // change the current group
+    m_strPrevPath.swap(m_strPath);
+    m_pPrevGroup = m_pCurrentGroup;
+
+    m_pCurrentGroup = pGroup;
+
     // recombine path parts in one variable
     m_strPath.Empty();
     for ( n = 0; n < aParts.GetCount(); n++ ) {
@@ -730,6 +782,12 @@ wxFileConfig::DoSetPath(const wxString& strPath, bool createMissingComponents)
     return true;
 }
 
+void wxFileConfig::ResetPrevPath()
+{
+    m_strPrevPath.Empty();
+    m_pPrevGroup = NULL;
+}
+
 void wxFileConfig::SetPath(const wxString& strPath)
 {
     DoSetPath(strPath, true /* create missing path components */);
@@ -1108,6 +1166,9 @@ bool wxFileConfig::RenameGroup(const wxString& oldName,
 
     group->Rename(newName);
 
+    // the previous path could have referred to this group
+    ResetPrevPath();
+
     SetDirty();
 
     return true;
@@ -1131,6 +1192,7 @@ bool wxFileConfig::DeleteEntry(const wxString& key, bool bGroupIfEmptyAlso)
       wxFileConfigGroup *pGroup = m_pCurrentGroup;
       SetPath(wxT(".."));  // changes m_pCurrentGroup!
       m_pCurrentGroup->DeleteSubgroupByName(pGroup->Name());
+      ResetPrevPath();
     }
     //else: never delete the root group
   }
@@ -1145,6 +1207,9 @@ bool wxFileConfig::DeleteGroup(const wxString& key)
   if ( !m_pCurrentGroup->DeleteSubgroupByName(path.Name()) )
       return false;
 
+  // the previous path could have referred to the deleted group
+  ResetPrevPath();
+
   path.UpdateIfDeleted();
 
   SetDirty();
@@ -1331,14 +1396,15 @@ bool wxFileConfig::LineListIsEmpty()
 wxFileConfigGroup::wxFileConfigGroup(wxFileConfigGroup *pParent,
                                        const wxString& strName,
                                        wxFileConfig *pConfig)
-                         : m_aEntries(CompareEntries),
-                           m_aSubgroups(CompareGroups),
-                           m_strName(strName)
+                         : m_strName(strName)
 {
   m_pConfig = pConfig;
   m_pParent = pParent;
   m_pLine   = NULL;
 
+  m_bEntriesSorted   =
+  m_bSubgroupsSorted = true;
+
   m_pLastEntry = NULL;
   m_pLastGroup = NULL;
 }
@@ -1357,6 +1423,30 @@ wxFileConfigGroup::~wxFileConfigGroup()
     delete m_aSubgroups[n];
 }
 
+// ----------------------------------------------------------------------------
+// accessors
+// ----------------------------------------------------------------------------
+
+const ArrayEntries& wxFileConfigGroup::Entries() const
+{
+  if ( !m_bEntriesSorted ) {
+    m_aEntries.Sort(CompareEntries);
+    m_bEntriesSorted = true;
+  }
+
+  return m_aEntries;
+}
+
+const ArrayGroups& wxFileConfigGroup::Groups() const
+{
+  if ( !m_bSubgroupsSorted ) {
+    m_aSubgroups.Sort(CompareGroups);
+    m_bSubgroupsSorted = true;
+  }
+
+  return m_aSubgroups;
+}
+
 // ----------------------------------------------------------------------------
 // line
 // ----------------------------------------------------------------------------
@@ -1529,13 +1619,15 @@ void wxFileConfigGroup::Rename(const wxString& newName)
     if ( newName == m_strName )
         return;
 
-    // we need to remove the group from the parent and it back under the new
-    // name to keep the parents array of subgroups alphabetically sorted
-    m_pParent->m_aSubgroups.Remove(this);
+    // we need to remove the group from the parent hash and add it back under
+    // the new name, the parents array of subgroups will be sorted again when
+    // it's needed
+    m_pParent->m_hashSubgroups.erase(GetHashKey(m_strName));
 
     m_strName = newName;
 
-    m_pParent->m_aSubgroups.Add(this);
+    m_pParent->m_hashSubgroups[GetHashKey(m_strName)] = this;
+    m_pParent->m_bSubgroupsSorted = false;
 
     // update the group lines recursively
     UpdateGroupAndSubgroupsLines();
@@ -1554,65 +1646,20 @@ wxString wxFileConfigGroup::GetFullName() const
 // find an item
 // ----------------------------------------------------------------------------
 
-// use binary search because the array is sorted
 wxFileConfigEntry *
 wxFileConfigGroup::FindEntry(const wxString& name) const
 {
-  size_t i,
-       lo = 0,
-       hi = m_aEntries.GetCount();
-  int res;
-  wxFileConfigEntry *pEntry;
-
-  while ( lo < hi ) {
-    i = (lo + hi)/2;
-    pEntry = m_aEntries[i];
-
-    #if wxCONFIG_CASE_SENSITIVE
-      res = pEntry->Name().compare(name);
-    #else
-      res = pEntry->Name().CmpNoCase(name);
-    #endif
-
-    if ( res > 0 )
-      hi = i;
-    else if ( res < 0 )
-      lo = i + 1;
-    else
-      return pEntry;
-  }
+  const HashEntries::const_iterator it = m_hashEntries.find(GetHashKey(name));
 
-  return NULL;
+  return it == m_hashEntries.end() ? NULL : it->second;
 }
 
 wxFileConfigGroup *
 wxFileConfigGroup::FindSubgroup(const wxString& name) const
 {
-  size_t i,
-       lo = 0,
-       hi = m_aSubgroups.GetCount();
-  int res;
-  wxFileConfigGroup *pGroup;
-
-  while ( lo < hi ) {
-    i = (lo + hi)/2;
-    pGroup = m_aSubgroups[i];
-
-    #if wxCONFIG_CASE_SENSITIVE
-      res = pGroup->Name().compare(name);
-    #else
-      res = pGroup->Name().CmpNoCase(name);
-    #endif
-
-    if ( res > 0 )
-      hi = i;
-    else if ( res < 0 )
-      lo = i + 1;
-    else
-      return pGroup;
-  }
+  const HashGroups::const_iterator it = m_hashSubgroups.find(GetHashKey(name));
 
-  return NULL;
+  return it == m_hashSubgroups.end() ? NULL : it->second;
 }
 
 // ----------------------------------------------------------------------------
@@ -1626,7 +1673,18 @@ wxFileConfigEntry *wxFileConfigGroup::AddEntry(const wxString& strName, int nLin
 
     wxFileConfigEntry   *pEntry = new wxFileConfigEntry(this, strName, nLine);
 
+    // the array remains sorted if the entries are added in order, as is
+    // often the case
+    if ( m_bEntriesSorted && !m_aEntries.IsEmpty() )
+    {
+        wxFileConfigEntry *pLast = m_aEntries.Last();
+        if ( CompareEntries(&pLast, &pEntry) > 0 )
+            m_bEntriesSorted = false;
+    }
+
     m_aEntries.Add(pEntry);
+    m_hashEntries[GetHashKey(pEntry->Name())] = pEntry;
+
     return pEntry;
 }
 
@@ -1637,7 +1695,16 @@ wxFileConfigGroup *wxFileConfigGroup::AddSubgroup(const wxString& strName)
 
     wxFileConfigGroup   *pGroup = new wxFileConfigGroup(this, strName, m_pConfig);
 
+    if ( m_bSubgroupsSorted && !m_aSubgroups.IsEmpty() )
+    {
+        wxFileConfigGroup *pLast = m_aSubgroups.Last();
+        if ( CompareGroups(&pLast, &pGroup) > 0 )
+            m_bSubgroupsSorted = false;
+    }
+
     m_aSubgroups.Add(pGroup);
+    m_hashSubgroups[GetHashKey(strName)] = pGroup;
+
     return pGroup;
 }
 
@@ -1768,6 +1835,7 @@ bool wxFileConfigGroup::DeleteSubgroup(wxFileConfigGroup *pGroup)
     }
 
     m_aSubgroups.Remove(pGroup);
+    m_hashSubgroups.erase(GetHashKey(pGroup->Name()));
     delete pGroup;
 
     return true;
@@ -1816,6 +1884,7 @@ bool wxFileConfigGroup::DeleteEntry(const wxString& name)
   }
 
   m_aEntries.Remove(pEntry);
+  m_hashEntries.erase(GetHashKey(pEntry->Name()));
   delete pEntry;
 
   return true;
@@ -1922,21 +1991,34 @@ void wxFileConfigEntry::SetValue(const wxString& strValue, bool bUser)
 // compare functions for array sorting
 // ----------------------------------------------------------------------------
 
-int CompareEntries(wxFileConfigEntry *p1, wxFileConfigEntry *p2)
+int CompareEntries(wxFileConfigEntry **pp1, wxFileConfigEntry **pp2)
 {
 #if wxCONFIG_CASE_SENSITIVE
-    return p1->Name().compare(p2->Name());
+    return (*pp1)->Name().compare((*pp2)->Name());
 #else
-    return p1->Name().CmpNoCase(p2->Name());
+    return (*pp1)->Name().CmpNoCase((*pp2)->Name());
 #endif
 }
 
-int CompareGroups(wxFileConfigGroup *p1, wxFileConfigGroup *p2)
+int CompareGroups(wxFileConfigGroup **pp1, wxFileConfigGroup **pp2)
+{
+#if wxCONFIG_CASE_SENSITIVE
+    return (*pp1)->Name().compare((*pp2)->Name());
+#else
+    return (*pp1)->Name().CmpNoCase((*pp2)->Name());
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// hash key function
+// ----------------------------------------------------------------------------
+
+static wxString GetHashKey(const wxString& name)
 {
 #if wxCONFIG_CASE_SENSITIVE
-    return p1->Name().compare(p2->Name());
+    return name;
 #else
-    return p1->Name().CmpNoCase(p2->Name());
+    return name.Lower();
 #endif
 }
 
@@ -42,6 +42,11 @@ enum
 
 #define GetFrame(n)     ((GIFImage*)m_frames[n])
 
+// The decoded data is kept only for the most recently used frames of the
+// animation whose total size doesn't exceed this limit, the other frames are
+// decoded again from their compressed data when they are needed.
+static const size_t MAX_DECODED_SIZE = 16*1024*1024;
+
 //---------------------------------------------------------------------------
 // GIFImage
 //---------------------------------------------------------------------------
@@ -53,6 +58,9 @@ public:
     // def ctor
     GIFImage();
 
+    // dtor frees the bitmap and palette
+    ~GIFImage();
+
     unsigned int w;                 // width
     unsigned int h;                 // height
     unsigned int left;              // x coord (in logical screen)
@@ -60,10 +68,13 @@ public:
     int transparent;                // transparent color index (-1 = none)
     wxAnimationDisposal disposal;   // disposal method
     long delay;                     // delay in ms (-1 = unused)
-    unsigned char *p;               // bitmap
+    unsigned char *p;               // bitmap (NULL if not decoded)
     unsigned char *pal;             // palette
     unsigned int ncolours;          // number of colours
     wxString comment;
+    wxMemoryBuffer data;            // LZW data, without sub-block sizes
+    int bits;                       // initial LZW code size
+    bool interlaced;                // true for interlaced images
 
     wxDECLARE_NO_COPY_CLASS(GIFImage);
 };
@@ -87,6 +98,14 @@ GIFImage::GIFImage()
     p = (unsigned char *) NULL;
     pal = (unsigned char *) NULL;
     ncolours = 0;
+    bits = 0;
+    interlaced = false;
+}
+
+GIFImage::~GIFImage()
+{
+    free(p);
+    free(pal);
 }
 
 //---------------------------------------------------------------------------
@@ -95,6 +114,7 @@ GIFImage::GIFImage()
 
 wxGIFDecoder::wxGIFDecoder()
 {
+    m_decodedSize = 0;
 }
 
 wxGIFDecoder::~wxGIFDecoder()
@@ -107,14 +127,14 @@ void wxGIFDecoder::Destroy()
     wxASSERT(m_nFrames==m_frames.GetCount());
     for (unsigned int i=0; i<m_nFrames; i++)
     {
-        GIFImage *f = (GIFImage*)m_frames[i];
-        free(f->p);
-        free(f->pal);
-        delete f;
+        delete (GIFImage*)m_frames[i];
     }
 
     m_frames.Clear();
     m_nFrames = 0;
+
+    m_decodedFrames.clear();
+    m_decodedSize = 0;
 }
 
 
@@ -143,6 +163,9 @@ bool wxGIFDecoder::ConvertToImage(unsigned int frame, wxImage *image) const
 
     pal = GetPalette(frame);
     src = GetData(frame);
+    if (!src)
+        return false;
+
     dst = image->GetData();
     transparent = GetTransparentColourIndex(frame);
 
@@ -240,7 +263,16 @@ wxColour wxGIFDecoder::GetTransparentColour(unsigned int frame) const
                     pal[n*3 + 2]);
 }
 
-unsigned char* wxGIFDecoder::GetData(unsigned int frame) const    { return (GetFrame(frame)->p); }
+unsigned char* wxGIFDecoder::GetData(unsigned int frame) const
+{
+    // decoding errors other than running out of memory are ignored here, as
+    // the image is returned in a partially decoded state then, just as when
+    // it is truncated
+    DecodeFrame(frame);
+
+    return GetFrame(frame)->p;
+}
+
 unsigned char* wxGIFDecoder::GetPalette(unsigned int frame) const { return (GetFrame(frame)->pal); }
 unsigned int wxGIFDecoder::GetNcolours(unsigned int frame) const  { return (GetFrame(frame)->ncolours); }
 int wxGIFDecoder::GetTransparentColourIndex(unsigned int frame) const  { return (GetFrame(frame)->transparent); }
@@ -251,96 +283,85 @@ int wxGIFDecoder::GetTransparentColourIndex(unsigned int frame) const  { return
 // GIF reading and decoding
 //---------------------------------------------------------------------------
 
-// getcode:
-//  Reads the next code from the file stream, with size 'bits'
+// ReadImageData:
+//  Reads the data sub-blocks of an image, following its initial code size,
+//  and appends their contents to the given buffer. If the stream ends before
+//  the terminating empty sub-block, the data read so far is kept.
 //
-int wxGIFDecoder::getcode(wxInputStream& stream, int bits, int ab_fin)
+static void ReadImageData(wxInputStream& stream, wxMemoryBuffer& data)
 {
-    unsigned int mask;          // bit mask
-    unsigned int code;          // code (result)
-
-    // get remaining bits from last byte read
-    mask = (1 << bits) - 1;
-    code = (m_lastbyte >> (8 - m_restbits)) & mask;
-
-    // keep reading new bytes while needed
-    while (bits > m_restbits)
+    for ( ;; )
     {
-        // if no bytes left in this block, read the next block
-        if (m_restbyte == 0)
-        {
-            m_restbyte = stream.GetC();
-
-            /* Some encoders are a bit broken: instead of issuing
-             * an end-of-image symbol (ab_fin) they come up with
-             * a zero-length subblock!! We catch this here so
-             * that the decoder sees an ab_fin code.
-             */
-            if (m_restbyte == 0)
-            {
-                code = ab_fin;
-                break;
-            }
+        const int len = stream.GetC();
+        if ( len == wxEOF || len == 0 )
+            break;
 
-            // prefetch data
-            stream.Read((void *) m_buffer, m_restbyte);
-            if (stream.LastRead() != m_restbyte)
-            {
-                code = ab_fin;
-                return code;
-            }
-            m_bufp = m_buffer;
-        }
+        // grow the buffer exponentially to avoid reallocating it for every
+        // sub-block, as they're at most 255 bytes long
+        const size_t dataLen = data.GetDataLen();
+        if ( dataLen + len > data.GetBufSize() )
+            data.SetBufSize(2*dataLen + len);
 
-        // read next byte and isolate the bits we need
-        m_lastbyte = (unsigned char) (*m_bufp++);
-        mask       = (1 << (bits - m_restbits)) - 1;
-        code       = code + ((m_lastbyte & mask) << m_restbits);
-        m_restbyte--;
+        stream.Read(data.GetAppendBuf(len), len);
+        data.UngetAppendBuf(stream.LastRead());
 
-        // adjust total number of bits extracted from the buffer
-        m_restbits = m_restbits + 8;
+        if ( stream.LastRead() != (size_t)len )
+            break;
     }
-
-    // find number of bits remaining for next code
-    m_restbits = (m_restbits - bits);
-
-    return code;
 }
 
 
 // dgif:
-//  GIF decoding function. The initial code size (aka root size)
-//  is 'bits'. Supports interlaced images (interl == 1).
+//  GIF decoding function. Decodes the LZW data of the image into its
+//  bitmap, which must be already allocated, and supports interlaced images.
 //  Returns wxGIF_OK (== 0) on success, or an error code if something
-// fails (see header file for details)
-wxGIFErrorCode
-wxGIFDecoder::dgif(wxInputStream& stream, GIFImage *img, int interl, int bits)
+//  fails (see header file for details)
+//
+//  Instead of building the string corresponding to each code by following
+//  the chain of its prefixes, we use the fact that every alphabet entry is
+//  formed by the previously output string followed by the first character of
+//  the next one, i.e. it has already been output contiguously and can be
+//  just copied from the image buffer, so we only remember where it was.
+//
+static wxGIFErrorCode dgif(GIFImage *img)
 {
-    static const int allocSize = 4096 + 1;
+    static const int allocSize = 4096;
 
-    wxScopedArray<int> ab_prefix(allocSize); // alphabet (prefixes)
-    if ( !ab_prefix )
+    wxScopedArray<size_t> ab_start(allocSize);      // alphabet (positions)
+    if ( !ab_start )
         return wxGIF_MEMERR;
 
-    wxScopedArray<int> ab_tail(allocSize);   // alphabet (tails)
-    if ( !ab_tail )
+    wxScopedArray<wxUint16> ab_len(allocSize);      // alphabet (lengths)
+    if ( !ab_len )
         return wxGIF_MEMERR;
 
-    wxScopedArray<int> stack(allocSize);     // decompression stack
-    if ( !stack )
-        return wxGIF_MEMERR;
+    const size_t size = (size_t)img->w * img->h;
+
+    // interlaced images are decoded into a temporary buffer and their rows
+    // are put in the right order at the end
+    wxScopedArray<unsigned char> interlacedBuf;
+    unsigned char *out = img->p;
+    if ( img->interlaced )
+    {
+        interlacedBuf.reset(new unsigned char[size]);
+        out = interlacedBuf.get();
+    }
+
+    const unsigned char *src = (const unsigned char *)img->data.GetData();
+    const unsigned char * const srcEnd = src + img->data.GetDataLen();
+
+    const int bits = img->bits;
 
     int ab_clr;                     // clear code
     int ab_fin;                     // end of info code
     int ab_bits;                    // actual symbol width, in bits
     int ab_free;                    // first free position in alphabet
     int ab_max;                     // last possible character in alphabet
-    int pass;                       // pass number in interlaced images
-    int pos;                        // index into decompresion stack
-    unsigned int x, y;              // position in image buffer
-
-    int code, readcode, lastcode, abcabca;
+    size_t pos;                     // position in the image buffer
+    size_t laststart, lastlen;      // position and length of last string
+    wxUint32 bitbuf;                // bits read from the data ...
+    int nbits;                      // ... and their number
+    wxGIFErrorCode rc = wxGIF_OK;   // the result of decoding
 
     // these won't change
     ab_clr = (1 << bits);
@@ -350,20 +371,28 @@ wxGIFDecoder::dgif(wxInputStream& stream, GIFImage *img, int interl, int bits)
     ab_bits  = bits + 1;
     ab_free  = (1 << bits) + 2;
     ab_max   = (1 << ab_bits) - 1;
-    lastcode = -1;
-    abcabca  = -1;
-    pass     = 1;
-    pos = x = y = 0;
-
-    // reset decoder vars
-    m_restbits = 0;
-    m_restbyte = 0;
-    m_lastbyte = 0;
+    lastlen  = 0;
+    laststart = 0;
+    pos = 0;
+    bitbuf = 0;
+    nbits = 0;
 
-    do
+    while (pos < size)
     {
-        // get next code
-        readcode = code = getcode(stream, ab_bits, ab_fin);
+        // get next code, the end of data is treated as the end of image as
+        // some broken encoders don't emit the end of information code
+        while (nbits < ab_bits && src != srcEnd)
+        {
+            bitbuf |= (wxUint32)*src++ << nbits;
+            nbits += 8;
+        }
+
+        if (nbits < ab_bits)
+            break;
+
+        const int code = bitbuf & ab_max;
+        bitbuf >>= ab_bits;
+        nbits -= ab_bits;
 
         // end of image?
         if (code == ab_fin) break;
@@ -375,58 +404,75 @@ wxGIFDecoder::dgif(wxInputStream& stream, GIFImage *img, int interl, int bits)
             ab_bits  = bits + 1;
             ab_free  = (1 << bits) + 2;
             ab_max   = (1 << ab_bits) - 1;
-            lastcode = -1;
-            abcabca  = -1;
+            lastlen  = 0;
 
             // skip to next code
             continue;
         }
 
-        // unknown code: special case (like in ABCABCA)
-        if (code >= ab_free)
-        {
-            code = lastcode;            // take last string
-            stack[pos++] = abcabca;     // add first character
-        }
+        const size_t start = pos;
+        size_t len;
 
-        // build the string for this code in the stack
-        while (code > ab_clr)
+        if (code < ab_clr)
         {
-            stack[pos++] = ab_tail[code];
-            code         = ab_prefix[code];
-
-            // Don't overflow. This shouldn't happen with normal
-            // GIF files, the allocSize of 4096+1 is enough. This
-            // will only happen with badly formed GIFs.
-            if (pos >= allocSize)
-                return wxGIF_INVFORMAT;
+            // single character
+            out[pos++] = (unsigned char)code;
+            len = 1;
         }
+        else
+        {
+            size_t from;
+            if (code < ab_free)
+            {
+                from = ab_start[code];
+                len  = ab_len[code];
+            }
+            else
+            {
+                // unknown code: special case (like in ABCABCA), this is the
+                // last string followed by its own first character, which
+                // overlaps the output position
+                if (lastlen == 0)
+                    break;      // damaged data, no last string
+
+                from = laststart;
+                len  = lastlen + 1;
+            }
 
-        if (pos >= allocSize)
-            return wxGIF_INVFORMAT;
+            // the last string may be truncated if the image data is invalid
+            const size_t n = len < size - pos ? len : size - pos;
+            if (from + n <= pos)
+            {
+                memcpy(out + pos, out + from, n);
+            }
+            else
+            {
+                for (size_t i = 0; i < n; i++)
+                    out[pos + i] = out[from + i];
+            }
 
-        stack[pos] = code;              // push last code into the stack
-        abcabca    = code;              // save for special case
+            pos += n;
+        }
 
         // make new entry in alphabet (only if NOT just cleared)
-        if (lastcode != -1)
+        if (lastlen != 0)
         {
             // Normally, after the alphabet is full and can't grow any
             // further (ab_free == 4096), encoder should (must?) emit CLEAR
             // to reset it. This checks whether we really got it, otherwise
             // the GIF is damaged.
             if (ab_free > ab_max)
-                return wxGIF_INVFORMAT;
+            {
+                // still zero the rest of the image and reorder its rows
+                // below, as the partially decoded frame may be used
+                rc = wxGIF_INVFORMAT;
+                break;
+            }
 
-            // This assert seems unnecessary since the condition above
-            // eliminates the only case in which it went false. But I really
-            // don't like being forced to ask "Who in .text could have
-            // written there?!" And I wouldn't have been forced to ask if
-            // this line had already been here.
             wxASSERT(ab_free < allocSize);
 
-            ab_prefix[ab_free] = lastcode;
-            ab_tail[ab_free]   = code;
+            ab_start[ab_free] = laststart;
+            ab_len[ab_free]   = (wxUint16)(lastlen + 1);
             ab_free++;
 
             if ((ab_free > ab_max) && (ab_bits < 12))
@@ -436,127 +482,82 @@ wxGIFDecoder::dgif(wxInputStream& stream, GIFImage *img, int interl, int bits)
             }
         }
 
-        // dump stack data to the image buffer
-        while (pos >= 0)
-        {
-            (img->p)[x + (y * (img->w))] = (char) stack[pos];
-            pos--;
+        laststart = start;
+        lastlen = len;
+    }
+
+    // the missing part of a truncated image is left blank
+    memset(out + pos, 0, size - pos);
 
-            if (++x >= (img->w))
+    if (img->interlaced)
+    {
+        // the rows are stored in 4 passes: every 8th row starting from the
+        // first one, then every 8th row starting from the 4th one, every 4th
+        // row starting from the 2nd one and every 2nd row from the 1st one
+        static const unsigned int passStart[] = { 0, 4, 2, 1 };
+        static const unsigned int passStep[] = { 8, 8, 4, 2 };
+
+        const unsigned char *row = out;
+        for (int pass = 0; pass < 4; pass++)
+        {
+            for (unsigned int y = passStart[pass]; y < img->h; y += passStep[pass])
             {
-                x = 0;
+                memcpy(img->p + y * img->w, row, img->w);
+                row += img->w;
+            }
+        }
+    }
 
-                if (interl)
-                {
-                    // support for interlaced images
-                    switch (pass)
-                    {
-                        case 1: y += 8; break;
-                        case 2: y += 8; break;
-                        case 3: y += 4; break;
-                        case 4: y += 2; break;
-                    }
+    return rc;
+}
 
-                    /* loop until a valid y coordinate has been
-                    found, Or if the maximum number of passes has
-                    been reached, exit the loop, and stop image
-                    decoding (At this point the image is successfully
-                    decoded).
-                    If we don't loop, but merely set y to some other
-                    value, that new value might still be invalid depending
-                    on the height of the image. This would cause out of
-                    bounds writing.
-                    */
-                    while (y >= (img->h))
-                    {
-                        switch (++pass)
-                        {
-                            case 2: y = 4; break;
-                            case 3: y = 2; break;
-                            case 4: y = 1; break;
-
-                            default:
-                                /*
-                                It's possible we arrive here. For example this
-                                happens when the image is interlaced, and the
-                                height is 1. Looking at the above cases, the
-                                lowest possible y is 1. While the only valid
-                                one would be 0 for an image of height 1. So
-                                'eventually' the loop will arrive here.
-                                This case makes sure this while loop is
-                                exited, as well as the 2 other ones.
-                                */
-
-                                // Set y to a valid coordinate so the local
-                                // while loop will be exited. (y = 0 always
-                                // is >= img->h since if img->h == 0 the
-                                // image is never decoded)
-                                y = 0;
-
-                                // This will exit the other outer while loop
-                                pos = -1;
-
-                                // This will halt image decoding.
-                                code = ab_fin;
 
-                                break;
-                        }
-                    }
-                }
-                else
+// DecodeFrame:
+//  Decodes the given frame, unless it had been already done, and makes it
+//  the most recently used one, possibly freeing the data of the least
+//  recently used frames to stay within MAX_DECODED_SIZE.
+//
+wxGIFErrorCode wxGIFDecoder::DecodeFrame(unsigned int frame) const
+{
+    GIFImage * const img = GetFrame(frame);
+    if (img->p)
+    {
+        if (m_decodedFrames.back() != frame)
+        {
+            for (size_t n = 0; n < m_decodedFrames.size(); n++)
+            {
+                if (m_decodedFrames[n] == frame)
                 {
-                    // non-interlaced
-                    y++;
-/*
-Normally image decoding is finished when an End of Information code is
-encountered (code == ab_fin) however some broken encoders write wrong
-"block byte counts" (The first byte value after the "code size" byte),
-being one value too high. It might very well be possible other variants
-of this problem occur as well. The only sensible solution seems to
-be to check for clipping.
-Example of wrong encoding:
-(1 * 1 B/W image, raster data stream follows in hex bytes)
-
-02  << B/W images have a code size of 2
-02  << Block byte count
-44  << LZW packed
-00  << Zero byte count (terminates data stream)
-
-Because the block byte count is 2, the zero byte count is used in the
-decoding process, and decoding is continued after this byte. (While it
-should signal an end of image)
-
-It should be:
-02
-02
-44
-01  << When decoded this correctly includes the End of Information code
-00
-
-Or (Worse solution):
-02
-01
-44
-00
-(The 44 doesn't include an End of Information code, but at least the
-decoder correctly skips to 00 now after decoding, and signals this
-as an End of Information itself)
-*/
-                    if (y >= img->h)
-                    {
-                        code = ab_fin;
-                        break;
-                    }
+                    m_decodedFrames.erase(m_decodedFrames.begin() + n);
+                    break;
                 }
             }
+
+            m_decodedFrames.push_back(frame);
         }
 
-        pos = 0;
-        lastcode = readcode;
+        return wxGIF_OK;
     }
-    while (code != ab_fin);
 
-    return wxGIF_OK;
+    const size_t size = (size_t)img->w * img->h;
+
+    while (!m_decodedFrames.empty() && m_decodedSize + size > MAX_DECODED_SIZE)
+    {
+        GIFImage * const lru = GetFrame(m_decodedFrames[0]);
+        m_decodedSize -= (size_t)lru->w * lru->h;
+        free(lru->p);
+        lru->p = NULL;
+        m_decodedFrames.erase(m_decodedFrames.begin());
+    }
+
+    img->p = (unsigned char *) malloc(size ? size : 1);
+    if (!img->p)
+        return wxGIF_MEMERR;
+
+    m_decodedFrames.push_back(frame);
+    m_decodedSize += size;
+
+    return dgif(img);
 }
 
 
@@ -586,9 +587,8 @@ bool wxGIFDecoder::DoCanRead(wxInputStream &stream) const
 wxGIFErrorCode wxGIFDecoder::LoadGIF(wxInputStream& stream)
 {
     unsigned int  global_ncolors = 0;
-    int           bits, interl, i;
+    int           bits, i;
     wxAnimationDisposal disposal;
-    long          size;
     long          delay;
     unsigned char type = 0;
     unsigned char pal[768];
@@ -797,18 +797,17 @@ wxGIFErrorCode wxGIFDecoder::LoadGIF(wxInputStream& stream)
                     }
                 }
 
-                interl = ((buf[8] & 0x40)? 1 : 0);
-                size = pimg->w * pimg->h;
+                pimg->interlaced = (buf[8] & 0x40) != 0;
 
                 pimg->transparent = transparent;
                 pimg->disposal = disposal;
                 pimg->delay = delay;
 
-                // allocate memory for image and palette
-                pimg->p   = (unsigned char *) malloc((unsigned int)size);
+                // allocate memory for palette, the image itself is only
+                // allocated when it's decoded
                 pimg->pal = (unsigned char *) malloc(768);
 
-                if ((!pimg->p) || (!pimg->pal))
+                if (!pimg->pal)
                     return wxGIF_MEMERR;
 
                 // load local color map if available, else use global map
@@ -827,22 +826,34 @@ wxGIFErrorCode wxGIFDecoder::LoadGIF(wxInputStream& stream)
                     pimg->ncolours = global_ncolors;
                 }
 
-                // get initial code size from first byte in raster data
+                // get initial code size from first byte in raster data,
+                // the alphabet must be able to contain all the characters
                 bits = stream.GetC();
-                if (bits == 0)
+                if (bits <= 0 || bits > 11)
                     return wxGIF_INVFORMAT;
 
-                // decode image
-                wxGIFErrorCode result = dgif(stream, pimg.get(), interl, bits);
-                if (result != wxGIF_OK)
-                    return result;
+                pimg->bits = bits;
 
-                guardDestroy.Dismiss();
+                // just store the image data, it's decoded when needed: this
+                // allows to load big animations quickly and without using
+                // too much memory
+                ReadImageData(stream, pimg->data);
 
                 // add the image to our frame array
                 m_frames.Add(pimg.release());
                 m_nFrames++;
 
+                // but decode the first frame immediately, as it's almost
+                // always going to be used, which also checks that it's valid
+                if (m_nFrames == 1)
+                {
+                    wxGIFErrorCode result = DecodeFrame(0);
+                    if (result != wxGIF_OK)
+                        return result;
+                }
+
+                guardDestroy.Dismiss();
+
                 // if this is not an animated GIF, exit after first image
                 if (!anim)
                     done = true;
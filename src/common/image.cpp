@@ -611,6 +611,7 @@ wxImage wxImage::ResampleBox(int width, int height) const
     ResampleBoxPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
 
+    const int src_width = M_IMGDATA->m_width;
     const unsigned char* src_data = M_IMGDATA->m_data;
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
     unsigned char* dst_data = ret_image.GetData();
@@ -622,41 +623,67 @@ wxImage wxImage::ResampleBox(int width, int height) const
         dst_alpha = ret_image.GetAlpha();
     }
 
-    int averaged_pixels, src_pixel_index;
-    double sum_r, sum_g, sum_b, sum_a;
+    // The box filter is separable, so for each destination row we first sum
+    // up the source rows of its vertical box and then average the horizontal
+    // boxes of these sums. Using integer sums is both faster and exact.
+    wxVector<unsigned> sums(src_width * 3);
+    wxVector<unsigned> sums_alpha(src_alpha ? src_width : 0);
 
     for ( int y = 0; y < height; y++ )         // Destination image - Y direction
     {
         // Source pixel in the Y direction
         const BoxPrecalc& vPrecalc = vPrecalcs[y];
 
-        for ( int x = 0; x < width; x++ )      // Destination image - X direction
+        unsigned* const sum = &sums[0];
+        const unsigned char* src = src_data + vPrecalc.boxStart * src_width * 3;
+        for ( int i = 0; i < src_width * 3; i++ )
+            sum[i] = src[i];
+
+        for ( int j = vPrecalc.boxStart + 1; j <= vPrecalc.boxEnd; ++j )
         {
-            // Source pixel in the X direction
-            const BoxPrecalc& hPrecalc = hPrecalcs[x];
+            src += src_width * 3;
+            for ( int i = 0; i < src_width * 3; i++ )
+                sum[i] += src[i];
+        }
 
-            // Box of pixels to average
-            averaged_pixels = 0;
-            sum_r = sum_g = sum_b = sum_a = 0.0;
+        unsigned* const sum_alpha = src_alpha ? &sums_alpha[0] : NULL;
+        if ( src_alpha )
+        {
+            src = src_alpha + vPrecalc.boxStart * src_width;
+            for ( int i = 0; i < src_width; i++ )
+                sum_alpha[i] = src[i];
 
-            for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
+            for ( int j = vPrecalc.boxStart + 1; j <= vPrecalc.boxEnd; ++j )
             {
-                for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
-                {
-                    // Calculate the actual index in our source pixels
-                    src_pixel_index = j * M_IMGDATA->m_width + i;
+                src += src_width;
+                for ( int i = 0; i < src_width; i++ )
+                    sum_alpha[i] += src[i];
+            }
+        }
 
-                    sum_r += src_data[src_pixel_index * 3 + 0];
-                    sum_g += src_data[src_pixel_index * 3 + 1];
-                    sum_b += src_data[src_pixel_index * 3 + 2];
-                    if ( src_alpha )
-                        sum_a += src_alpha[src_pixel_index];
+        const unsigned rows = vPrecalc.boxEnd - vPrecalc.boxStart + 1;
 
-                    averaged_pixels++;
-                }
+        for ( int x = 0; x < width; x++ )      // Destination image - X direction
+        {
+            // Source pixel in the X direction
+            const BoxPrecalc& hPrecalc = hPrecalcs[x];
+
+            // The column sums can't overflow, but their sum over the box can
+            // when shrinking a huge image to a tiny one, so use 64 bits here.
+            wxUint64 sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+            for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
+            {
+                sum_r += sum[i * 3 + 0];
+                sum_g += sum[i * 3 + 1];
+                sum_b += sum[i * 3 + 2];
+                if ( src_alpha )
+                    sum_a += sum_alpha[i];
             }
 
             // Calculate the average from the sum and number of averaged pixels
+            const wxUint64 averaged_pixels =
+                (wxUint64)rows * (hPrecalc.boxEnd - hPrecalc.boxStart + 1);
+
             dst_data[0] = (unsigned char)(sum_r / averaged_pixels);
             dst_data[1] = (unsigned char)(sum_g / averaged_pixels);
             dst_data[2] = (unsigned char)(sum_b / averaged_pixels);
@@ -672,6 +699,59 @@ wxImage wxImage::ResampleBox(int width, int height) const
 namespace
 {
 
+// Bilinear and bicubic filters use a fixed number of source rows for each
+// destination row and are separable, so the source rows are first resampled
+// in the horizontal direction and then combined together. As the
+// rows needed for the consecutive destination rows are consecutive as well,
+// and often the same ones when enlarging the image, this class keeps the last
+// few horizontally resampled rows to avoid recomputing them.
+class ResampledRowsCache
+{
+public:
+    ResampledRowsCache(int count, int width, bool hasAlpha)
+        : m_count(count),
+          m_width(width),
+          m_rows(size_t(count), -1),
+          m_data(count * width * 3),
+          m_alpha(hasAlpha ? count * width : 0)
+    {
+    }
+
+    // Return true if the given row is already cached, otherwise reserve the
+    // slot for it, so that the caller could fill it, and return false.
+    bool Lookup(int row)
+    {
+        int& slot = m_rows[row % m_count];
+        if ( slot == row )
+            return true;
+
+        slot = row;
+        return false;
+    }
+
+    double* GetData(int row)
+    {
+        return &m_data[(row % m_count) * m_width * 3];
+    }
+
+    double* GetAlpha(int row)
+    {
+        return m_alpha.empty() ? NULL : &m_alpha[(row % m_count) * m_width];
+    }
+
+private:
+    const int m_count;
+    const int m_width;
+
+    // Indices of the rows stored in each slot or -1.
+    wxVector<int> m_rows;
+
+    wxVector<double> m_data;
+    wxVector<double> m_alpha;
+
+    wxDECLARE_NO_COPY_CLASS(ResampledRowsCache);
+};
+
 struct BilinearPrecalc
 {
     int offset1;
@@ -710,12 +790,41 @@ void ResampleBilinearPrecalc(wxVector<BilinearPrecalc>& precalcs, int oldDim)
     }
 }
 
+// Resample the given source row in the horizontal direction.
+void ResampleBilinearRow(const wxVector<BilinearPrecalc>& hPrecalcs,
+                         const unsigned char* src_data,
+                         const unsigned char* src_alpha,
+                         double* dst_data,
+                         double* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        // X-axis of pixel to interpolate from
+        const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        const int x_offset1 = hPrecalc.offset1;
+        const int x_offset2 = hPrecalc.offset2;
+        const double dx = hPrecalc.dd;
+        const double dx1 = hPrecalc.dd1;
+
+        dst_data[0] = src_data[x_offset1 * 3 + 0] * dx1 + src_data[x_offset2 * 3 + 0] * dx;
+        dst_data[1] = src_data[x_offset1 * 3 + 1] * dx1 + src_data[x_offset2 * 3 + 1] * dx;
+        dst_data[2] = src_data[x_offset1 * 3 + 2] * dx1 + src_data[x_offset2 * 3 + 2] * dx;
+        dst_data += 3;
+
+        if ( src_alpha )
+            *dst_alpha++ = src_alpha[x_offset1] * dx1 + src_alpha[x_offset2] * dx;
+    }
+}
+
 } // anonymous namespace
 
 wxImage wxImage::ResampleBilinear(int width, int height) const
 {
     // This function implements a Bilinear algorithm for resampling.
     wxImage ret_image(width, height, false);
+    const int src_width = M_IMGDATA->m_width;
     const unsigned char* src_data = M_IMGDATA->m_data;
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
     unsigned char* dst_data = ret_image.GetData();
@@ -732,59 +841,46 @@ wxImage wxImage::ResampleBilinear(int width, int height) const
     ResampleBilinearPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBilinearPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
-    // initialize alpha values to avoid g++ warnings about possibly
-    // uninitialized variables
-    double r1, g1, b1, a1 = 0;
-    double r2, g2, b2, a2 = 0;
+    // Each destination row is interpolated between two consecutive source
+    // rows, so it's enough to keep just the last two of them.
+    ResampledRowsCache rows(2, width, src_alpha != NULL);
 
     for ( int dsty = 0; dsty < height; dsty++ )
     {
         // We need to calculate the source pixel to interpolate from - Y-axis
         const BilinearPrecalc& vPrecalc = vPrecalcs[dsty];
-        const int y_offset1 = vPrecalc.offset1;
-        const int y_offset2 = vPrecalc.offset2;
+        const int y_offsets[] = { vPrecalc.offset1, vPrecalc.offset2 };
         const double dy = vPrecalc.dd;
         const double dy1 = vPrecalc.dd1;
 
-
-        for ( int dstx = 0; dstx < width; dstx++ )
+        for ( int k = 0; k < 2; k++ )
         {
-            // X-axis of pixel to interpolate from
-            const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
-
-            const int x_offset1 = hPrecalc.offset1;
-            const int x_offset2 = hPrecalc.offset2;
-            const double dx = hPrecalc.dd;
-            const double dx1 = hPrecalc.dd1;
-
-            int src_pixel_index00 = y_offset1 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index01 = y_offset1 * M_IMGDATA->m_width + x_offset2;
-            int src_pixel_index10 = y_offset2 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index11 = y_offset2 * M_IMGDATA->m_width + x_offset2;
-
-            // first line
-            r1 = src_data[src_pixel_index00 * 3 + 0] * dx1 + src_data[src_pixel_index01 * 3 + 0] * dx;
-            g1 = src_data[src_pixel_index00 * 3 + 1] * dx1 + src_data[src_pixel_index01 * 3 + 1] * dx;
-            b1 = src_data[src_pixel_index00 * 3 + 2] * dx1 + src_data[src_pixel_index01 * 3 + 2] * dx;
-            if ( src_alpha )
-                a1 = src_alpha[src_pixel_index00] * dx1 + src_alpha[src_pixel_index01] * dx;
-
-            // second line
-            r2 = src_data[src_pixel_index10 * 3 + 0] * dx1 + src_data[src_pixel_index11 * 3 + 0] * dx;
-            g2 = src_data[src_pixel_index10 * 3 + 1] * dx1 + src_data[src_pixel_index11 * 3 + 1] * dx;
-            b2 = src_data[src_pixel_index10 * 3 + 2] * dx1 + src_data[src_pixel_index11 * 3 + 2] * dx;
-            if ( src_alpha )
-                a2 = src_alpha[src_pixel_index10] * dx1 + src_alpha[src_pixel_index11] * dx;
-
-            // result lines
+            const int y_offset = y_offsets[k];
+            if ( !rows.Lookup(y_offset) )
+            {
+                ResampleBilinearRow(hPrecalcs,
+                                    src_data + y_offset * src_width * 3,
+                                    src_alpha ? src_alpha + y_offset * src_width
+                                              : NULL,
+                                    rows.GetData(y_offset),
+                                    rows.GetAlpha(y_offset));
+            }
+        }
 
-            dst_data[0] = static_cast<unsigned char>(r1 * dy1 + r2 * dy + .5);
-            dst_data[1] = static_cast<unsigned char>(g1 * dy1 + g2 * dy + .5);
-            dst_data[2] = static_cast<unsigned char>(b1 * dy1 + b2 * dy + .5);
-            dst_data += 3;
+        // result lines
+        const double* const line1 = rows.GetData(y_offsets[0]);
+        const double* const line2 = rows.GetData(y_offsets[1]);
+        for ( int i = 0; i < width * 3; i++ )
+            dst_data[i] = static_cast<unsigned char>(line1[i] * dy1 + line2[i] * dy + .5);
+        dst_data += width * 3;
 
-            if ( src_alpha )
-                *dst_alpha++ = static_cast<unsigned char>(a1 * dy1 + a2 * dy);
+        if ( src_alpha )
+        {
+            const double* const alpha1 = rows.GetAlpha(y_offsets[0]);
+            const double* const alpha2 = rows.GetAlpha(y_offsets[1]);
+            for ( int i = 0; i < width; i++ )
+                dst_alpha[i] = static_cast<unsigned char>(alpha1[i] * dy1 + alpha2[i] * dy);
+            dst_alpha += width;
         }
     }
 
@@ -840,6 +936,44 @@ void ResampleBicubicPrecalc(wxVector<BicubicPrecalc> &aWeight, int oldDim)
     }
 }
 
+// Resample the given source row in the horizontal direction.
+void ResampleBicubicRow(const wxVector<BicubicPrecalc>& hPrecalcs,
+                        const unsigned char* src_data,
+                        const unsigned char* src_alpha,
+                        double* dst_data,
+                        double* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        // X-axis of pixel to interpolate from
+        const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        // Sums for each color channel
+        double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+
+        for ( int i = 0; i < 4; i++ )
+        {
+            const int x_offset = hPrecalc.offset[i];
+            const double pixel_weight = hPrecalc.weight[i];
+
+            sum_r += src_data[x_offset * 3 + 0] * pixel_weight;
+            sum_g += src_data[x_offset * 3 + 1] * pixel_weight;
+            sum_b += src_data[x_offset * 3 + 2] * pixel_weight;
+            if ( src_alpha )
+                sum_a += src_alpha[x_offset] * pixel_weight;
+        }
+
+        dst_data[0] = sum_r;
+        dst_data[1] = sum_g;
+        dst_data[2] = sum_b;
+        dst_data += 3;
+
+        if ( src_alpha )
+            *dst_alpha++ = sum_a;
+    }
+}
+
 } // anonymous namespace
 
 // This is the bicubic resampling algorithm
@@ -893,66 +1027,113 @@ wxImage wxImage::ResampleBicubic(int width, int height) const
     ResampleBicubicPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBicubicPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
+    // The B-spline kernel is separable, so we first apply it to the source
+    // rows in the horizontal direction and then combine the 4 consecutive
+    // rows used for each destination row.
+    const int src_width = M_IMGDATA->m_width;
+    ResampledRowsCache rows(4, width, src_alpha != NULL);
+
     for ( int dsty = 0; dsty < height; dsty++ )
     {
         // We need to calculate the source pixel to interpolate from - Y-axis
         const BicubicPrecalc& vPrecalc = vPrecalcs[dsty];
 
-        for ( int dstx = 0; dstx < width; dstx++ )
+        const double* lines[4];
+        const double* alphas[4];
+        for ( int k = 0; k < 4; k++ )
         {
-            // X-axis of pixel to interpolate from
-            const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+            const int y_offset = vPrecalc.offset[k];
+            if ( !rows.Lookup(y_offset) )
+            {
+                ResampleBicubicRow(hPrecalcs,
+                                   src_data + y_offset * src_width * 3,
+                                   src_alpha ? src_alpha + y_offset * src_width
+                                             : NULL,
+                                   rows.GetData(y_offset),
+                                   rows.GetAlpha(y_offset));
+            }
 
-            // Sums for each color channel
-            double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+            lines[k] = rows.GetData(y_offset);
+            alphas[k] = rows.GetAlpha(y_offset);
+        }
 
-            // Here we actually determine the RGBA values for the destination pixel
-            for ( int k = -1; k <= 2; k++ )
-            {
-                // Y offset
-                const int y_offset = vPrecalc.offset[k + 1];
+        const double* const weight = vPrecalc.weight;
 
-                // Loop across the X axis
-                for ( int i = -1; i <= 2; i++ )
-                {
-                    // X offset
-                    const int x_offset = hPrecalc.offset[i + 1];
-
-                    // Calculate the exact position where the source data
-                    // should be pulled from based on the x_offset and y_offset
-                    int src_pixel_index = y_offset*M_IMGDATA->m_width + x_offset;
-
-                    // Calculate the weight for the specified pixel according
-                    // to the bicubic b-spline kernel we're using for
-                    // interpolation
-                    const double
-                        pixel_weight = vPrecalc.weight[k + 1] * hPrecalc.weight[i + 1];
-
-                    // Create a sum of all velues for each color channel
-                    // adjusted for the pixel's calculated weight
-                    sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight;
-                    sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight;
-                    sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight;
-                    if ( src_alpha )
-                        sum_a += src_alpha[src_pixel_index] * pixel_weight;
-                }
-            }
+        // Put the data into the destination image.  The summed values are
+        // of double data type and are rounded here for accuracy
+        for ( int i = 0; i < width * 3; i++ )
+        {
+            const double sum = lines[0][i] * weight[0] +
+                               lines[1][i] * weight[1] +
+                               lines[2][i] * weight[2] +
+                               lines[3][i] * weight[3];
 
-            // Put the data into the destination image.  The summed values are
-            // of double data type and are rounded here for accuracy
-            dst_data[0] = (unsigned char)(sum_r + 0.5);
-            dst_data[1] = (unsigned char)(sum_g + 0.5);
-            dst_data[2] = (unsigned char)(sum_b + 0.5);
-            dst_data += 3;
+            dst_data[i] = (unsigned char)(sum + 0.5);
+        }
+        dst_data += width * 3;
 
-            if ( src_alpha )
-                *dst_alpha++ = (unsigned char)sum_a;
+        if ( src_alpha )
+        {
+            for ( int i = 0; i < width; i++ )
+            {
+                const double sum_a = alphas[0][i] * weight[0] +
+                                     alphas[1][i] * weight[1] +
+                                     alphas[2][i] * weight[2] +
+                                     alphas[3][i] * weight[3];
+
+                dst_alpha[i] = (unsigned char)sum_a;
+            }
+            dst_alpha += width;
         }
     }
 
     return ret_image;
 }
 
+namespace
+{
+
+// Computes the average of blurArea pixel values from their sum. As division
+// is relatively slow, multiply by the fixed point inverse of the area instead
+// when this gives exactly the same result, i.e. if the sums are small enough,
+// which is the case for all blur radius values except for the huge ones.
+class BlurAverage
+{
+public:
+    explicit BlurAverage(int blurArea)
+        : m_area(blurArea),
+          m_inverse(blurArea < 4096
+                        ? ((wxUint64(1) << 32) + blurArea - 1) / blurArea
+                        : 0)
+    {
+    }
+
+    unsigned char operator()(long sum) const
+    {
+        return HasInverse() ? MultiplyByInverse(sum) : Divide(sum);
+    }
+
+    // These functions are used directly in the loops where checking which
+    // of them to use for every value would prevent optimizing the loop.
+    bool HasInverse() const { return m_inverse != 0; }
+
+    unsigned char MultiplyByInverse(long sum) const
+    {
+        return (unsigned char)((wxUint64(sum) * m_inverse) >> 32);
+    }
+
+    unsigned char Divide(long sum) const
+    {
+        return (unsigned char)(sum / m_area);
+    }
+
+private:
+    const long m_area;
+    const wxUint64 m_inverse;
+};
+
+} // anonymous namespace
+
 // Blur in the horizontal direction
 wxImage wxImage::BlurHorizontal(int blurRadius) const
 {
@@ -967,6 +1148,7 @@ wxImage wxImage::BlurHorizontal(int blurRadius) const
 
     // number of pixels we average over
     const int blurArea = blurRadius*2 + 1;
+    const BlurAverage average(blurArea);
 
     // Horizontal blurring algorithm - average all pixels in the specified blur
     // radius in the X or horizontal direction
@@ -991,6 +1173,8 @@ wxImage wxImage::BlurHorizontal(int blurRadius) const
             // image's data or grabbing from the previous row
             if ( kernel_x < 0 )
                 pixel_idx = y * M_IMGDATA->m_width;
+            else if ( kernel_x > M_IMGDATA->m_width - 1 )
+                pixel_idx = M_IMGDATA->m_width - 1 + y * M_IMGDATA->m_width;
             else
                 pixel_idx = kernel_x + y * M_IMGDATA->m_width;
 
@@ -1003,11 +1187,11 @@ wxImage wxImage::BlurHorizontal(int blurRadius) const
         }
 
         dst = dst_data + y * M_IMGDATA->m_width*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
+        dst[0] = average(sum_r);
+        dst[1] = average(sum_g);
+        dst[2] = average(sum_b);
         if ( src_alpha )
-            dst_alpha[y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+            dst_alpha[y * M_IMGDATA->m_width] = average(sum_a);
 
         // Now average the values of the rest of the pixels by just moving the
         // blur radius box along the row
@@ -1045,17 +1229,50 @@ wxImage wxImage::BlurHorizontal(int blurRadius) const
 
             // Save off the averaged data
             dst = dst_data + x*3 + y*M_IMGDATA->m_width*3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
+            dst[0] = average(sum_r);
+            dst[1] = average(sum_g);
+            dst[2] = average(sum_b);
             if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+                dst_alpha[x + y * M_IMGDATA->m_width] = average(sum_a);
         }
     }
 
     return ret_image;
 }
 
+namespace
+{
+
+// Update the running sums of the blur box for the next row by adding the
+// values of the row entering the box and subtracting the ones of the row
+// leaving it and store the averages in the destination row.
+void BlurVerticalRow(long* sums,
+                     const unsigned char* srcAdd,
+                     const unsigned char* srcRemove,
+                     unsigned char* dst,
+                     int count,
+                     BlurAverage average)
+{
+    if ( average.HasInverse() )
+    {
+        for ( int i = 0; i < count; i++ )
+        {
+            sums[i] += srcAdd[i] - srcRemove[i];
+            dst[i] = average.MultiplyByInverse(sums[i]);
+        }
+    }
+    else
+    {
+        for ( int i = 0; i < count; i++ )
+        {
+            sums[i] += srcAdd[i] - srcRemove[i];
+            dst[i] = average.Divide(sums[i]);
+        }
+    }
+}
+
+} // anonymous namespace
+
 // Blur in the vertical direction
 wxImage wxImage::BlurVertical(int blurRadius) const
 {
@@ -1063,6 +1280,8 @@ wxImage wxImage::BlurVertical(int blurRadius) const
 
     wxCHECK( ret_image.IsOk(), ret_image );
 
+    const int width = M_IMGDATA->m_width;
+    const int height = M_IMGDATA->m_height;
     const unsigned char* src_data = M_IMGDATA->m_data;
     unsigned char* dst_data = ret_image.GetData();
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
@@ -1070,89 +1289,66 @@ wxImage wxImage::BlurVertical(int blurRadius) const
 
     // number of pixels we average over
     const int blurArea = blurRadius*2 + 1;
+    const BlurAverage average(blurArea);
 
     // Vertical blurring algorithm - same as horizontal but switched the
-    // opposite direction
-    for ( int x = 0; x < M_IMGDATA->m_width; x++ )
+    // opposite direction. Instead of going down each column, which is very
+    // cache-unfriendly for big images, we keep the sums for all columns and
+    // move the blur radius box for all of them at once, row by row.
+    wxVector<long> sums(width * 3);
+    wxVector<long> sums_alpha(src_alpha ? width : 0);
+
+    // Calculate the sums of all pixels in the blur radius box for the first
+    // row, duplicating the edge pixels for the rows beyond the image edges
+    for ( int kernel_y = -blurRadius; kernel_y <= blurRadius; kernel_y++ )
     {
-        // Variables used in the blurring algorithm
-        long sum_r = 0,
-             sum_g = 0,
-             sum_b = 0,
-             sum_a = 0;
+        const int y = wxMin(wxMax(kernel_y, 0), height - 1);
 
-        long pixel_idx;
-        const unsigned char *src;
-        unsigned char *dst;
+        const unsigned char* src = src_data + y * width * 3;
+        for ( int i = 0; i < width * 3; i++ )
+            sums[i] += src[i];
 
-        // Calculate the average of all pixels in our blur radius box for the
-        // first pixel of the column
-        for ( int kernel_y = -blurRadius; kernel_y <= blurRadius; kernel_y++ )
+        if ( src_alpha )
         {
-            // To deal with the pixels at the start of a column so it's not
-            // grabbing GOK values from memory at negative indices of the
-            // image's data or grabbing from the previous column
-            if ( kernel_y < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + kernel_y * M_IMGDATA->m_width;
-
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+            src = src_alpha + y * width;
+            for ( int i = 0; i < width; i++ )
+                sums_alpha[i] += src[i];
         }
+    }
 
-        dst = dst_data + x*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
-        if ( src_alpha )
-            dst_alpha[x] = (unsigned char)(sum_a / blurArea);
+    for ( int i = 0; i < width * 3; i++ )
+        dst_data[i] = average(sums[i]);
 
-        // Now average the values of the rest of the pixels by just moving the
-        // box along the column from top to bottom
-        for ( int y = 1; y < M_IMGDATA->m_height; y++ )
-        {
-            // Take care of pixels that would be beyond the top edge by
-            // duplicating the top edge pixel for the column
-            if ( y - blurRadius - 1 < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + (y - blurRadius - 1) * M_IMGDATA->m_width;
-
-            // Subtract the value of the pixel at the top of our blur radius box
-            src = src_data + pixel_idx*3;
-            sum_r -= src[0];
-            sum_g -= src[1];
-            sum_b -= src[2];
-            if ( src_alpha )
-                sum_a -= src_alpha[pixel_idx];
+    if ( src_alpha )
+    {
+        for ( int i = 0; i < width; i++ )
+            dst_alpha[i] = average(sums_alpha[i]);
+    }
 
-            // Take care of the pixels that would be beyond the bottom edge of
-            // the image similar to the top edge
-            if ( y + blurRadius > M_IMGDATA->m_height - 1 )
-                pixel_idx = x + (M_IMGDATA->m_height - 1) * M_IMGDATA->m_width;
-            else
-                pixel_idx = x + (blurRadius + y) * M_IMGDATA->m_width;
+    // Now average the values of the rest of the rows by just moving the box
+    // from top to bottom
+    for ( int y = 1; y < height; y++ )
+    {
+        // The row leaving the box at the top and the one entering it at the
+        // bottom, again duplicating the edge rows
+        const int yRemove = wxMax(y - blurRadius - 1, 0);
+        const int yAdd = wxMin(y + blurRadius, height - 1);
 
-            // Add the value of the pixel being added to the end of our box
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+        BlurVerticalRow(&sums[0],
+                        src_data + yAdd * width * 3,
+                        src_data + yRemove * width * 3,
+                        dst_data + y * width * 3,
+                        width * 3,
+                        average);
 
-            // Save off the averaged data
-            dst = dst_data + (x + y * M_IMGDATA->m_width) * 3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
-            if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+        if ( src_alpha )
+        {
+            BlurVerticalRow(&sums_alpha[0],
+                            src_alpha + yAdd * width,
+                            src_alpha + yRemove * width,
+                            dst_alpha + y * width,
+                            width,
+                            average);
         }
     }
 
@@ -1162,11 +1358,8 @@ wxImage wxImage::BlurVertical(int blurRadius) const
 // The new blur function
 wxImage wxImage::Blur(int blurRadius) const
 {
-    wxImage ret_image;
-    ret_image.Create(M_IMGDATA->m_width, M_IMGDATA->m_height, false);
-
     // Blur the image in each direction
-    ret_image = BlurHorizontal(blurRadius);
+    wxImage ret_image = BlurHorizontal(blurRadius);
     ret_image = ret_image.BlurVertical(blurRadius);
 
     return ret_image;
@@ -27,6 +27,7 @@
 #include "wx/stream.h"
 #include "wx/anidecod.h" // wxImageArray
 #include "wx/scopedarray.h"
+#include "wx/scopedptr.h"
 
 #define GIF89_HDR     "GIF89a"
 #define NETSCAPE_LOOP "NETSCAPE2.0"
@@ -69,16 +70,65 @@ struct GifHashTableType
     wxUint32 HTable[HT_SIZE];
 };
 
+#if wxUSE_STREAMS
+
+// The LZW encoder used for saving a single image: all its state is kept in
+// this object, created by wxGIFHandler::DoSaveFile(), and not in the handler
+// itself, so that the same handler can be used by several threads at once.
+class wxGIFEncoder
+{
+public:
+    explicit wxGIFEncoder(wxOutputStream *stream)
+        : m_stream(stream)
+    {
+        m_pixelCount = 0;
+    }
+
+    bool SetupCompress(int bpp);
+
+    // set the number of pixels remaining after the next line, the output is
+    // finished when compressing the line after which there are none left
+    void SetPixelCount(int pixelCount) { m_pixelCount = pixelCount; }
+
+    bool CompressLine(const wxUint8 *line, int lineLen);
+
+private:
+    bool CompressOutput(int code);
+
+    void ClearHashTable();
+    void InsertHashTable(unsigned long key, int code);
+    int  ExistsHashTable(unsigned long key);
+
+    wxOutputStream * const m_stream;
+
+    unsigned long m_crntShiftDWord;   /* For bytes decomposition into codes. */
+    int m_pixelCount;
+    GifHashTableType m_hashTable;
+    wxInt16
+      m_EOFCode,     /* The EOF LZ code. */
+      m_clearCode,   /* The CLEAR LZ code. */
+      m_runningCode, /* The next code algorithm can generate. */
+      m_runningBits, /* The number of bits required to represent RunningCode. */
+      m_maxCode1,    /* 1 bigger than max. possible code, in RunningBits bits. */
+      m_crntCode,    /* Current algorithm code. */
+      m_crntShiftState;    /* Number of bits in CrntShiftDWord. */
+    wxUint8 m_LZBuf[256];   /* Compressed input is buffered here. */
+
+    wxDECLARE_NO_COPY_CLASS(wxGIFEncoder);
+};
+
+#endif // wxUSE_STREAMS
+
 wxIMPLEMENT_DYNAMIC_CLASS(wxGIFHandler,wxImageHandler);
 
 //----------------------------------------------------------------------------
 // Forward declarations
 //----------------------------------------------------------------------------
 
-static int wxGIFHandler_KeyItem(unsigned long item);
-
 #if wxUSE_STREAMS
 
+static int wxGIFHandler_KeyItem(unsigned long item);
+
 static int wxGIFHandler_BitSize(int n);
 
 #if wxUSE_PALETTE
@@ -239,21 +289,20 @@ bool wxGIFHandler::DoSaveFile(const wxImage& image, wxOutputStream *stream,
         return false;
     }
 
-    if (!InitHashTable())
-    {
-        wxLogError(_("Couldn't initialize GIF hash table."));
-        return false;
-    }
+    // the encoder contains the hash table, so don't allocate it on the stack
+    wxScopedPtr<wxGIFEncoder> encoder(new wxGIFEncoder(stream));
 
     const wxUint8 *src = image.GetData();
     wxScopedArray<wxUint8> eightBitData(width);
 
-    SetupCompress(stream, 8);
+    if (!encoder->SetupCompress(8))
+    {
+        return false;
+    }
 
-    m_pixelCount = height * width_even;
     for (int y = 0; y < height; y++)
     {
-        m_pixelCount -= width_even;
+        encoder->SetPixelCount((height - y - 1) * width_even);
         for (int x = 0; x < width; x++)
         {
             wxRGB rgb;
@@ -266,15 +315,13 @@ bool wxGIFHandler::DoSaveFile(const wxImage& image, wxOutputStream *stream,
             src+=3;
         }
 
-        ok = CompressLine(stream, eightBitData.get(), width);
+        ok = encoder->CompressLine(eightBitData.get(), width);
         if (!ok)
         {
             break;
         }
     }
 
-    wxDELETE(m_hashTable);
-
     return ok;
 }
 
@@ -325,14 +372,14 @@ bool wxGIFHandler::SaveAnimation(const wxImageArray& images,
 #endif
 }
 
-bool wxGIFHandler::CompressOutput(wxOutputStream *stream, int code)
+bool wxGIFEncoder::CompressOutput(int code)
 {
     if (code == FLUSH_OUTPUT)
     {
         while (m_crntShiftState > 0)
         {
             // Get rid of what is left in DWord, and flush it.
-            if (!wxGIFHandler_BufferedOutput(stream, m_LZBuf,
+            if (!wxGIFHandler_BufferedOutput(m_stream, m_LZBuf,
                 m_crntShiftDWord & 0xff))
             {
                 return false;
@@ -341,7 +388,7 @@ bool wxGIFHandler::CompressOutput(wxOutputStream *stream, int code)
             m_crntShiftState -= 8;
         }
         m_crntShiftState = 0;                       // For next time.
-        if (!wxGIFHandler_BufferedOutput(stream, m_LZBuf, FLUSH_OUTPUT))
+        if (!wxGIFHandler_BufferedOutput(m_stream, m_LZBuf, FLUSH_OUTPUT))
         {
             return false;
         }
@@ -353,7 +400,7 @@ bool wxGIFHandler::CompressOutput(wxOutputStream *stream, int code)
         while (m_crntShiftState >= 8)
         {
             // Dump out full bytes:
-            if (!wxGIFHandler_BufferedOutput(stream, m_LZBuf,
+            if (!wxGIFHandler_BufferedOutput(m_stream, m_LZBuf,
                 m_crntShiftDWord & 0xff))
             {
                 return false;
@@ -372,7 +419,7 @@ bool wxGIFHandler::CompressOutput(wxOutputStream *stream, int code)
     return true;
 }
 
-bool wxGIFHandler::SetupCompress(wxOutputStream *stream, int bpp)
+bool wxGIFEncoder::SetupCompress(int bpp)
 {
     m_LZBuf[0] = 0;           // Nothing was output yet.
     m_clearCode = (1 << bpp);
@@ -387,12 +434,11 @@ bool wxGIFHandler::SetupCompress(wxOutputStream *stream, int bpp)
     // Clear hash table and send Clear to make sure the decoder does the same.
     ClearHashTable();
 
-    return wxGIFHandler_WriteByte(stream, (wxUint8)bpp)
-        && CompressOutput(stream, m_clearCode);
+    return wxGIFHandler_WriteByte(m_stream, (wxUint8)bpp)
+        && CompressOutput(m_clearCode);
 }
 
-bool wxGIFHandler::CompressLine(wxOutputStream *stream,
-    const wxUint8 *line, int lineLen)
+bool wxGIFEncoder::CompressLine(const wxUint8 *line, int lineLen)
 {
     int i = 0, crntCode, newCode;
     unsigned long newKey;
@@ -419,7 +465,7 @@ bool wxGIFHandler::CompressLine(wxOutputStream *stream,
         {
             // Put it in hash table, output the prefix code, and make our
             // crntCode equal to Pixel.
-            if (!CompressOutput(stream, crntCode))
+            if (!CompressOutput(crntCode))
             {
                 return false;
             }
@@ -431,7 +477,7 @@ bool wxGIFHandler::CompressLine(wxOutputStream *stream,
             if (m_runningCode >= LZ_MAX_CODE)
             {
                 // Time to do some clearance:
-                if (!CompressOutput(stream, m_clearCode))
+                if (!CompressOutput(m_clearCode))
                 {
                     return false;
                 }
@@ -453,9 +499,9 @@ bool wxGIFHandler::CompressLine(wxOutputStream *stream,
     if (m_pixelCount == 0)
     {
         // We are done - output last Code and flush output buffers:
-        if (!CompressOutput(stream, crntCode)
-            || !CompressOutput(stream, m_EOFCode)
-            || !CompressOutput(stream, FLUSH_OUTPUT))
+        if (!CompressOutput(crntCode)
+            || !CompressOutput(m_EOFCode)
+            || !CompressOutput(FLUSH_OUTPUT))
         {
             return false;
         }
@@ -464,29 +510,10 @@ bool wxGIFHandler::CompressLine(wxOutputStream *stream,
     return true;
 }
 
-#endif  // wxUSE_STREAMS
-
-bool wxGIFHandler::InitHashTable()
-{
-    if (!m_hashTable)
-    {
-        m_hashTable = new GifHashTableType();
-    }
-
-    if (!m_hashTable)
-    {
-        return false;
-    }
-
-    ClearHashTable();
-
-    return true;
-}
-
-void wxGIFHandler::ClearHashTable()
+void wxGIFEncoder::ClearHashTable()
 {
     int index = HT_SIZE;
-    wxUint32 *HTable = m_hashTable->HTable;
+    wxUint32 *HTable = m_hashTable.HTable;
 
     while (--index>=0)
     {
@@ -494,10 +521,10 @@ void wxGIFHandler::ClearHashTable()
     }
 }
 
-void wxGIFHandler::InsertHashTable(unsigned long key, int code)
+void wxGIFEncoder::InsertHashTable(unsigned long key, int code)
 {
     int hKey = wxGIFHandler_KeyItem(key);
-    wxUint32 *HTable = m_hashTable->HTable;
+    wxUint32 *HTable = m_hashTable.HTable;
 
     while (HT_GET_KEY(HTable[hKey]) != 0xFFFFFL)
     {
@@ -507,10 +534,10 @@ void wxGIFHandler::InsertHashTable(unsigned long key, int code)
 }
 
 
-int wxGIFHandler::ExistsHashTable(unsigned long key)
+int wxGIFEncoder::ExistsHashTable(unsigned long key)
 {
     int hKey = wxGIFHandler_KeyItem(key);
-    wxUint32 *HTable = m_hashTable->HTable, HTKey;
+    wxUint32 *HTable = m_hashTable.HTable, HTKey;
 
     while ((HTKey = HT_GET_KEY(HTable[hKey])) != 0xFFFFFL)
     {
@@ -523,17 +550,19 @@ int wxGIFHandler::ExistsHashTable(unsigned long key)
     return -1;
 }
 
+#endif  // wxUSE_STREAMS
+
 // ---------------------------------------------------------------------------
 // implementation of global private functions
 // ---------------------------------------------------------------------------
 
+#if wxUSE_STREAMS
+
 int wxGIFHandler_KeyItem(unsigned long item)
 {
     return ((item >> 12) ^ item) & HT_KEY_MASK;
 }
 
-#if wxUSE_STREAMS
-
 int wxGIFHandler_BitSize(int n)
 {
     int i;
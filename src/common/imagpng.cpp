@@ -177,67 +177,55 @@ bool wxPNGHandler::DoCanRead( wxInputStream& stream )
     return memcmp(hdr, "\211PNG", WXSIZEOF(hdr)) == 0;
 }
 
-// convert data from RGB to wxImage format
+// convert a row of RGBA data to wxImage format, allocating the alpha channel
+// on demand, i.e. only if we have any non-opaque pixels
 static
-void CopyDataFromPNG(wxImage *image,
-                     unsigned char **lines,
-                     png_uint_32 width,
-                     png_uint_32 height,
-                     int color_type)
+void CopyRowFromPNG(wxImage *image,
+                    const unsigned char *ptrSrc,
+                    png_uint_32 width,
+                    png_uint_32 y,
+                    unsigned char *&alpha)
 {
-    // allocated on demand if we have any non-opaque pixels
-    unsigned char *alpha = NULL;
-
-    unsigned char *ptrDst = image->GetData();
-    if ( !(color_type & PNG_COLOR_MASK_COLOR) )
+    unsigned char *ptrDst = image->GetData() + y * width * 3;
+    for ( png_uint_32 x = 0; x < width; x++ )
     {
-        // grey image: GAGAGA... where G == grey component and A == alpha
-        for ( png_uint_32 y = 0; y < height; y++ )
-        {
-            const unsigned char *ptrSrc = lines[y];
-            for ( png_uint_32 x = 0; x < width; x++ )
-            {
-                unsigned char g = *ptrSrc++;
-                unsigned char a = *ptrSrc++;
-
-                // the first time we encounter a transparent pixel we must
-                // allocate alpha channel for the image
-                if ( !IsOpaque(a) && !alpha )
-                    alpha = InitAlpha(image, x, y);
-
-                if ( alpha )
-                    *alpha++ = a;
-
-                *ptrDst++ = g;
-                *ptrDst++ = g;
-                *ptrDst++ = g;
-            }
-        }
+        unsigned char r = *ptrSrc++;
+        unsigned char g = *ptrSrc++;
+        unsigned char b = *ptrSrc++;
+        unsigned char a = *ptrSrc++;
+
+        // the first time we encounter a transparent pixel we must allocate
+        // alpha channel for the image
+        if ( !IsOpaque(a) && !alpha )
+            alpha = InitAlpha(image, x, y);
+
+        if ( alpha )
+            *alpha++ = a;
+
+        *ptrDst++ = r;
+        *ptrDst++ = g;
+        *ptrDst++ = b;
     }
-    else // colour image: RGBRGB...
+}
+
+// add the values of all pixels of the source row to the sums for the pixels
+// of the row scaled down by the given factor
+static
+void AddRowToSums(unsigned *sums,
+                  const unsigned char *ptrSrc,
+                  png_uint_32 widthScaled,
+                  png_uint_32 scale,
+                  int bytesPerPixel)
+{
+    for ( png_uint_32 x = 0; x < widthScaled; x++ )
     {
-        for ( png_uint_32 y = 0; y < height; y++ )
+        for ( png_uint_32 n = 0; n < scale; n++ )
         {
-            const unsigned char *ptrSrc = lines[y];
-            for ( png_uint_32 x = 0; x < width; x++ )
-            {
-                unsigned char r = *ptrSrc++;
-                unsigned char g = *ptrSrc++;
-                unsigned char b = *ptrSrc++;
-                unsigned char a = *ptrSrc++;
-
-                // the logic here is the same as for the grey case
-                if ( !IsOpaque(a) && !alpha )
-                    alpha = InitAlpha(image, x, y);
-
-                if ( alpha )
-                    *alpha++ = a;
-
-                *ptrDst++ = r;
-                *ptrDst++ = g;
-                *ptrDst++ = b;
-            }
+            for ( int c = 0; c < bytesPerPixel; c++ )
+                sums[c] += *ptrSrc++;
         }
+
+        sums += bytesPerPixel;
     }
 }
 
@@ -257,15 +245,24 @@ wxPNGHandler::LoadFile(wxImage *image,
     //     method is to use goto (setjmp is not really C++ dtors friendly...)
 
     unsigned char **lines = NULL;
+    unsigned char *rows = NULL;
+    unsigned *sums = NULL;
     png_infop info_ptr = (png_infop) NULL;
     wxPNGInfoStruct wxinfo;
 
     png_uint_32 i, width, height = 0;
-    int bit_depth, color_type, interlace_type;
+    png_uint_32 scale = 1, widthScaled, heightScaled;
+    int bit_depth, color_type, interlace_type, bytesPerPixel;
+    bool hasAlpha;
+    unsigned char *alpha = NULL;
 
     wxinfo.verbose = verbose;
     wxinfo.stream.in = &stream;
 
+    // save this before calling Destroy()
+    const unsigned maxWidth = image->GetOptionInt(wxIMAGE_OPTION_MAX_WIDTH),
+                   maxHeight = image->GetOptionInt(wxIMAGE_OPTION_MAX_HEIGHT);
+
     image->Destroy();
 
     png_structp png_ptr = png_create_read_struct
@@ -303,30 +300,136 @@ wxPNGHandler::LoadFile(wxImage *image,
     png_set_packing( png_ptr );
     if (png_get_valid( png_ptr, info_ptr, PNG_INFO_tRNS))
         png_set_expand( png_ptr );
-    png_set_filler( png_ptr, 0xff, PNG_FILLER_AFTER );
 
-    image->Create((int)width, (int)height, (bool) false /* no need to init pixels */);
+    // we always want to get either RGB or RGBA data from libpng, the former
+    // can be stored directly in wxImage, while the latter is split into the
+    // RGB and alpha planes row by row
+    if ( !(color_type & PNG_COLOR_MASK_COLOR) )
+        png_set_gray_to_rgb( png_ptr );
 
-    if (!image->IsOk())
+    hasAlpha = (color_type & PNG_COLOR_MASK_ALPHA) ||
+                    png_get_valid( png_ptr, info_ptr, PNG_INFO_tRNS );
+
+    png_set_interlace_handling( png_ptr );
+    png_read_update_info( png_ptr, info_ptr );
+
+    bytesPerPixel = hasAlpha ? 4 : 3;
+    if ( png_get_rowbytes( png_ptr, info_ptr ) != width * bytesPerPixel )
         goto error;
 
-    // initialize all line pointers to NULL to ensure that they can be safely
-    // free()d if an error occurs before all of them could be allocated
-    lines = (unsigned char **)calloc(height, sizeof(unsigned char *));
-    if ( !lines )
+    // scale the picture down to fit in the specified max size if necessary
+    // by averaging the blocks of scale*scale pixels while reading it, this is
+    // only done for non-interlaced images as for the interlaced ones we need
+    // to decode the entire image anyhow (the limit on the scale ensures that
+    // the sums of the pixel values in a block don't overflow)
+    if ( (maxWidth || maxHeight) && interlace_type == PNG_INTERLACE_NONE )
+    {
+        while ( ((maxWidth && width / scale > maxWidth) ||
+                    (maxHeight && height / scale > maxHeight)) &&
+                        width / (scale * 2) && height / (scale * 2) &&
+                            scale < 4096 )
+        {
+            scale *= 2;
+        }
+    }
+
+    widthScaled = width / scale;
+    heightScaled = height / scale;
+
+    image->Create((int)widthScaled, (int)heightScaled, (bool) false /* no need to init pixels */);
+
+    if (!image->IsOk())
         goto error;
 
-    for (i = 0; i < height; i++)
+    if ( scale > 1 )
+    {
+        rows = (unsigned char *)malloc((size_t)(width * bytesPerPixel));
+        sums = (unsigned *)calloc(widthScaled * bytesPerPixel, sizeof(unsigned));
+        if ( !rows || !sums )
+            goto error;
+
+        for (i = 0; i < height; i++)
+        {
+            png_read_row( png_ptr, rows, NULL );
+
+            // the last rows not forming a complete block are just skipped
+            if ( i / scale == heightScaled )
+                continue;
+
+            AddRowToSums(sums, rows, widthScaled, scale, bytesPerPixel);
+
+            if ( (i + 1) % scale )
+                continue;
+
+            // we have the entire block, compute the averages reusing the row
+            // buffer for them as it's big enough
+            for ( png_uint_32 n = 0; n < widthScaled * bytesPerPixel; n++ )
+            {
+                rows[n] = (unsigned char)(sums[n] / (scale * scale));
+                sums[n] = 0;
+            }
+
+            if ( hasAlpha )
+            {
+                CopyRowFromPNG(image, rows, widthScaled, i / scale, alpha);
+            }
+            else
+            {
+                memcpy(image->GetData() + (i / scale) * widthScaled * 3,
+                       rows, widthScaled * 3);
+            }
+        }
+    }
+    else if ( !hasAlpha )
     {
-        if ((lines[i] = (unsigned char *)malloc( (size_t)(width * 4))) == NULL)
+        // decode directly into the image, this works for interlaced images
+        // too as all their passes are just combined in the same rows
+        lines = (unsigned char **)malloc(height * sizeof(unsigned char *));
+        if ( !lines )
             goto error;
+
+        for (i = 0; i < height; i++)
+            lines[i] = image->GetData() + i * width * 3;
+
+        png_read_image( png_ptr, lines );
+    }
+    else if ( interlace_type == PNG_INTERLACE_NONE )
+    {
+        // we only need a single RGBA row which is reused for all of them
+        rows = (unsigned char *)malloc((size_t)(width * 4));
+        if ( !rows )
+            goto error;
+
+        for (i = 0; i < height; i++)
+        {
+            png_read_row( png_ptr, rows, NULL );
+            CopyRowFromPNG(image, rows, width, i, alpha);
+        }
+    }
+    else // interlaced image with alpha
+    {
+        // all rows are needed until the last pass is done, allocate them as
+        // a single block
+        rows = (unsigned char *)malloc((size_t)width * height * 4);
+        lines = (unsigned char **)malloc(height * sizeof(unsigned char *));
+        if ( !rows || !lines )
+            goto error;
+
+        for (i = 0; i < height; i++)
+            lines[i] = rows + (size_t)i * width * 4;
+
+        png_read_image( png_ptr, lines );
+
+        for (i = 0; i < height; i++)
+            CopyRowFromPNG(image, lines[i], width, i, alpha);
     }
 
-    png_read_image( png_ptr, lines );
     png_read_end( png_ptr, info_ptr );
 
 #if wxUSE_PALETTE
-    if (color_type == PNG_COLOR_TYPE_PALETTE)
+    // when scaling, the pixels are averages of the palette colours and not
+    // colours from the palette any more, so don't pretend they are
+    if (color_type == PNG_COLOR_TYPE_PALETTE && scale == 1)
     {
         png_colorp palette = NULL;
         int numPalette = 0;
@@ -392,14 +495,18 @@ wxPNGHandler::LoadFile(wxImage *image,
     }
 
 
-    png_destroy_read_struct( &png_ptr, &info_ptr, (png_infopp) NULL );
+    if ( scale > 1 )
+    {
+        // save the original image size
+        image->SetOption(wxIMAGE_OPTION_ORIGINAL_WIDTH, width);
+        image->SetOption(wxIMAGE_OPTION_ORIGINAL_HEIGHT, height);
+    }
 
-    // loaded successfully, now init wxImage with this data
-    CopyDataFromPNG(image, lines, width, height, color_type);
+    png_destroy_read_struct( &png_ptr, &info_ptr, (png_infopp) NULL );
 
-    for ( i = 0; i < height; i++ )
-        free( lines[i] );
     free( lines );
+    free( rows );
+    free( sums );
 
     return true;
 
@@ -414,13 +521,9 @@ error:
         image->Destroy();
     }
 
-    if ( lines )
-    {
-        for ( unsigned int n = 0; n < height; n++ )
-            free( lines[n] );
-
-        free( lines );
-    }
+    free( lines );
+    free( rows );
+    free( sums );
 
     if ( png_ptr )
     {
@@ -22,9 +22,11 @@
  * It is also possible to use just the second pass to map to an arbitrary
  * externally-given color map.
  *
- * Note: ordered dithering is not supported, since there isn't any fast
- * way to compute intercolor distances; it's unclear that ordered dither's
- * fundamental assumptions even hold with an irregularly spaced color map.
+ * Note: ordered dithering is not supported by the original code, since
+ * there isn't any fast way to compute intercolor distances; it's unclear that
+ * ordered dither's fundamental assumptions even hold with an irregularly
+ * spaced color map.  We still provide it as a faster alternative to F-S
+ * dithering, using the dither amplitude of an equivalent regular color map.
  */
 
 /* modified by Vaclav Slavik for use as jpeglib-independent module */
@@ -45,6 +47,10 @@
     #include "wx/image.h"
 #endif
 
+#if wxUSE_THREADS
+    #include "wx/thread.h"
+#endif
+
 #ifdef __WXMSW__
     #include "wx/msw/private.h"
 #endif
@@ -74,6 +80,7 @@ typedef struct {
         JSAMPARRAY colormap;
         int actual_number_of_colors;
         int desired_number_of_colors;
+        bool ordered_dither;
         JSAMPLE *sample_range_limit, *srl_orig;
 } j_decompress;
 
@@ -216,6 +223,7 @@ struct jpeg_color_quantizer {
 
 
 typedef wxUint16 histcell;    /* histogram cell; prefer an unsigned type */
+#define MAXHISTCELL  0xFFFF     /* maximal count stored in a histogram cell */
 
 typedef histcell  * histptr;    /* for pointers to histogram cells */
 
@@ -259,6 +267,30 @@ typedef wxInt32 LOCFSERROR;   /* be sure calculation temps are big enough */
 typedef FSERROR  *FSERRPTR; /* pointer to error array (in  storage!) */
 
 
+/* Declarations for ordered dithering.
+ *
+ * We use the standard 8x8 Bayer matrix, which is scaled at the start of the
+ * second pass to the spacing of a regular color map with the same number of
+ * colors, i.e. the same offset is added to all the components of a pixel
+ * before looking up its nearest color.
+ */
+
+#define ODITHER_SIZE  8     /* dimension of dither matrix */
+#define ODITHER_CELLS (ODITHER_SIZE*ODITHER_SIZE)   /* # cells in matrix */
+#define ODITHER_MASK  (ODITHER_SIZE-1) /* mask for wrapping around counters */
+
+static const wxUint8 base_dither_matrix[ODITHER_SIZE][ODITHER_SIZE] = {
+  {  0, 32,  8, 40,  2, 34, 10, 42 },
+  { 48, 16, 56, 24, 50, 18, 58, 26 },
+  { 12, 44,  4, 36, 14, 46,  6, 38 },
+  { 60, 28, 52, 20, 62, 30, 54, 22 },
+  {  3, 35, 11, 43,  1, 33,  9, 41 },
+  { 51, 19, 59, 27, 49, 17, 57, 25 },
+  { 15, 47,  7, 39, 13, 45,  5, 37 },
+  { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+
 /* Private subobject */
 
 typedef struct {
@@ -283,11 +315,175 @@ typedef struct {
   FSERRPTR fserrors;        /* accumulated errors */
   bool on_odd_row;      /* flag to remember which row we are on */
   int * error_limiter;      /* table for clamping the applied error */
+
+  /* Variables for ordered dithering */
+  int odither[ODITHER_SIZE][ODITHER_SIZE]; /* scaled dither matrix */
+  int row_index;        /* current output row number */
 } my_cquantizer;
 
 typedef my_cquantizer * my_cquantize_ptr;
 
 
+/*
+ * The histogram is allocated in a single chunk, which allows to process all
+ * of its cells in a single loop when needed.
+ */
+
+static hist3d
+alloc_histogram (void)
+/* Allocate a histogram with all counts set to zero */
+{
+  hist3d histogram = (hist3d) malloc(HIST_C0_ELEMS * sizeof(hist2d));
+  hist2d cells = (hist2d) calloc(HIST_C0_ELEMS * HIST_C1_ELEMS, sizeof(hist1d));
+  for (int i = 0; i < HIST_C0_ELEMS; i++)
+    histogram[i] = cells + i * HIST_C1_ELEMS;
+  return histogram;
+}
+
+static void
+free_histogram (hist3d histogram)
+{
+  free(histogram[0]);
+  free(histogram);
+}
+
+static void
+add_histogram (hist3d histogram, hist3d other)
+/* Add the counts of another histogram, clamping them as prescan does */
+{
+  histptr histp = histogram[0][0];
+  histptr otherp = other[0][0];
+  for (long i = HIST_C0_ELEMS*HIST_C1_ELEMS*HIST_C2_ELEMS; i > 0; i--) {
+    wxUint32 count = (wxUint32) *histp + *otherp++;
+    *histp++ = (histcell) (count > MAXHISTCELL ? MAXHISTCELL : count);
+  }
+}
+
+
+/*
+ * Big images are processed in horizontal bands of rows by several threads,
+ * with the band containing the first rows processed by the calling thread.
+ * This is only done for the passes which treat all pixels independently:
+ * the histogram prescan, which accumulates the counts of each band in a
+ * separate histogram, and ordered dithering.  F-S dithering propagates the
+ * errors from each row to the next one and so is always done sequentially.
+ */
+
+typedef void (*band_method) (j_decompress_ptr cinfo, void * band_data,
+                 JSAMPARRAY input_buf, JSAMPARRAY output_buf,
+                 int first_row, int num_rows);
+
+#define MIN_BAND_PIXELS  (256*1024) /* not worth using a thread for less */
+#define MAX_BANDS        16     /* maximal number of threads to use */
+
+#if wxUSE_THREADS
+
+class QuantizeBandThread : public wxThread
+{
+public:
+    QuantizeBandThread(band_method method, j_decompress_ptr cinfo,
+                       void *band_data,
+                       JSAMPARRAY input_buf, JSAMPARRAY output_buf,
+                       int first_row, int num_rows)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_method(method),
+          m_cinfo(cinfo),
+          m_band_data(band_data),
+          m_input_buf(input_buf),
+          m_output_buf(output_buf),
+          m_first_row(first_row),
+          m_num_rows(num_rows)
+    {
+    }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        m_method(m_cinfo, m_band_data, m_input_buf, m_output_buf,
+                 m_first_row, m_num_rows);
+        return 0;
+    }
+
+private:
+    const band_method m_method;
+    const j_decompress_ptr m_cinfo;
+    void * const m_band_data;
+    const JSAMPARRAY m_input_buf,
+                     m_output_buf;
+    const int m_first_row,
+              m_num_rows;
+
+    wxDECLARE_NO_COPY_CLASS(QuantizeBandThread);
+};
+
+#endif // wxUSE_THREADS
+
+static int
+get_num_bands (j_decompress_ptr cinfo, int num_rows)
+/* Return the number of bands to split the given rows into */
+{
+#if wxUSE_THREADS
+  int num_bands = wxThread::GetCPUCount();
+  const size_t num_pixels = (size_t) cinfo->output_width * num_rows;
+  if ((size_t) num_bands > num_pixels / MIN_BAND_PIXELS)
+    num_bands = (int) (num_pixels / MIN_BAND_PIXELS);
+  if (num_bands > MAX_BANDS)
+    num_bands = MAX_BANDS;
+  if (num_bands > num_rows)
+    num_bands = num_rows;
+  return num_bands > 1 ? num_bands : 1;
+#else
+  wxUnusedVar(cinfo);
+  wxUnusedVar(num_rows);
+  return 1;
+#endif
+}
+
+static void
+run_in_bands (j_decompress_ptr cinfo, band_method method, void ** band_data,
+          int num_bands, JSAMPARRAY input_buf, JSAMPARRAY output_buf,
+          int num_rows)
+/* Call the method for each of the bands, band_data may be NULL */
+{
+#if wxUSE_THREADS
+  QuantizeBandThread * threads[MAX_BANDS];
+  int band;
+
+  for (band = 1; band < num_bands; band++) {
+    int first_row = (int) ((wxInt64) num_rows * band / num_bands);
+    int last_row = (int) ((wxInt64) num_rows * (band + 1) / num_bands);
+    void * data = band_data ? band_data[band] : NULL;
+
+    threads[band] = new QuantizeBandThread(method, cinfo, data,
+                       input_buf, output_buf,
+                       first_row, last_row - first_row);
+    if (threads[band]->Run() != wxTHREAD_NO_ERROR) {
+      /* Process the band in this thread if we couldn't start a new one */
+      wxDELETE(threads[band]);
+      method(cinfo, data, input_buf, output_buf,
+         first_row, last_row - first_row);
+    }
+  }
+
+  method(cinfo, band_data ? band_data[0] : NULL, input_buf, output_buf,
+     0, num_rows / num_bands);
+
+  for (band = 1; band < num_bands; band++) {
+    if (threads[band]) {
+      threads[band]->Wait();
+      delete threads[band];
+    }
+  }
+#else
+  wxASSERT( num_bands == 1 );
+  wxUnusedVar(num_bands);
+
+  method(cinfo, band_data ? band_data[0] : NULL, input_buf, output_buf,
+     0, num_rows);
+#endif
+}
+
+
 /*
  * Prescan some rows of pixels.
  * In this module the prescan simply updates the histogram, which has been
@@ -297,19 +493,20 @@ typedef my_cquantizer * my_cquantize_ptr;
  * NULL pointer).
  */
 
-void
-prescan_quantize (j_decompress_ptr cinfo, JSAMPARRAY input_buf,
-          JSAMPARRAY WXUNUSED(output_buf), int num_rows)
+static void
+prescan_band (j_decompress_ptr cinfo, void * band_data,
+          JSAMPARRAY input_buf, JSAMPARRAY WXUNUSED(output_buf),
+          int first_row, int num_rows)
+/* Update the histogram passed as band data with the given rows */
 {
-  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
   JSAMPROW ptr;
   histptr histp;
-  hist3d histogram = cquantize->histogram;
+  hist3d histogram = (hist3d) band_data;
   int row;
   JDIMENSION col;
   JDIMENSION width = cinfo->output_width;
 
-  for (row = 0; row < num_rows; row++) {
+  for (row = first_row; row < first_row + num_rows; row++) {
     ptr = input_buf[row];
     for (col = width; col > 0; col--) {
 
@@ -328,6 +525,31 @@ prescan_quantize (j_decompress_ptr cinfo, JSAMPARRAY input_buf,
   }
 }
 
+void
+prescan_quantize (j_decompress_ptr cinfo, JSAMPARRAY input_buf,
+          JSAMPARRAY output_buf, int num_rows)
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+  void * band_data[MAX_BANDS];
+  int num_bands = get_num_bands(cinfo, num_rows);
+  int band;
+
+  /* Use a separate histogram for each band but the first one, to avoid any
+   * synchronization between the threads, and add them up at the end.
+   */
+  band_data[0] = cquantize->histogram;
+  for (band = 1; band < num_bands; band++)
+    band_data[band] = alloc_histogram();
+
+  run_in_bands(cinfo, prescan_band, band_data, num_bands,
+           input_buf, output_buf, num_rows);
+
+  for (band = 1; band < num_bands; band++) {
+    add_histogram(cquantize->histogram, (hist3d) band_data[band]);
+    free_histogram((hist3d) band_data[band]);
+  }
+}
+
 
 /*
  * Next we have the really interesting routines: selection of a colormap
@@ -1169,6 +1391,116 @@ pass2_fs_dither (j_decompress_ptr cinfo,
 }
 
 
+static void
+fill_all_inverse_cmap (j_decompress_ptr cinfo)
+/* Fill all the inverse-colormap entries not filled yet */
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+  hist3d histogram = cquantize->histogram;
+  int c0, c1, c2;
+
+  /* Boxes are always filled entirely, so checking their corners suffices */
+  for (c0 = 0; c0 < HIST_C0_ELEMS; c0 += BOX_C0_ELEMS) {
+    for (c1 = 0; c1 < HIST_C1_ELEMS; c1 += BOX_C1_ELEMS) {
+      for (c2 = 0; c2 < HIST_C2_ELEMS; c2 += BOX_C2_ELEMS) {
+    if (histogram[c0][c1][c2] == 0)
+      fill_inverse_cmap(cinfo, c0, c1, c2);
+      }
+    }
+  }
+}
+
+
+static void
+pass2_ordered_band (j_decompress_ptr cinfo, void * WXUNUSED(band_data),
+            JSAMPARRAY input_buf, JSAMPARRAY output_buf,
+            int first_row, int num_rows)
+/* Map the given rows using ordered dithering */
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+  hist3d histogram = cquantize->histogram;
+  JSAMPROW inptr, outptr;
+  histptr cachep;
+  const int * dither;   /* points to active row of dither matrix */
+  int c0, c1, c2;
+  int row, col_index;
+  JDIMENSION col;
+  JDIMENSION width = cinfo->output_width;
+  JSAMPLE *range_limit = cinfo->sample_range_limit;
+
+  for (row = first_row; row < first_row + num_rows; row++) {
+    inptr = input_buf[row];
+    outptr = output_buf[row];
+    dither = cquantize->odither[(cquantize->row_index + row) & ODITHER_MASK];
+    col_index = 0;
+    for (col = width; col > 0; col--) {
+      /* add the dither value and range-limit the result, the dither values
+       * are small enough for range_limit to handle them */
+      int d = dither[col_index];
+      c0 = GETJSAMPLE(range_limit[GETJSAMPLE(inptr[0]) + d]) >> C0_SHIFT;
+      c1 = GETJSAMPLE(range_limit[GETJSAMPLE(inptr[1]) + d]) >> C1_SHIFT;
+      c2 = GETJSAMPLE(range_limit[GETJSAMPLE(inptr[2]) + d]) >> C2_SHIFT;
+      inptr += 3;
+      col_index = (col_index + 1) & ODITHER_MASK;
+      cachep = & histogram[c0][c1][c2];
+      /* If we have not seen this color before, find nearest colormap entry */
+      /* and update the cache */
+      if (*cachep == 0)
+    fill_inverse_cmap(cinfo, c0,c1,c2);
+      /* Now emit the colormap index for this cell */
+      *outptr++ = (JSAMPLE) (*cachep - 1);
+    }
+  }
+}
+
+static void
+pass2_ordered_dither (j_decompress_ptr cinfo,
+              JSAMPARRAY input_buf, JSAMPARRAY output_buf, int num_rows)
+/* This version performs ordered dithering */
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+  int num_bands = get_num_bands(cinfo, num_rows);
+
+  /* The inverse colormap can't be updated lazily by several threads, so
+   * fill it entirely before starting them.
+   */
+  if (num_bands > 1)
+    fill_all_inverse_cmap(cinfo);
+
+  run_in_bands(cinfo, pass2_ordered_band, NULL, num_bands,
+           input_buf, output_buf, num_rows);
+
+  cquantize->row_index += num_rows;
+}
+
+
+/*
+ * Initialize the ordered dither matrix for the current colormap.
+ * As in the 1-pass quantizer, the dither values are set up to span the
+ * distance between the adjacent output values of a component, which we
+ * estimate as if the colormap were uniformly spread over the color cube.
+ */
+
+static void
+init_odither (j_decompress_ptr cinfo)
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+  int ncolors = 2;      /* # of values per component, at least 2 */
+  int j, k;
+
+  while (ncolors * ncolors * ncolors < cinfo->actual_number_of_colors)
+    ncolors++;
+
+  for (j = 0; j < ODITHER_SIZE; j++) {
+    for (k = 0; k < ODITHER_SIZE; k++) {
+      cquantize->odither[j][k] =
+    ((ODITHER_CELLS-1 - 2*(int) base_dither_matrix[j][k]) * MAXJSAMPLE) /
+    (2 * ODITHER_CELLS * (ncolors-1));
+    }
+  }
+}
+
+
 /*
  * Initialize the error-limiting transfer function (lookup table).
  * The raw F-S error computation can potentially compute error values of up to
@@ -1255,6 +1587,13 @@ start_pass_2_quant (j_decompress_ptr cinfo, bool is_pre_scan)
     cquantize->pub.color_quantize = prescan_quantize;
     cquantize->pub.finish_pass = finish_pass1;
     cquantize->needs_zeroed = true; /* Always zero histogram */
+  } else if (cinfo->ordered_dither) {
+    /* Set up method pointers */
+    cquantize->pub.color_quantize = pass2_ordered_dither;
+    cquantize->pub.finish_pass = finish_pass2;
+
+    init_odither(cinfo);
+    cquantize->row_index = 0;
   } else {
     /* Set up method pointers */
     cquantize->pub.color_quantize = pass2_fs_dither;
@@ -1308,7 +1647,6 @@ void
 jinit_2pass_quantizer (j_decompress_ptr cinfo)
 {
   my_cquantize_ptr cquantize;
-  int i;
 
   cquantize = (my_cquantize_ptr) malloc(sizeof(my_cquantizer));
   cinfo->cquantize = (jpeg_color_quantizer *) cquantize;
@@ -1319,10 +1657,7 @@ jinit_2pass_quantizer (j_decompress_ptr cinfo)
 
 
   /* Allocate the histogram/inverse colormap storage */
-  cquantize->histogram = (hist3d) malloc(HIST_C0_ELEMS * sizeof(hist2d));
-  for (i = 0; i < HIST_C0_ELEMS; i++) {
-    cquantize->histogram[i] = (hist2d) malloc(HIST_C1_ELEMS*HIST_C2_ELEMS * sizeof(histcell));
-  }
+  cquantize->histogram = alloc_histogram();
   cquantize->needs_zeroed = true; /* histogram is garbage now */
 
   /* Allocate storage for the completed colormap, if required.
@@ -1400,13 +1735,14 @@ prepare_range_limit_table (j_decompress_ptr cinfo)
 wxIMPLEMENT_DYNAMIC_CLASS(wxQuantize, wxObject);
 
 void wxQuantize::DoQuantize(unsigned w, unsigned h, unsigned char **in_rows, unsigned char **out_rows,
-    unsigned char *palette, int desiredNoColours)
+    unsigned char *palette, int desiredNoColours, int flags)
 {
     j_decompress dec;
     my_cquantize_ptr cquantize;
 
     dec.output_width = w;
     dec.desired_number_of_colors = desiredNoColours;
+    dec.ordered_dither = (flags & wxQUANTIZE_ORDERED_DITHER) != 0;
     prepare_range_limit_table(&dec);
     jinit_2pass_quantizer(&dec);
     cquantize = (my_cquantize_ptr) dec.cquantize;
@@ -1427,8 +1763,7 @@ void wxQuantize::DoQuantize(unsigned w, unsigned h, unsigned char **in_rows, uns
         palette[3 * i + 2] = dec.colormap[2][i];
     }
 
-    for (int ii = 0; ii < HIST_C0_ELEMS; ii++) free(cquantize->histogram[ii]);
-    free(cquantize->histogram);
+    free_histogram(cquantize->histogram);
     free(dec.colormap[0]);
     free(dec.colormap[1]);
     free(dec.colormap[2]);
@@ -1486,7 +1821,7 @@ bool wxQuantize::Quantize(const wxImage& src, wxImage& dest,
         outrows[i] = data8bit + w * i;
 
     //RGB->palette
-    DoQuantize(w, h, rows, outrows, palette, desiredNoColours);
+    DoQuantize(w, h, rows, outrows, palette, desiredNoColours, flags);
 
     delete[] rows;
     delete[] outrows;
@@ -44,6 +44,7 @@
 #include <errno.h>
 
 #include "wx/socket.h"
+#include "wx/vector.h"
 
 // --------------------------------------------------------------------------
 // macros and constants
@@ -67,15 +68,24 @@ enum IPCCode
     IPC_FAIL            = 9,
     IPC_CONNECT         = 10,
     IPC_DISCONNECT      = 11,
+    IPC_REQUEST_ASYNC   = 12,
+    IPC_REQUEST_ASYNC_REPLY = 13,
+    IPC_REQUEST_ASYNC_FAIL  = 14,
     IPC_MAX
 };
 
+// The maximal number of requests sent by wxTCPConnection::RequestAsync() and
+// waiting for the replies.
+const size_t MAX_PENDING_REQUESTS = 64;
+
 } // anonymous namespace
 
-// headers needed for umask()
+// headers needed for umask() and TCP_NODELAY
 #ifdef __UNIX_LIKE__
     #include <sys/types.h>
     #include <sys/stat.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
 #endif // __UNIX_LIKE__
 
 // ----------------------------------------------------------------------------
@@ -111,6 +121,21 @@ GetAddressFromName(const wxString& serverName,
     }
 }
 
+// disable Nagle algorithm for the IPC socket: we already write each message
+// at once, so delaying sending it only increases the latency, especially when
+// several requests are sent without waiting for the replies to them
+static void DisableSendDelay(wxSocketBase& sock)
+{
+#ifdef TCP_NODELAY
+    // this fails for AF_UNIX sockets but it doesn't matter as there is no
+    // delay for them anyhow
+    int flag = 1;
+    sock.SetOption(IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+#else
+    wxUnusedVar(sock);
+#endif
+}
+
 // --------------------------------------------------------------------------
 // wxTCPEventHandler stuff (private class)
 // --------------------------------------------------------------------------
@@ -123,9 +148,19 @@ public:
     void Client_OnRequest(wxSocketEvent& event);
     void Server_OnRequest(wxSocketEvent& event);
 
+    // process all the messages which can be read from the connection socket
+    // without blocking, optionally waiting for at least one message to arrive
+    // first, return false if an error occurred or the connection was closed or
+    // deleted
+    bool ProcessInput(wxTCPConnection *connection, bool wait = false);
+
 private:
     void HandleDisconnect(wxTCPConnection *connection);
 
+    // handle a single message received by the connection, return false if an
+    // error occurred and the rest of the input can't be processed
+    bool HandleMessage(wxTCPConnection *connection);
+
     wxDECLARE_EVENT_TABLE();
     wxDECLARE_NO_COPY_CLASS(wxTCPEventHandler);
 };
@@ -169,6 +204,114 @@ wxIMPLEMENT_DYNAMIC_CLASS(wxTCPEventHandlerModule, wxModule);
 
 wxTCPEventHandler *wxTCPEventHandlerModule::ms_handler = NULL;
 
+// --------------------------------------------------------------------------
+// wxIPCSocketInputStream
+// --------------------------------------------------------------------------
+
+// this stream reads all the data available in the socket at once instead of
+// reading every field of the IPC messages separately, which allows to process
+// several messages, e.g. the replies to the pipelined requests, using a single
+// system call
+class wxIPCSocketInputStream : public wxInputStream
+{
+public:
+    wxIPCSocketInputStream(wxSocketBase& sock)
+        : m_sock(sock)
+    {
+        m_pos =
+        m_len = 0;
+        m_reading = false;
+    }
+
+    // return true if we have some data which was already read from the socket
+    bool HasBufferedData() const { return m_pos < m_len; }
+
+    // return true if we're waiting for the data to arrive
+    bool IsReading() const { return m_reading; }
+
+    // read the data available in the socket, if any, without blocking and
+    // return true if there is any data to process now
+    bool ReadAvailable()
+    {
+        if ( !HasBufferedData() )
+            Fill(wxSOCKET_NOWAIT_READ);
+
+        return HasBufferedData();
+    }
+
+protected:
+    virtual size_t OnSysRead(void *buffer, size_t size) wxOVERRIDE
+    {
+        if ( !HasBufferedData() )
+        {
+            // there is no need to copy big blocks of data through our buffer
+            if ( size >= sizeof(m_buffer) )
+                return DoRead(buffer, size, m_sock.GetFlags());
+
+            // read whatever is available but don't wait for more than that
+            if ( !Fill(m_sock.GetFlags() & ~wxSOCKET_WAITALL_READ) )
+                return 0;
+        }
+
+        if ( size > m_len - m_pos )
+            size = m_len - m_pos;
+
+        memcpy(buffer, m_buffer + m_pos, size);
+        m_pos += size;
+
+        return size;
+    }
+
+    // socket streams are both un-seekable and size-less streams
+    virtual wxFileOffset OnSysTell() const wxOVERRIDE
+        { return wxInvalidOffset; }
+    virtual wxFileOffset
+    OnSysSeek(wxFileOffset WXUNUSED(pos), wxSeekMode WXUNUSED(mode)) wxOVERRIDE
+        { return wxInvalidOffset; }
+
+private:
+    // read into the given buffer using the specified socket flags
+    size_t DoRead(void *buffer, size_t size, wxSocketFlags flags)
+    {
+        const wxSocketFlags flagsOrig = m_sock.GetFlags();
+        m_sock.SetFlags(flags);
+
+        m_reading = true;
+        const size_t ret = m_sock.Read(buffer, size).LastCount();
+        m_reading = false;
+
+        m_sock.SetFlags(flagsOrig);
+
+        // this is the same as in wxSocketInputStream::OnSysRead()
+        m_lasterror = m_sock.Error()
+                        ? m_sock.IsClosed() ? wxSTREAM_EOF
+                                            : wxSTREAM_READ_ERROR
+                        : wxSTREAM_NO_ERROR;
+        return ret;
+    }
+
+    // refill the (empty) buffer, return the number of bytes read
+    size_t Fill(wxSocketFlags flags)
+    {
+        m_pos = 0;
+        m_len = DoRead(m_buffer, sizeof(m_buffer), flags);
+
+        return m_len;
+    }
+
+    wxSocketBase& m_sock;
+
+    // the buffer contains m_len bytes of which the first m_pos were consumed
+    char m_buffer[4096];
+    size_t m_pos,
+           m_len;
+
+    // true while we're inside wxSocketBase::Read()
+    bool m_reading;
+
+    wxDECLARE_NO_COPY_CLASS(wxIPCSocketInputStream);
+};
+
 // --------------------------------------------------------------------------
 // wxIPCSocketStreams
 // --------------------------------------------------------------------------
@@ -193,9 +336,27 @@ public:
 #else
           m_bufferedOut(m_socketStream),
 #endif
-          m_dataIn(m_socketStream),
+          m_in(sock),
+          m_dataIn(m_in),
           m_dataOut(m_bufferedOut)
     {
+        m_batchDepth = 0;
+        m_destroyed = NULL;
+    }
+
+    ~wxIPCSocketStreams()
+    {
+        if ( m_destroyed )
+            *m_destroyed = true;
+    }
+
+    // set the flag to be set when this object is destroyed, which happens if
+    // the connection is deleted, and return the previously used one
+    bool *SetDestroyedFlag(bool *destroyed)
+    {
+        bool * const old = m_destroyed;
+        m_destroyed = destroyed;
+        return old;
     }
 
     // expose the IO methods needed by IPC code (notice that writing is only
@@ -209,23 +370,56 @@ public:
 #endif
     }
 
+    // between the calls to these functions the output is not flushed when
+    // IPCOutput is destroyed, this is used to send the replies to several
+    // messages at once, the output is flushed by the last EndBatch() call
+    void StartBatch() { m_batchDepth++; }
+    void EndBatch()
+    {
+        if ( !--m_batchDepth )
+            Flush();
+    }
+
+    bool IsBatching() const { return m_batchDepth != 0; }
+
+    // return true if we already have some unprocessed input, which won't
+    // result in any socket events as it was already read from the socket
+    bool HasBufferedInput() const { return m_in.HasBufferedData(); }
+
+    // return true if there is any input to process right now, this is used to
+    // ignore the socket events for the input which was already read
+    bool HasInput()
+    {
+        return !m_in.IsReading() && m_in.ReadAvailable();
+    }
+
+    // flush the output before reading the input as the other side could be
+    // waiting for it before sending us anything, but don't do it when
+    // processing a batch of messages which were already received, as the read
+    // won't block then and the replies will be flushed by EndBatch()
+    void FlushBeforeRead()
+    {
+        if ( !IsBatching() || !HasBufferedInput() )
+            Flush();
+    }
+
     // simple wrappers around the functions with the same name in
     // wxDataInputStream
     wxUint8 Read8()
     {
-        Flush();
+        FlushBeforeRead();
         return m_dataIn.Read8();
     }
 
     wxUint32 Read32()
     {
-        Flush();
+        FlushBeforeRead();
         return m_dataIn.Read32();
     }
 
     wxString ReadString()
     {
-        Flush();
+        FlushBeforeRead();
         return m_dataIn.ReadString();
     }
 
@@ -234,8 +428,6 @@ public:
     // connection parameter is needed to call its GetBufferAtLeast() method
     void *ReadData(wxConnectionBase *conn, size_t *size)
     {
-        Flush();
-
         wxCHECK_MSG( conn, NULL, "NULL connection parameter" );
         wxCHECK_MSG( size, NULL, "NULL size parameter" );
 
@@ -244,7 +436,8 @@ public:
         void * const data = conn->GetBufferAtLeast(*size);
         wxCHECK_MSG( data, NULL, "IPC buffer allocation failed" );
 
-        m_socketStream.Read(data, *size);
+        FlushBeforeRead();
+        m_in.Read(data, *size);
 
         return data;
     }
@@ -278,22 +471,116 @@ private:
     wxOutputStream& m_bufferedOut;
 #endif
 
+    // the input stream reading the socket data in big chunks
+    wxIPCSocketInputStream m_in;
+
     // finally the data streams are used to be able to write typed data into
     // the above streams easily
     wxDataInputStream  m_dataIn;
     wxDataOutputStream m_dataOut;
 
+    // the number of StartBatch() calls without matching EndBatch()
+    int m_batchDepth;
+
+    // if non-NULL, set to true by the dtor
+    bool *m_destroyed;
+
     wxDECLARE_NO_COPY_CLASS(wxIPCSocketStreams);
 };
 
+// --------------------------------------------------------------------------
+// wxIPCPendingRequests
+// --------------------------------------------------------------------------
+
+// the queue of requests sent by wxTCPConnection::RequestAsync() and waiting
+// for the reply, the replies always come in the same order as the requests
+class wxIPCPendingRequests
+{
+public:
+    struct Request
+    {
+        wxUint32 id;
+        wxString item;
+        wxIPCFormat format;
+    };
+
+    wxIPCPendingRequests() { m_first = 0; }
+
+    size_t GetCount() const { return m_requests.size() - m_first; }
+
+    void Push(wxUint32 id, const wxString& item, wxIPCFormat format)
+    {
+        Request req;
+        req.id = id;
+        req.item = item;
+        req.format = format;
+        m_requests.push_back(req);
+    }
+
+    // remove the oldest request and return it in the output parameter, return
+    // false if there are no requests or if the oldest one has a different ID
+    bool Pop(wxUint32 id, Request& req)
+    {
+        if ( !GetCount() || m_requests[m_first].id != id )
+            return false;
+
+        req = m_requests[m_first++];
+
+        // don't let the already replied requests accumulate if new ones are
+        // constantly added
+        if ( m_first == m_requests.size() )
+        {
+            m_requests.clear();
+            m_first = 0;
+        }
+        else if ( m_first >= 64 && 2*m_first >= m_requests.size() )
+        {
+            m_requests.erase(m_requests.begin(),
+                             m_requests.begin() + m_first);
+            m_first = 0;
+        }
+
+        return true;
+    }
+
+    // same as above but without checking the ID
+    bool PopFirst(Request& req)
+    {
+        return GetCount() && Pop(m_requests[m_first].id, req);
+    }
+
+private:
+    wxVector<Request> m_requests;
+
+    // the index of the oldest request in m_requests still waiting for reply
+    size_t m_first;
+
+    wxDECLARE_NO_COPY_CLASS(wxIPCPendingRequests);
+};
+
 namespace
 {
 
+// the data read from the socket together with the data we were waiting for
+// doesn't generate socket events, so generate one ourselves to process it
+void ProcessBufferedInputLater(wxSocketBase *sock, wxIPCSocketStreams *streams)
+{
+    if ( !streams->HasBufferedInput() )
+        return;
+
+    wxSocketEvent event(_CLIENT_ONREQUEST_ID);
+    event.m_event      = wxSOCKET_INPUT;
+    event.m_clientData = sock->GetClientData();
+    event.SetEventObject(sock);
+
+    wxTCPEventHandlerModule::GetHandler().AddPendingEvent(event);
+}
+
 // an object of this class should be instantiated on the stack to write to the
 // underlying socket stream
 //
 // this class is intentionally separated from wxIPCSocketStreams to ensure that
-// Flush() is always called
+// Flush() is always called, unless a batch of replies is being written
 class IPCOutput
 {
 public:
@@ -306,7 +593,11 @@ public:
     }
 
     // dtor calls Flush() really sending the IPC data to the network
-    ~IPCOutput() { m_streams.Flush(); }
+    ~IPCOutput()
+    {
+        if ( !m_streams.IsBatching() )
+            m_streams.Flush();
+    }
 
 
     // write a byte
@@ -315,6 +606,12 @@ public:
         m_streams.GetDataOut().Write8(i);
     }
 
+    // write a 32 bit integer
+    void Write32(wxUint32 i)
+    {
+        m_streams.GetDataOut().Write32(i);
+    }
+
     // write the reply code and a string
     void Write(IPCCode code, const wxString& str)
     {
@@ -385,6 +682,8 @@ wxConnectionBase *wxTCPClient::MakeConnection(const wxString& host,
 
     if ( ok )
     {
+        DisableSendDelay(*client);
+
         // Send topic name, and enquire whether this has succeeded
         IPCOutput(streams).Write(IPC_CONNECT, topic);
 
@@ -408,6 +707,10 @@ wxConnectionBase *wxTCPClient::MakeConnection(const wxString& host,
                     client->SetClientData(connection);
                     client->SetNotify(wxSOCKET_INPUT_FLAG | wxSOCKET_LOST_FLAG);
                     client->Notify(true);
+
+                    // the server could have already sent something to us
+                    ProcessBufferedInputLater(client, streams);
+
                     return connection;
                 }
                 else
@@ -547,6 +850,8 @@ void wxTCPConnection::Init()
 {
     m_sock = NULL;
     m_streams = NULL;
+    m_pendingRequests = NULL;
+    m_lastRequestId = 0;
 }
 
 wxTCPConnection::~wxTCPConnection()
@@ -560,6 +865,7 @@ wxTCPConnection::~wxTCPConnection()
     }
 
     delete m_streams;
+    delete m_pendingRequests;
 }
 
 void wxTCPConnection::Compress(bool WXUNUSED(on))
@@ -573,8 +879,10 @@ bool wxTCPConnection::Disconnect()
     if ( !GetConnected() )
         return true;
 
-    // Send the disconnect message to the peer.
+    // Send the disconnect message to the peer, flushing it explicitly as we
+    // could be called while writing a batch of replies.
     IPCOutput(m_streams).Write8(IPC_DISCONNECT);
+    m_streams->Flush();
 
     if ( m_sock )
     {
@@ -611,17 +919,70 @@ const void *wxTCPConnection::Request(const wxString& item,
     if ( !m_sock->IsConnected() )
         return NULL;
 
+    // we would get the reply to an asynchronous request instead of ours
+    wxCHECK_MSG( !GetPendingRequestsCount(), NULL,
+                 "can't use Request() while asynchronous requests are pending" );
+
     IPCOutput(m_streams).Write(IPC_REQUEST, item, format);
 
     const int ret = m_streams->Read8();
     if ( ret != IPC_REQUEST_REPLY )
+    {
+        ProcessBufferedInputLater(m_sock, m_streams);
         return NULL;
+    }
 
     // ReadData() needs a non-NULL size pointer but the client code can call us
     // with NULL pointer (this makes sense if it knows that it always works
     // with NUL-terminated strings)
     size_t sizeFallback;
-    return m_streams->ReadData(this, size ? size : &sizeFallback);
+    const void * const
+        data = m_streams->ReadData(this, size ? size : &sizeFallback);
+
+    ProcessBufferedInputLater(m_sock, m_streams);
+
+    return data;
+}
+
+wxUint32 wxTCPConnection::RequestAsync(const wxString& item, wxIPCFormat format)
+{
+    if ( !m_sock->IsConnected() )
+        return 0;
+
+    // Don't send too many requests without reading the replies to them:
+    // otherwise the socket buffers could become full and both we and the peer
+    // would block forever trying to send more data. Notice that we don't do it
+    // if we're called while processing the incoming messages as the replies
+    // will be read as soon as we return anyhow.
+    if ( !m_streams->IsBatching() )
+    {
+        wxTCPEventHandler& handler = wxTCPEventHandlerModule::GetHandler();
+        while ( GetPendingRequestsCount() >= MAX_PENDING_REQUESTS )
+        {
+            if ( !handler.ProcessInput(this, true /* wait */) )
+                return 0;
+        }
+    }
+
+    if ( !m_pendingRequests )
+        m_pendingRequests = new wxIPCPendingRequests;
+
+    // 0 is never used as it indicates an error
+    if ( !++m_lastRequestId )
+        ++m_lastRequestId;
+
+    IPCOutput out(m_streams);
+    out.Write(IPC_REQUEST_ASYNC, item, format);
+    out.Write32(m_lastRequestId);
+
+    m_pendingRequests->Push(m_lastRequestId, item, format);
+
+    return m_lastRequestId;
+}
+
+size_t wxTCPConnection::GetPendingRequestsCount() const
+{
+    return m_pendingRequests ? m_pendingRequests->GetCount() : 0;
 }
 
 bool wxTCPConnection::DoPoke(const wxString& item,
@@ -644,10 +1005,15 @@ bool wxTCPConnection::StartAdvise(const wxString& item)
     if ( !m_sock->IsConnected() )
         return false;
 
+    wxCHECK_MSG( !GetPendingRequestsCount(), false,
+                 "can't use StartAdvise() while asynchronous requests are pending" );
+
     IPCOutput(m_streams).Write(IPC_ADVISE_START, item);
 
     const int ret = m_streams->Read8();
 
+    ProcessBufferedInputLater(m_sock, m_streams);
+
     return ret == IPC_ADVISE_START;
 }
 
@@ -656,10 +1022,15 @@ bool wxTCPConnection::StopAdvise (const wxString& item)
     if ( !m_sock->IsConnected() )
         return false;
 
+    wxCHECK_MSG( !GetPendingRequestsCount(), false,
+                 "can't use StopAdvise() while asynchronous requests are pending" );
+
     IPCOutput(m_streams).Write(IPC_ADVISE_STOP, item);
 
     const int ret = m_streams->Read8();
 
+    ProcessBufferedInputLater(m_sock, m_streams);
+
     return ret == IPC_ADVISE_STOP;
 }
 
@@ -700,6 +1071,15 @@ void wxTCPEventHandler::HandleDisconnect(wxTCPConnection *connection)
     connection->m_sock->SetClientData(NULL);
 
     connection->SetConnected(false);
+
+    // the replies to the pending requests will never arrive now
+    if ( connection->m_pendingRequests )
+    {
+        wxIPCPendingRequests::Request req;
+        while ( connection->m_pendingRequests->PopFirst(req) )
+            connection->OnRequestReply(req.id, req.item, NULL, 0, req.format);
+    }
+
     connection->OnDisconnect();
 }
 
@@ -723,7 +1103,54 @@ void wxTCPEventHandler::Client_OnRequest(wxSocketEvent &event)
         return;
     }
 
-    // Receive message number.
+    ProcessInput(connection);
+}
+
+bool wxTCPEventHandler::ProcessInput(wxTCPConnection *connection, bool wait)
+{
+    wxSocketBase * const sock = connection->m_sock;
+    wxIPCSocketStreams * const streams = connection->m_streams;
+
+    // This could be called for the data which was already read, or is being
+    // read right now, by Request() or another call to this function: there is
+    // nothing to do in this case
+    if ( !wait && !streams->HasInput() )
+        return true;
+
+    // Process all the messages we have already received and send all the
+    // replies to them at once.
+    bool destroyed = false;
+    bool * const destroyedOuter = streams->SetDestroyedFlag(&destroyed);
+    streams->StartBatch();
+
+    bool ok;
+    do
+    {
+        ok = HandleMessage(connection);
+
+        // The connection could have been destroyed while handling the
+        // message, in which case we can't use it nor its streams any more,
+        // but still need to let the outer call, if any, know about it.
+        if ( destroyed )
+        {
+            if ( destroyedOuter )
+                *destroyedOuter = true;
+            return false;
+        }
+
+        // Or it could have been closed.
+        if ( sock->GetClientData() != connection )
+            ok = false;
+    } while ( ok && connection->GetConnected() && streams->HasBufferedInput() );
+
+    streams->SetDestroyedFlag(destroyedOuter);
+    streams->EndBatch();
+
+    return ok && connection->GetConnected();
+}
+
+bool wxTCPEventHandler::HandleMessage(wxTCPConnection *connection)
+{
     wxIPCSocketStreams * const streams = connection->m_streams;
 
     const wxString topic = connection->m_topic;
@@ -731,6 +1158,7 @@ void wxTCPEventHandler::Client_OnRequest(wxSocketEvent &event)
 
     bool error = false;
 
+    // Receive message number.
     const int msg = streams->Read8();
     switch ( msg )
     {
@@ -799,25 +1227,46 @@ void wxTCPEventHandler::Client_OnRequest(wxSocketEvent &event)
             break;
 
         case IPC_REQUEST:
+        case IPC_REQUEST_ASYNC:
             {
                 item = streams->ReadString();
 
                 wxIPCFormat format = (wxIPCFormat)streams->Read8();
 
+                // asynchronous requests are identified by their ID
+                const bool async = msg == IPC_REQUEST_ASYNC;
+                const wxUint32 id = async ? streams->Read32() : 0;
+
                 size_t user_size = wxNO_LEN;
                 const void *user_data = connection->OnRequest(topic,
                                                               item,
                                                               &user_size,
                                                               format);
 
+                IPCOutput out(streams);
                 if ( !user_data )
                 {
-                    IPCOutput(streams).Write8(IPC_FAIL);
+                    if ( async )
+                    {
+                        out.Write8(IPC_REQUEST_ASYNC_FAIL);
+                        out.Write32(id);
+                    }
+                    else
+                    {
+                        out.Write8(IPC_FAIL);
+                    }
                     break;
                 }
 
-                IPCOutput out(streams);
-                out.Write8(IPC_REQUEST_REPLY);
+                if ( async )
+                {
+                    out.Write8(IPC_REQUEST_ASYNC_REPLY);
+                    out.Write32(id);
+                }
+                else
+                {
+                    out.Write8(IPC_REQUEST_REPLY);
+                }
 
                 if ( user_size == wxNO_LEN )
                 {
@@ -839,6 +1288,36 @@ void wxTCPEventHandler::Client_OnRequest(wxSocketEvent &event)
             }
             break;
 
+        case IPC_REQUEST_ASYNC_REPLY:
+        case IPC_REQUEST_ASYNC_FAIL:
+            {
+                const wxUint32 id = streams->Read32();
+
+                size_t size = 0;
+                void *data = NULL;
+                if ( msg == IPC_REQUEST_ASYNC_REPLY )
+                {
+                    data = streams->ReadData(connection, &size);
+                    if ( !data )
+                    {
+                        error = true;
+                        break;
+                    }
+                }
+
+                wxIPCPendingRequests::Request req;
+                if ( !connection->m_pendingRequests ||
+                        !connection->m_pendingRequests->Pop(id, req) )
+                {
+                    wxLogDebug("Unexpected reply to request %u received.", id);
+                    error = true;
+                    break;
+                }
+
+                connection->OnRequestReply(id, req.item, data, size, req.format);
+            }
+            break;
+
         case IPC_DISCONNECT:
             HandleDisconnect(connection);
             break;
@@ -856,6 +1335,8 @@ void wxTCPEventHandler::Client_OnRequest(wxSocketEvent &event)
 
     if ( error )
         IPCOutput(streams).Write8(IPC_FAIL);
+
+    return !error;
 }
 
 void wxTCPEventHandler::Server_OnRequest(wxSocketEvent &event)
@@ -882,6 +1363,8 @@ void wxTCPEventHandler::Server_OnRequest(wxSocketEvent &event)
         return;
     }
 
+    DisableSendDelay(*sock);
+
     wxIPCSocketStreams *streams = new wxIPCSocketStreams(*sock);
 
     {
@@ -44,12 +44,15 @@
 #include "wx/thread.h"
 #include "wx/evtloop.h"
 #include "wx/link.h"
+#include "wx/vector.h"
 
 #include "wx/private/fd.h"
 #include "wx/private/socket.h"
 
 #ifdef __UNIX__
     #include <errno.h>
+    #include <limits.h>
+    #include <sys/uio.h>
 #endif
 
 // we use MSG_NOSIGNAL to avoid getting SIGPIPE when sending data to a remote
@@ -116,6 +119,17 @@ wxDEFINE_EVENT(wxEVT_SOCKET, wxSocketEvent);
 // discard buffer
 #define MAX_DISCARD_SIZE (10 * 1024)
 
+// the amount of data accumulated in the write buffer before sending it
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+// the maximal number of buffers passed to a single sendmsg() or recvmsg() call,
+// the remaining ones, if any, are processed during the next iteration
+#if defined(IOV_MAX) && IOV_MAX < 64
+    #define MAX_IOVEC_COUNT IOV_MAX
+#else
+    #define MAX_IOVEC_COUNT 64
+#endif
+
 #define wxTRACE_Socket wxT("wxSocket")
 
 // --------------------------------------------------------------------------
@@ -141,6 +155,34 @@ void SetTimeValFromMS(timeval& tv, unsigned long ms)
     tv.tv_usec = (ms % 1000) * 1000;
 }
 
+wxUint32 GetIOVecSize(const wxSocketIOVec *vec, int count)
+{
+    wxUint32 size = 0;
+    for ( int n = 0; n < count; n++ )
+        size += vec[n].size;
+
+    return size;
+}
+
+// Advance the buffers array past the given number of bytes, dropping the
+// buffers which were completely consumed, and also skip any empty buffers at
+// its beginning.
+void SkipIOVecBytes(wxSocketIOVec*& vec, int& count, wxUint32 nbytes)
+{
+    while ( count && vec->size <= nbytes )
+    {
+        nbytes -= vec->size;
+        vec++;
+        count--;
+    }
+
+    if ( count )
+    {
+        vec->buffer = static_cast<char *>(vec->buffer) + nbytes;
+        vec->size -= nbytes;
+    }
+}
+
 } // anonymous namespace
 
 // --------------------------------------------------------------------------
@@ -648,6 +690,14 @@ const wxSockAddressImpl& wxSocketImpl::GetLocal()
     #define DO_WHILE_EINTR( rc, syscall ) rc = (syscall)
 #endif
 
+void wxSocketImpl::OnStreamClosed()
+{
+    m_establishing = false;
+    NotifyOnStateChange(wxSOCKET_LOST);
+
+    Shutdown();
+}
+
 int wxSocketImpl::RecvStream(void *buffer, int size)
 {
     int ret;
@@ -658,12 +708,9 @@ int wxSocketImpl::RecvStream(void *buffer, int size)
         // receiving 0 bytes for a TCP socket indicates that the connection was
         // closed by peer so shut down our end as well (for UDP sockets empty
         // datagrams are also possible)
-        m_establishing = false;
-        NotifyOnStateChange(wxSOCKET_LOST);
-
-        Shutdown();
-
+        //
         // do not return an error in this case however
+        OnStreamClosed();
     }
 
     return ret;
@@ -716,6 +763,151 @@ int wxSocketImpl::SendDgram(const void *buffer, int size)
     return ret;
 }
 
+#ifdef __UNIX__
+
+namespace
+{
+
+// Fill the iovec array, which must have MAX_IOVEC_COUNT elements, and return
+// the number of its elements actually used.
+int FillIOVec(iovec *iov, const wxSocketIOVec *vec, int count)
+{
+    if ( count > MAX_IOVEC_COUNT )
+        count = MAX_IOVEC_COUNT;
+
+    for ( int n = 0; n < count; n++ )
+    {
+        iov[n].iov_base = vec[n].buffer;
+        iov[n].iov_len = vec[n].size;
+    }
+
+    return count;
+}
+
+} // anonymous namespace
+
+int wxSocketImpl::RecvV(const wxSocketIOVec *vec, int count)
+{
+    iovec iov[MAX_IOVEC_COUNT];
+    wxSockAddressStorage from;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = FillIOVec(iov, vec, count);
+
+    if ( !m_stream )
+    {
+        msg.msg_name = &from.addr;
+        msg.msg_namelen = sizeof(from);
+    }
+
+    int ret;
+    DO_WHILE_EINTR( ret, recvmsg(m_fd, &msg, 0) );
+
+    if ( m_stream )
+    {
+        // see the comment in RecvStream()
+        if ( !ret )
+            OnStreamClosed();
+    }
+    else if ( ret != SOCKET_ERROR )
+    {
+        m_peer = wxSockAddressImpl(from.addr, msg.msg_namelen);
+        if ( !m_peer.IsOk() )
+            return -1;
+    }
+
+    return ret;
+}
+
+int wxSocketImpl::SendV(const wxSocketIOVec *vec, int count)
+{
+    iovec iov[MAX_IOVEC_COUNT];
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = FillIOVec(iov, vec, count);
+
+    int flags;
+    if ( m_stream )
+    {
+        flags = wxSOCKET_MSG_NOSIGNAL;
+    }
+    else
+    {
+        if ( !m_peer.IsOk() )
+        {
+            m_error = wxSOCKET_INVADDR;
+            return -1;
+        }
+
+        msg.msg_name = const_cast<sockaddr *>(m_peer.GetAddr());
+        msg.msg_namelen = m_peer.GetLen();
+
+        flags = 0;
+    }
+
+#ifdef wxNEEDS_IGNORE_SIGPIPE
+    IgnoreSignal ignore(SIGPIPE);
+#endif
+
+    int ret;
+    DO_WHILE_EINTR( ret, sendmsg(m_fd, &msg, flags) );
+
+    return ret;
+}
+
+#else // !__UNIX__
+
+// Winsock has WSARecv() and WSASend() but they require winsock2.h which is not
+// always included, so for the stream sockets just use the first buffer: the
+// callers retry with the remaining ones anyhow, as they must be prepared to
+// deal with partial reads and writes. For the datagram sockets all the data
+// must be transferred at once, so copy it to or from a contiguous buffer.
+
+int wxSocketImpl::RecvV(const wxSocketIOVec *vec, int count)
+{
+    if ( m_stream )
+        return RecvStream(vec->buffer, vec->size);
+
+    const wxUint32 size = GetIOVecSize(vec, count);
+    wxCharBuffer buf(size);
+
+    const int ret = RecvDgram(buf.data(), size);
+
+    const char *p = buf;
+    for ( int n = 0, left = ret; n < count && left > 0; n++ )
+    {
+        const int len = wxMin(static_cast<int>(vec[n].size), left);
+        memcpy(vec[n].buffer, p, len);
+        p += len;
+        left -= len;
+    }
+
+    return ret;
+}
+
+int wxSocketImpl::SendV(const wxSocketIOVec *vec, int count)
+{
+    if ( m_stream )
+        return SendStream(vec->buffer, vec->size);
+
+    wxCharBuffer buf(GetIOVecSize(vec, count));
+
+    char *p = buf.data();
+    for ( int n = 0; n < count; n++ )
+    {
+        memcpy(p, vec[n].buffer, vec[n].size);
+        p += vec[n].size;
+    }
+
+    return SendDgram(buf, buf.length());
+}
+
+#endif // __UNIX__/!__UNIX__
+
 int wxSocketImpl::Read(void *buffer, int size)
 {
     // server sockets can't be used for IO, only to accept new connections
@@ -749,6 +941,43 @@ int wxSocketImpl::Write(const void *buffer, int size)
     return ret;
 }
 
+int wxSocketImpl::ReadV(const wxSocketIOVec *vec, int count)
+{
+    // don't bother with the scatter IO for a single buffer
+    if ( count == 1 )
+        return Read(vec->buffer, vec->size);
+
+    if ( m_fd == INVALID_SOCKET || m_server )
+    {
+        m_error = wxSOCKET_INVSOCK;
+        return -1;
+    }
+
+    int ret = RecvV(vec, count);
+
+    m_error = ret == SOCKET_ERROR ? GetLastError() : wxSOCKET_NOERROR;
+
+    return ret;
+}
+
+int wxSocketImpl::WriteV(const wxSocketIOVec *vec, int count)
+{
+    if ( count == 1 )
+        return Write(vec->buffer, vec->size);
+
+    if ( m_fd == INVALID_SOCKET || m_server )
+    {
+        m_error = wxSOCKET_INVSOCK;
+        return -1;
+    }
+
+    int ret = SendV(vec, count);
+
+    m_error = ret == SOCKET_ERROR ? GetLastError() : wxSOCKET_NOERROR;
+
+    return ret;
+}
+
 // ==========================================================================
 // wxSocketBase
 // ==========================================================================
@@ -834,6 +1063,9 @@ void wxSocketBase::Init()
     m_unrd_size    = 0;
     m_unrd_cur     = 0;
 
+    // write buffer
+    m_writeBuffering = false;
+
     // events
     m_id           = wxID_ANY;
     m_handler      = NULL;
@@ -936,11 +1168,20 @@ wxSocketError wxSocketBase::LastError() const
 // {Read, Write, ReadMsg, WriteMsg, Peek, Unread, Discard}
 bool wxSocketBase::Close()
 {
+    // Try to send the data remaining in the write buffer, if any, as the
+    // socket user can reasonably expect it to be sent before closing it. This
+    // is done before interrupting the pending waits as Flush() may wait too.
+    if ( m_impl && m_connected )
+        Flush();
+
     // Interrupt pending waits
     InterruptWait();
 
     ShutdownOutput();
 
+    // whatever couldn't be sent above is lost now
+    m_writeBuffer.Clear();
+
     m_connected = false;
     m_establishing = false;
     return true;
@@ -962,22 +1203,43 @@ wxSocketBase& wxSocketBase::Read(void* buffer, wxUint32 nbytes)
     return *this;
 }
 
-wxUint32 wxSocketBase::DoRead(void* buffer_, wxUint32 nbytes)
+wxSocketBase& wxSocketBase::ReadV(const wxSocketIOVec *vec, int count)
 {
-    wxCHECK_MSG( m_impl, 0, "socket must be valid" );
+    wxSocketReadGuard read(this);
+
+    wxVector<wxSocketIOVec> buffers(vec, vec + count);
+    m_lcount_read = count ? DoReadV(&buffers[0], count) : 0;
+    m_lcount = m_lcount_read;
 
-    // We use pointer arithmetic here which doesn't work with void pointers.
-    char *buffer = static_cast<char *>(buffer_);
+    return *this;
+}
+
+wxUint32 wxSocketBase::DoRead(void* buffer, wxUint32 nbytes)
+{
     wxCHECK_MSG( buffer, 0, "NULL buffer" );
 
+    wxSocketIOVec vec(buffer, nbytes);
+    return DoReadV(&vec, 1);
+}
+
+wxUint32 wxSocketBase::DoReadV(wxSocketIOVec *vec, int count)
+{
+    wxCHECK_MSG( m_impl, 0, "socket must be valid" );
+
+    SkipIOVecBytes(vec, count, 0);
+
     // Try the push back buffer first, even before checking whether the socket
     // is valid to allow reading previously pushed back data from an already
     // closed socket.
-    wxUint32 total = GetPushback(buffer, nbytes, false);
-    nbytes -= total;
-    buffer += total;
+    wxUint32 total = 0;
+    while ( count && m_unread )
+    {
+        const wxUint32 ret = GetPushback(vec->buffer, vec->size, false);
+        total += ret;
+        SkipIOVecBytes(vec, count, ret);
+    }
 
-    while ( nbytes )
+    while ( count )
     {
         // our socket is non-blocking so Read() will return immediately if
         // there is nothing to read yet and it's more efficient to try it first
@@ -986,7 +1248,7 @@ wxUint32 wxSocketBase::DoRead(void* buffer_, wxUint32 nbytes)
         // where we're not going to get notifications about socket being ready
         // for reading before we read all the existing data from it
         const int ret = !m_impl->m_stream || m_connected
-                            ? m_impl->Read(buffer, nbytes)
+                            ? m_impl->ReadV(vec, count)
                             : 0;
         if ( ret == -1 )
         {
@@ -1041,8 +1303,7 @@ wxUint32 wxSocketBase::DoRead(void* buffer_, wxUint32 nbytes)
         if ( !(m_flags & wxSOCKET_WAITALL_READ) )
             break;
 
-        nbytes -= ret;
-        buffer += ret;
+        SkipIOVecBytes(vec, count, ret);
     }
 
     return total;
@@ -1084,12 +1345,27 @@ wxSocketBase& wxSocketBase::ReadMsg(void* buffer, wxUint32 nbytes)
             else
                 len2 = 0;
 
-            // Don't attempt to read if the msg was zero bytes long.
-            m_lcount_read = len ? DoRead(buffer, len) : 0;
-            m_lcount = m_lcount_read;
-
-            if ( len2 )
+            bool gotTrailer;
+            if ( !len2 )
+            {
+                // Read the message and the trailer following it at once,
+                // notice that the message buffer is simply skipped if the
+                // message is empty.
+                wxSocketIOVec vec[2];
+                vec[0] = wxSocketIOVec(buffer, len);
+                vec[1] = wxSocketIOVec(&msg, sizeof(msg));
+
+                const wxUint32 total = DoReadV(vec, WXSIZEOF(vec));
+                m_lcount_read = wxMin(total, len);
+                m_lcount = m_lcount_read;
+
+                gotTrailer = total == len + sizeof(msg);
+            }
+            else
             {
+                m_lcount_read = len ? DoRead(buffer, len) : 0;
+                m_lcount = m_lcount_read;
+
                 char discard_buffer[MAX_DISCARD_SIZE];
                 long discard_len;
 
@@ -1103,9 +1379,11 @@ wxSocketBase& wxSocketBase::ReadMsg(void* buffer, wxUint32 nbytes)
                     len2 -= (wxUint32)discard_len;
                 }
                 while ((discard_len > 0) && len2);
+
+                gotTrailer = !len2 && DoRead(&msg, sizeof(msg)) == sizeof(msg);
             }
 
-            if ( !len2 && DoRead(&msg, sizeof(msg)) == sizeof(msg) )
+            if ( gotTrailer )
             {
                 sig = (wxUint32)msg.sig[0];
                 sig |= (wxUint32)(msg.sig[1] << 8);
@@ -1148,18 +1426,107 @@ wxSocketBase& wxSocketBase::Write(const void *buffer, wxUint32 nbytes)
     return *this;
 }
 
-// This function is a mirror image of DoRead() except that it doesn't use the
+wxSocketBase& wxSocketBase::WriteV(const wxSocketIOVec *vec, int count)
+{
+    wxSocketWriteGuard write(this);
+
+    wxVector<wxSocketIOVec> buffers(vec, vec + count);
+    m_lcount_write = count ? DoWriteV(&buffers[0], count) : 0;
+    m_lcount = m_lcount_write;
+
+    return *this;
+}
+
+wxUint32 wxSocketBase::DoWrite(const void *buffer, wxUint32 nbytes)
+{
+    wxCHECK_MSG( buffer, 0, "NULL buffer" );
+
+    wxSocketIOVec vec(buffer, nbytes);
+    return DoWriteV(&vec, 1);
+}
+
+wxUint32 wxSocketBase::DoWriteV(wxSocketIOVec *vec, int count)
+{
+    // Datagrams can't be combined, so buffering only applies to the streams.
+    if ( !m_writeBuffering || !m_impl || !m_impl->m_stream )
+        return DoSendV(vec, count);
+
+    if ( !m_connected )
+    {
+        SetError(wxSOCKET_IOERR);
+        return 0;
+    }
+
+    const wxUint32 nbytes = GetIOVecSize(vec, count);
+    const wxUint32 buffered = m_writeBuffer.GetDataLen();
+
+    if ( buffered + nbytes < WRITE_BUFFER_SIZE )
+    {
+        for ( int n = 0; n < count; n++ )
+            m_writeBuffer.AppendData(vec[n].buffer, vec[n].size);
+
+        SetError(wxSOCKET_NOERROR);
+        return nbytes;
+    }
+
+    // Send the buffered data together with the new data without copying the
+    // latter into the buffer.
+    wxVector<wxSocketIOVec> buffers;
+    buffers.reserve(count + 1);
+    buffers.push_back(wxSocketIOVec(m_writeBuffer.GetData(), buffered));
+    for ( int n = 0; n < count; n++ )
+        buffers.push_back(vec[n]);
+
+    wxUint32 sent;
+    {
+        // Don't block if we were asked not to do it, but otherwise send all
+        // the data as the caller expects us to take care of it.
+        wxSocketWaitModeChanger changeFlags(this,
+                                            m_flags & wxSOCKET_NOWAIT_WRITE
+                                                ? wxSOCKET_NOWAIT_WRITE
+                                                : wxSOCKET_WAITALL_WRITE);
+
+        sent = DoSendV(&buffers[0], buffers.size());
+    }
+
+    if ( sent < buffered )
+    {
+        ConsumeWriteBuffer(sent);
+        sent = 0;
+    }
+    else
+    {
+        m_writeBuffer.Clear();
+        sent -= buffered;
+    }
+
+    // If we couldn't send everything just because the socket is not ready for
+    // writing yet, keep the rest of the data in the buffer.
+    const wxSocketError error = LastError();
+    if ( error == wxSOCKET_NOERROR || error == wxSOCKET_WOULDBLOCK )
+    {
+        SkipIOVecBytes(vec, count, sent);
+        for ( int n = 0; n < count; n++ )
+            m_writeBuffer.AppendData(vec[n].buffer, vec[n].size);
+
+        SetError(wxSOCKET_NOERROR);
+        return nbytes;
+    }
+
+    return sent;
+}
+
+// This function is a mirror image of DoReadV() except that it doesn't use the
 // push back buffer and doesn't treat 0 return value specially (normally this
 // shouldn't happen at all here), so please see comments there for explanations
-wxUint32 wxSocketBase::DoWrite(const void *buffer_, wxUint32 nbytes)
+wxUint32 wxSocketBase::DoSendV(wxSocketIOVec *vec, int count)
 {
     wxCHECK_MSG( m_impl, 0, "socket must be valid" );
 
-    const char *buffer = static_cast<const char *>(buffer_);
-    wxCHECK_MSG( buffer, 0, "NULL buffer" );
+    SkipIOVecBytes(vec, count, 0);
 
     wxUint32 total = 0;
-    while ( nbytes )
+    while ( count )
     {
         if ( m_impl->m_stream && !m_connected )
         {
@@ -1168,7 +1535,7 @@ wxUint32 wxSocketBase::DoWrite(const void *buffer_, wxUint32 nbytes)
             break;
         }
 
-        const int ret = m_impl->Write(buffer, nbytes);
+        const int ret = m_impl->WriteV(vec, count);
         if ( ret == -1 )
         {
             if ( m_impl->GetLastError() == wxSOCKET_WOULDBLOCK )
@@ -1196,20 +1563,59 @@ wxUint32 wxSocketBase::DoWrite(const void *buffer_, wxUint32 nbytes)
         if ( !(m_flags & wxSOCKET_WAITALL_WRITE) )
             break;
 
-        nbytes -= ret;
-        buffer += ret;
+        SkipIOVecBytes(vec, count, ret);
     }
 
     return total;
 }
 
+void wxSocketBase::ConsumeWriteBuffer(wxUint32 nbytes)
+{
+    const wxUint32 left = m_writeBuffer.GetDataLen() - nbytes;
+    if ( left )
+    {
+        char * const data = static_cast<char *>(m_writeBuffer.GetData());
+        memmove(data, data + nbytes, left);
+    }
+
+    m_writeBuffer.SetDataLen(left);
+}
+
+void wxSocketBase::SetWriteBuffering(bool buffer)
+{
+    if ( buffer )
+        m_writeBuffer.SetBufSize(WRITE_BUFFER_SIZE);
+    else
+        Flush();
+
+    m_writeBuffering = buffer;
+}
+
+bool wxSocketBase::Flush()
+{
+    if ( m_writeBuffer.IsEmpty() )
+        return true;
+
+    wxSocketWriteGuard write(this);
+
+    wxSocketWaitModeChanger changeFlags(this,
+                                        m_flags & wxSOCKET_NOWAIT_WRITE
+                                            ? wxSOCKET_NOWAIT_WRITE
+                                            : wxSOCKET_WAITALL_WRITE);
+
+    wxSocketIOVec vec(m_writeBuffer.GetData(), m_writeBuffer.GetDataLen());
+    ConsumeWriteBuffer(DoSendV(&vec, 1));
+
+    return m_writeBuffer.IsEmpty();
+}
+
 wxSocketBase& wxSocketBase::WriteMsg(const void *buffer, wxUint32 nbytes)
 {
     struct
     {
         unsigned char sig[4];
         unsigned char len[4];
-    } msg;
+    } msg, trailer;
 
     wxSocketWriteGuard write(this);
 
@@ -1225,28 +1631,28 @@ wxSocketBase& wxSocketBase::WriteMsg(const void *buffer, wxUint32 nbytes)
     msg.len[2] = (unsigned char) ((nbytes >> 16) & 0xff);
     msg.len[3] = (unsigned char) ((nbytes >> 24) & 0xff);
 
-    bool ok = false;
-    if ( DoWrite(&msg, sizeof(msg)) == sizeof(msg) )
-    {
-        m_lcount_write = DoWrite(buffer, nbytes);
-        m_lcount = m_lcount_write;
-        if ( m_lcount_write == nbytes )
-        {
-            msg.sig[0] = (unsigned char) 0xed;
-            msg.sig[1] = (unsigned char) 0xfe;
-            msg.sig[2] = (unsigned char) 0xad;
-            msg.sig[3] = (unsigned char) 0xde;
-            msg.len[0] =
-            msg.len[1] =
-            msg.len[2] =
-            msg.len[3] = (char) 0;
-
-            if ( DoWrite(&msg, sizeof(msg)) == sizeof(msg))
-                ok = true;
-        }
-    }
+    trailer.sig[0] = (unsigned char) 0xed;
+    trailer.sig[1] = (unsigned char) 0xfe;
+    trailer.sig[2] = (unsigned char) 0xad;
+    trailer.sig[3] = (unsigned char) 0xde;
+    trailer.len[0] =
+    trailer.len[1] =
+    trailer.len[2] =
+    trailer.len[3] = (char) 0;
+
+    // Send the header, the message and the trailer in a single call.
+    wxSocketIOVec vec[3];
+    vec[0] = wxSocketIOVec(&msg, sizeof(msg));
+    vec[1] = wxSocketIOVec(buffer, nbytes);
+    vec[2] = wxSocketIOVec(&trailer, sizeof(trailer));
+
+    const wxUint32 total = DoWriteV(vec, WXSIZEOF(vec));
+
+    m_lcount_write = total > sizeof(msg) ? wxMin(total - sizeof(msg), nbytes)
+                                         : 0;
+    m_lcount = m_lcount_write;
 
-    if ( !ok )
+    if ( total != sizeof(msg) + nbytes + sizeof(trailer) )
         SetError(wxSOCKET_IOERR);
 
     return *this;
@@ -122,6 +122,8 @@ static size_t decode_utf16(const wxUint16* input, wxUint32& output)
     }
 }
 
+#ifdef WC_UTF16
+
 // returns the next UTF-32 character from the wchar_t buffer and advances the
 // pointer to the character after this one
 //
@@ -140,6 +142,8 @@ static wxUint32 wxDecodeSurrogate(const wxChar16 **pSrc)
     return out;
 }
 
+#endif // WC_UTF16
+
 // ----------------------------------------------------------------------------
 // wxMBConv
 // ----------------------------------------------------------------------------
@@ -972,6 +976,31 @@ const unsigned char tableUtf8Lengths[256] = {
                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0   // F5..FF
 };
 
+// return the number of ASCII characters at the start of the given buffer
+static size_t GetASCIIPrefixLength(const char *src, size_t srcLen)
+{
+    const char *p = src;
+    const char * const end = src + srcLen;
+
+    // check as many bytes as fit into a word at once first: this is much
+    // faster for the long ASCII strings which are very common in practice
+    const size_t highBits = ~(size_t)0 / 0xff * 0x80;
+    while ( (size_t)(end - p) >= sizeof(size_t) )
+    {
+        size_t word;
+        memcpy(&word, p, sizeof(word));
+        if ( word & highBits )
+            break;
+
+        p += sizeof(size_t);
+    }
+
+    while ( p != end && !(*p & 0x80) )
+        p++;
+
+    return p - src;
+}
+
 size_t
 wxMBConvStrictUTF8::ToWChar(wchar_t *dst, size_t dstLen,
                             const char *src, size_t srcLen) const
@@ -984,6 +1013,28 @@ wxMBConvStrictUTF8::ToWChar(wchar_t *dst, size_t dstLen,
 
     for ( const char *p = src; ; p++ )
     {
+        // convert all ASCII characters, if any, at once as they're trivial to
+        // convert and it is much faster than doing it one by one below
+        size_t ascii = GetASCIIPrefixLength(p, srcLen);
+        if ( ascii )
+        {
+            if ( out )
+            {
+                if ( ascii > dstLen )
+                    ascii = dstLen;
+
+                for ( size_t n = 0; n < ascii; n++ )
+                    out[n] = (unsigned char)p[n];
+
+                out += ascii;
+                dstLen -= ascii;
+            }
+
+            p += ascii;
+            srcLen -= ascii;
+            written += ascii;
+        }
+
         if ( (srcLen == wxNO_LEN ? !*p : !srcLen) )
         {
             // all done successfully, just add the trailing NULL if we are not
@@ -1096,6 +1147,39 @@ wxMBConvStrictUTF8::FromWChar(char *dst, size_t dstLen,
 
     for ( const wchar_t *wp = src; ; wp++ )
     {
+        // as in ToWChar(), handle all ASCII characters at once first
+        size_t ascii = 0;
+        if ( srcLen == wxNO_LEN )
+        {
+            while ( wp[ascii] && (wxUint32)wp[ascii] < 0x80 )
+                ascii++;
+        }
+        else
+        {
+            while ( ascii < srcLen && (wxUint32)wp[ascii] < 0x80 )
+                ascii++;
+        }
+
+        if ( ascii )
+        {
+            if ( out )
+            {
+                if ( ascii > dstLen )
+                    ascii = dstLen;
+
+                for ( size_t n = 0; n < ascii; n++ )
+                    out[n] = (char)wp[n];
+
+                out += ascii;
+                dstLen -= ascii;
+            }
+
+            wp += ascii;
+            if ( srcLen != wxNO_LEN )
+                srcLen -= ascii;
+            written += ascii;
+        }
+
         if ( (srcLen == wxNO_LEN ? !*wp : !srcLen) )
         {
             // all done successfully, just add the trailing NULL if we are not
@@ -1631,68 +1715,172 @@ wxMBConvUTF16swap::FromWChar(char *dst, size_t dstLen,
 #else // !WC_UTF16: wchar_t is UTF-32
 
 // ----------------------------------------------------------------------------
-// conversions without endianness change
+// helpers for the conversions in both byte orders
 // ----------------------------------------------------------------------------
 
-size_t
-wxMBConvUTF16straight::ToWChar(wchar_t *dst, size_t dstLen,
-                               const char *src, size_t srcLen) const
+// The vast majority of the text only uses the characters from the BMP, so the
+// functions below first check whether the next chunk of input consists only
+// of them and, if it does, convert it with a simple loop without any branches
+// which can be vectorized by the compiler. Otherwise the characters of this
+// chunk are converted one by one.
+//
+// The byte order is a template parameter to allow the compiler to generate
+// the optimal code for both of them.
+static const size_t UTF16_CHUNK_LEN = 16;
+
+template <bool swap>
+static inline wxUint16 GetUTF16(wxUint16 ch)
 {
-    srcLen = GetLength(src, srcLen);
-    if ( srcLen == wxNO_LEN )
-        return wxCONV_FAILED;
+    return swap ? wxUINT16_SWAP_ALWAYS(ch) : ch;
+}
 
-    const size_t inLen = srcLen / BYTES_PER_CHAR;
+// check if the chunk of UTF-16 characters doesn't contain any surrogates:
+// notice that we don't need to swap the bytes to check for this
+template <bool swap>
+static inline bool HasNoUTF16Surrogates(const wxUint16 *src)
+{
+    const wxUint16 mask = swap ? 0x00f8 : 0xf800;
+    const wxUint16 surrogate = swap ? 0x00d8 : 0xd800;
+
+    // count the surrogates instead of stopping at the first one as this loop
+    // is much faster when vectorized
+    unsigned found = 0;
+    for ( size_t n = 0; n < UTF16_CHUNK_LEN; n++ )
+        found += (src[n] & mask) == surrogate;
+
+    return !found;
+}
+
+template <bool swap>
+static size_t
+DecodeUTF16(wchar_t *dst, size_t dstLen, const wxUint16 *src, size_t srcLen)
+{
     size_t outLen = 0;
-    const wxUint16 *inBuff = reinterpret_cast<const wxUint16 *>(src);
-    for ( const wxUint16 * const inEnd = inBuff + inLen; inBuff < inEnd; )
+    for ( const wxUint16 * const srcEnd = src + srcLen; src < srcEnd; )
     {
-        const wxUint32 ch = wxDecodeSurrogate(&inBuff);
-        if ( !inBuff )
-            return wxCONV_FAILED;
+        const size_t chunkLen = wxMin(UTF16_CHUNK_LEN, size_t(srcEnd - src));
+        if ( chunkLen == UTF16_CHUNK_LEN && HasNoUTF16Surrogates<swap>(src) )
+        {
+            outLen += UTF16_CHUNK_LEN;
+            if ( dst )
+            {
+                if ( outLen > dstLen )
+                    return wxCONV_FAILED;
 
-        outLen++;
+                for ( size_t n = 0; n < UTF16_CHUNK_LEN; n++ )
+                    dst[n] = GetUTF16<swap>(src[n]);
 
-        if ( dst )
+                dst += UTF16_CHUNK_LEN;
+            }
+
+            src += UTF16_CHUNK_LEN;
+            continue;
+        }
+
+        for ( const wxUint16 * const chunkEnd = src + chunkLen;
+              src < chunkEnd; )
         {
-            if ( outLen > dstLen )
+            wxUint32 ch;
+            wxUint16 tmp[2];
+
+            tmp[0] = GetUTF16<swap>(*src);
+            if ( ++src < srcEnd )
+            {
+                // Normal case, we have a next character to decode.
+                tmp[1] = GetUTF16<swap>(*src);
+            }
+            else // End of input.
+            {
+                // Setting the second character to 0 ensures we correctly
+                // return wxCONV_FAILED if the first one is the first half of
+                // a surrogate as the second half can't be 0 in this case.
+                tmp[1] = 0;
+            }
+
+            const size_t numChars = decode_utf16(tmp, ch);
+            if ( numChars == wxCONV_FAILED )
                 return wxCONV_FAILED;
 
-            *dst++ = ch;
+            if ( numChars == 2 )
+                src++;
+
+            outLen++;
+
+            if ( dst )
+            {
+                if ( outLen > dstLen )
+                    return wxCONV_FAILED;
+
+                *dst++ = ch;
+            }
         }
     }
 
-
     return outLen;
 }
 
-size_t
-wxMBConvUTF16straight::FromWChar(char *dst, size_t dstLen,
-                                 const wchar_t *src, size_t srcLen) const
+// check if all the characters of the chunk can be represented by a single UTF-16
+// character
+static inline bool IsUTF16BMP(const wchar_t *src)
 {
-    if ( srcLen == wxNO_LEN )
-        srcLen = wxWcslen(src) + 1;
+    wxUint32 all = 0;
+    for ( size_t n = 0; n < UTF16_CHUNK_LEN; n++ )
+        all |= static_cast<wxUint32>(src[n]);
+
+    return all <= 0xffff;
+}
+
+template <bool swap>
+static size_t
+EncodeUTF16(wxUint16 *dst, size_t dstLen, const wchar_t *src, size_t srcLen)
+{
+    // notice that, unlike the input length, dstLen and the return value are
+    // in bytes and not characters
+    const size_t BYTES_PER_CHAR = wxMBConvUTF16Base::BYTES_PER_CHAR;
 
     size_t outLen = 0;
-    wxUint16 *outBuff = reinterpret_cast<wxUint16 *>(dst);
-    for ( size_t n = 0; n < srcLen; n++ )
+    for ( const wchar_t * const srcEnd = src + srcLen; src < srcEnd; )
     {
-        wxUint16 cc[2] = { 0 };
-        const size_t numChars = encode_utf16(*src++, cc);
-        if ( numChars == wxCONV_FAILED )
-            return wxCONV_FAILED;
+        const size_t chunkLen = wxMin(UTF16_CHUNK_LEN, size_t(srcEnd - src));
+        if ( chunkLen == UTF16_CHUNK_LEN && IsUTF16BMP(src) )
+        {
+            outLen += UTF16_CHUNK_LEN * BYTES_PER_CHAR;
+            if ( dst )
+            {
+                if ( outLen > dstLen )
+                    return wxCONV_FAILED;
 
-        outLen += numChars * BYTES_PER_CHAR;
-        if ( outBuff )
+                for ( size_t n = 0; n < UTF16_CHUNK_LEN; n++ )
+                    dst[n] = GetUTF16<swap>(static_cast<wxUint16>(src[n]));
+
+                dst += UTF16_CHUNK_LEN;
+            }
+
+            src += UTF16_CHUNK_LEN;
+            continue;
+        }
+
+        for ( const wchar_t * const chunkEnd = src + chunkLen;
+              src < chunkEnd;
+              src++ )
         {
-            if ( outLen > dstLen )
+            wxUint16 cc[2] = { 0 };
+            const size_t numChars = encode_utf16(*src, cc);
+            if ( numChars == wxCONV_FAILED )
                 return wxCONV_FAILED;
 
-            *outBuff++ = cc[0];
-            if ( numChars == 2 )
+            outLen += numChars * BYTES_PER_CHAR;
+            if ( dst )
             {
-                // second character of a surrogate
-                *outBuff++ = cc[1];
+                if ( outLen > dstLen )
+                    return wxCONV_FAILED;
+
+                *dst++ = GetUTF16<swap>(cc[0]);
+                if ( numChars == 2 )
+                {
+                    // second character of a surrogate
+                    *dst++ = GetUTF16<swap>(cc[1]);
+                }
             }
         }
     }
@@ -1701,59 +1889,48 @@ wxMBConvUTF16straight::FromWChar(char *dst, size_t dstLen,
 }
 
 // ----------------------------------------------------------------------------
-// endian-reversing conversions
+// conversions without endianness change
 // ----------------------------------------------------------------------------
 
 size_t
-wxMBConvUTF16swap::ToWChar(wchar_t *dst, size_t dstLen,
-                           const char *src, size_t srcLen) const
+wxMBConvUTF16straight::ToWChar(wchar_t *dst, size_t dstLen,
+                               const char *src, size_t srcLen) const
 {
     srcLen = GetLength(src, srcLen);
     if ( srcLen == wxNO_LEN )
         return wxCONV_FAILED;
 
-    const size_t inLen = srcLen / BYTES_PER_CHAR;
-    size_t outLen = 0;
-    const wxUint16 *inBuff = reinterpret_cast<const wxUint16 *>(src);
-    for ( const wxUint16 * const inEnd = inBuff + inLen; inBuff < inEnd; )
-    {
-        wxUint32 ch;
-        wxUint16 tmp[2];
-
-        tmp[0] = wxUINT16_SWAP_ALWAYS(*inBuff);
-        if ( ++inBuff < inEnd )
-        {
-            // Normal case, we have a next character to decode.
-            tmp[1] = wxUINT16_SWAP_ALWAYS(*inBuff);
-        }
-        else // End of input.
-        {
-            // Setting the second character to 0 ensures we correctly return
-            // wxCONV_FAILED if the first one is the first half of a surrogate
-            // as the second half can't be 0 in this case.
-            tmp[1] = 0;
-        }
-
-        const size_t numChars = decode_utf16(tmp, ch);
-        if ( numChars == wxCONV_FAILED )
-            return wxCONV_FAILED;
-
-        if ( numChars == 2 )
-            inBuff++;
+    return DecodeUTF16<false>(dst, dstLen,
+                              reinterpret_cast<const wxUint16 *>(src),
+                              srcLen / BYTES_PER_CHAR);
+}
 
-        outLen++;
+size_t
+wxMBConvUTF16straight::FromWChar(char *dst, size_t dstLen,
+                                 const wchar_t *src, size_t srcLen) const
+{
+    if ( srcLen == wxNO_LEN )
+        srcLen = wxWcslen(src) + 1;
 
-        if ( dst )
-        {
-            if ( outLen > dstLen )
-                return wxCONV_FAILED;
+    return EncodeUTF16<false>(reinterpret_cast<wxUint16 *>(dst), dstLen,
+                              src, srcLen);
+}
 
-            *dst++ = ch;
-        }
-    }
+// ----------------------------------------------------------------------------
+// endian-reversing conversions
+// ----------------------------------------------------------------------------
 
+size_t
+wxMBConvUTF16swap::ToWChar(wchar_t *dst, size_t dstLen,
+                           const char *src, size_t srcLen) const
+{
+    srcLen = GetLength(src, srcLen);
+    if ( srcLen == wxNO_LEN )
+        return wxCONV_FAILED;
 
-    return outLen;
+    return DecodeUTF16<true>(dst, dstLen,
+                             reinterpret_cast<const wxUint16 *>(src),
+                             srcLen / BYTES_PER_CHAR);
 }
 
 size_t
@@ -1763,31 +1940,8 @@ wxMBConvUTF16swap::FromWChar(char *dst, size_t dstLen,
     if ( srcLen == wxNO_LEN )
         srcLen = wxWcslen(src) + 1;
 
-    size_t outLen = 0;
-    wxUint16 *outBuff = reinterpret_cast<wxUint16 *>(dst);
-    for ( const wchar_t *srcEnd = src + srcLen; src < srcEnd; src++ )
-    {
-        wxUint16 cc[2] = { 0 };
-        const size_t numChars = encode_utf16(*src, cc);
-        if ( numChars == wxCONV_FAILED )
-            return wxCONV_FAILED;
-
-        outLen += numChars * BYTES_PER_CHAR;
-        if ( outBuff )
-        {
-            if ( outLen > dstLen )
-                return wxCONV_FAILED;
-
-            *outBuff++ = wxUINT16_SWAP_ALWAYS(cc[0]);
-            if ( numChars == 2 )
-            {
-                // second character of a surrogate
-                *outBuff++ = wxUINT16_SWAP_ALWAYS(cc[1]);
-            }
-        }
-    }
-
-    return outLen;
+    return EncodeUTF16<true>(reinterpret_cast<wxUint16 *>(dst), dstLen,
+                             src, srcLen);
 }
 
 #endif // WC_UTF16/!WC_UTF16
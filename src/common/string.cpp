@@ -273,6 +273,114 @@ void wxString::PosLenToImpl(size_t pos, size_t len,
     }
 }
 
+#if wxUSE_STRING_POS_CACHE
+
+// return true if the given byte starts a new character in UTF-8 string
+static inline bool IsUTF8LeadByte(char ch)
+{
+    return (static_cast<unsigned char>(ch) & 0xc0) != 0x80;
+}
+
+void wxString::SeekUsingPosIndex(Cache::Element *cache, size_t pos) const
+{
+    const char * const start = m_impl.data();
+    const size_t bytes = m_impl.length();
+
+    // only the last string accessed in this way is indexed, so start a new
+    // index if it was used for another one
+    Cache::PosIndex *pIndex = FindPosIndex();
+    if ( !pIndex )
+    {
+        pIndex = &GetCache().posIndex;
+        pIndex->Reset();
+        pIndex->str = this;
+
+        // choose the step for the index to cover the entire string, knowing
+        // that it can't have more characters than bytes
+        pIndex->step = bytes / Cache::PosIndex::SIZE + 1;
+        if ( pIndex->step < Cache::PosIndex::MIN_STEP )
+            pIndex->step = Cache::PosIndex::MIN_STEP;
+    }
+
+    Cache::PosIndex& index = *pIndex;
+
+    // the positions inside the ASCII prefix are the same in m_impl
+    if ( pos <= index.ascii )
+    {
+        cache->pos =
+        cache->impl = pos;
+        return;
+    }
+
+    if ( !index.hasNonASCII )
+    {
+        // extend the ASCII prefix, but not beyond the position we need
+        const size_t end = pos < bytes ? pos : bytes;
+        size_t n = index.ascii;
+        while ( n < end && !(static_cast<unsigned char>(start[n]) & 0x80) )
+            n++;
+
+        index.ascii = n;
+
+        if ( pos <= n )
+        {
+            cache->pos =
+            cache->impl = pos;
+            return;
+        }
+
+        if ( n == bytes )
+        {
+            // the position is beyond the end of the string, let the caller
+            // deal with it
+            return;
+        }
+
+        index.hasNonASCII = true;
+    }
+
+    const size_t base = index.ascii;
+    const size_t step = index.step;
+
+    // add the offsets up to the given position
+    while ( index.count < Cache::PosIndex::SIZE &&
+                base + (index.count + 1)*step <= pos )
+    {
+        // find the start of the character step positions after the last
+        // offset, this may be the end of the string itself
+        size_t n = index.count ? index.offsets[index.count - 1] : base;
+        size_t chars = 0;
+        for ( ; n < bytes; n++ )
+        {
+            if ( IsUTF8LeadByte(start[n]) )
+            {
+                if ( chars == step )
+                    break;
+
+                chars++;
+            }
+        }
+
+        if ( chars < step )
+            break;
+
+        index.offsets[index.count++] = n;
+    }
+
+    size_t k = (pos - base) / step;
+    if ( k > index.count )
+        k = index.count;
+
+    const size_t checkpoint = base + k*step;
+    if ( checkpoint > cache->pos )
+    {
+        cache->pos = checkpoint;
+        cache->impl = k ? index.offsets[k - 1] : base;
+    }
+}
+
+#endif // wxUSE_STRING_POS_CACHE
+
 #endif // wxUSE_UNICODE_UTF8
 
 // ----------------------------------------------------------------------------
@@ -391,6 +499,39 @@ wxString::SubstrBufFromMB wxString::ConvertStr(const char *psz, size_t nLength,
     else
         return SubstrBufFromMB(wcBuf, wcLen);
 }
+
+/* static */
+wxString wxString::FromUTF8(const char *utf8, size_t len)
+{
+    wxString str;
+    if ( !utf8 )
+        return str;
+
+    if ( len == npos )
+        len = strlen(utf8);
+
+    if ( !len )
+        return str;
+
+    // the number of bytes in UTF-8 string is always at least equal to the
+    // number of wide characters needed for it, so we can convert it directly
+    // into the string buffer in a single pass, without computing its length
+    // first and copying the result of the conversion
+    size_t wcLen;
+    {
+        wxStringBufferLength buf(str, len);
+        wcLen = wxMBConvStrictUTF8().ToWChar(buf, len, utf8, len);
+        if ( wcLen == wxCONV_FAILED )
+            wcLen = 0;
+        buf.SetLength(wcLen);
+    }
+
+    // don't waste too much memory if the string wasn't mostly ASCII
+    if ( wcLen < len / 2 )
+        str.Shrink();
+
+    return str;
+}
 #endif // wxUSE_UNICODE_WCHAR
 
 #if wxUSE_UNICODE_UTF8
@@ -483,21 +624,13 @@ const wchar_t *wxString::AsWChar(const wxMBConv& conv) const
     if ( lenWC == wxCONV_FAILED )
         return NULL;
 
-    // keep the same buffer if the string size didn't change: this is not only
-    // an optimization but also ensure that code which modifies string
-    // character by character (without changing its length) can continue to use
-    // the pointer returned by a previous wc_str() call even after changing the
+    // keep the same buffer if it is big enough: this is not only an
+    // optimization but also ensure that code which modifies string character
+    // by character (without changing its length) can continue to use the
+    // pointer returned by a previous wc_str() call even after changing the
     // string
-
-    // TODO-UTF8: we could check for ">" instead of "!=" here as this would
-    //            allow to save on buffer reallocations but at the cost of
-    //            consuming (even) more memory, we should benchmark this to
-    //            determine if it's worth doing
-    if ( !m_convertedToWChar.m_str || lenWC != m_convertedToWChar.m_len )
-    {
-        if ( !const_cast<wxString *>(this)->m_convertedToWChar.Extend(lenWC) )
-            return NULL;
-    }
+    if ( !const_cast<wxString *>(this)->m_convertedToWChar.Extend(lenWC) )
+        return NULL;
 
     // finally do convert
     m_convertedToWChar.m_str[lenWC] = L'\0';
@@ -534,11 +667,8 @@ const char *wxString::AsChar(const wxMBConv& conv) const
     if ( lenMB == wxCONV_FAILED )
         return NULL;
 
-    if ( !m_convertedToChar.m_str || lenMB != m_convertedToChar.m_len )
-    {
-        if ( !const_cast<wxString *>(this)->m_convertedToChar.Extend(lenMB) )
-            return NULL;
-    }
+    if ( !const_cast<wxString *>(this)->m_convertedToChar.Extend(lenMB) )
+        return NULL;
 
     m_convertedToChar.m_str[lenMB] = '\0';
     if ( conv.FromWChar(m_convertedToChar.m_str, lenMB,
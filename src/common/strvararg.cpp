@@ -607,6 +607,9 @@ const char* wxFormatString::InputAsChar()
 
 const char* wxFormatString::AsChar()
 {
+    if ( m_parsed )
+        return m_parsed->m_convertedChar.data();
+
     if ( !m_convertedChar )
 #if !wxUSE_UNICODE // FIXME-UTF8: remove this
         m_convertedChar = wxPrintfFormatConverterANSI().Convert(InputAsChar());
@@ -653,6 +656,9 @@ const wchar_t* wxFormatString::InputAsWChar()
 
 const wchar_t* wxFormatString::AsWChar()
 {
+    if ( m_parsed )
+        return m_parsed->m_convertedWChar.data();
+
     if ( !m_convertedWChar )
         m_convertedWChar = wxPrintfFormatConverterWchar().Convert(InputAsWChar());
 
@@ -664,6 +670,8 @@ wxString wxFormatString::InputAsString() const
 {
     if ( m_str )
         return *m_str;
+    if ( m_parsed )
+        return m_parsed->GetFormat();
     if ( m_cstr )
         return m_cstr->AsString();
     if ( m_wchar )
@@ -682,31 +690,9 @@ wxString wxFormatString::InputAsString() const
 namespace
 {
 
-template<typename CharType>
-wxFormatString::ArgumentType DoGetArgumentType(const CharType *format,
-                                               unsigned n)
+wxFormatString::ArgumentType ArgumentTypeFromSpec(wxPrintfArgType type)
 {
-    wxCHECK_MSG( format, wxFormatString::Arg_Unknown,
-                 "empty format string not allowed here" );
-
-    wxPrintfConvSpecParser<CharType> parser(format);
-
-    if ( n > parser.nargs )
-    {
-        // The n-th argument doesn't appear in the format string and is unused.
-        // This can happen e.g. if a translation of the format string is used
-        // and the translation language tends to avoid numbers in singular forms.
-        // The translator would then typically replace "%d" with "One" (e.g. in
-        // Hebrew). Passing too many vararg arguments does not harm, so its
-        // better to be more permissive here and allow legitimate uses in favour
-        // of catching harmless errors.
-        return wxFormatString::Arg_Unused;
-    }
-
-    wxCHECK_MSG( parser.pspec[n-1] != NULL, wxFormatString::Arg_Unknown,
-                 "requested argument not found - invalid format string?" );
-
-    switch ( parser.pspec[n-1]->m_type )
+    switch ( type )
     {
         case wxPAT_CHAR:
         case wxPAT_WCHAR:
@@ -756,11 +742,40 @@ wxFormatString::ArgumentType DoGetArgumentType(const CharType *format,
     return wxFormatString::Arg_Unknown;
 }
 
+template<typename CharType>
+wxFormatString::ArgumentType DoGetArgumentType(const CharType *format,
+                                               unsigned n)
+{
+    wxCHECK_MSG( format, wxFormatString::Arg_Unknown,
+                 "empty format string not allowed here" );
+
+    wxPrintfConvSpecParser<CharType> parser(format);
+
+    if ( n > parser.nargs )
+    {
+        // The n-th argument doesn't appear in the format string and is unused.
+        // This can happen e.g. if a translation of the format string is used
+        // and the translation language tends to avoid numbers in singular forms.
+        // The translator would then typically replace "%d" with "One" (e.g. in
+        // Hebrew). Passing too many vararg arguments does not harm, so its
+        // better to be more permissive here and allow legitimate uses in favour
+        // of catching harmless errors.
+        return wxFormatString::Arg_Unused;
+    }
+
+    wxCHECK_MSG( parser.pspec[n-1] != NULL, wxFormatString::Arg_Unknown,
+                 "requested argument not found - invalid format string?" );
+
+    return ArgumentTypeFromSpec(parser.pspec[n-1]->m_type);
+}
+
 } // anonymous namespace
 
 wxFormatString::ArgumentType wxFormatString::GetArgumentType(unsigned n) const
 {
-    if ( m_char )
+    if ( m_parsed )
+        return m_parsed->GetArgumentType(n);
+    else if ( m_char )
         return DoGetArgumentType(m_char.data(), n);
     else if ( m_wchar )
         return DoGetArgumentType(m_wchar.data(), n);
@@ -772,3 +787,66 @@ wxFormatString::ArgumentType wxFormatString::GetArgumentType(unsigned n) const
     wxFAIL_MSG( "unreachable code" );
     return Arg_Unknown;
 }
+
+// ----------------------------------------------------------------------------
+// wxParsedFormatString
+// ----------------------------------------------------------------------------
+
+wxParsedFormatString::wxParsedFormatString(const char *format)
+    : m_format(format)
+{
+    Init();
+}
+
+wxParsedFormatString::wxParsedFormatString(const wchar_t *format)
+    : m_format(format)
+{
+    Init();
+}
+
+wxParsedFormatString::wxParsedFormatString(const wxString& format)
+    : m_format(format)
+{
+    Init();
+}
+
+void wxParsedFormatString::Init()
+{
+    // notice that we need to copy the converted strings as they may be owned
+    // by the temporary object
+    wxFormatString fmt(m_format);
+#if !wxUSE_UNICODE_WCHAR
+    m_convertedChar = wxCharBuffer(fmt.AsChar());
+#endif
+#if wxUSE_UNICODE && !wxUSE_UTF8_LOCALE_ONLY
+    m_convertedWChar = wxWCharBuffer(fmt.AsWChar());
+#endif
+
+    wxPrintfConvSpecParser<wxStringCharType> parser(m_format.wx_str());
+
+    m_argCount = parser.nargs;
+    m_argTypes = new wxFormatString::ArgumentType[m_argCount];
+    for ( unsigned n = 0; n < m_argCount; n++ )
+    {
+        // don't assert about the missing arguments here, this will be done
+        // when (and if) they're actually used, just as without this class
+        const wxPrintfConvSpec<wxStringCharType> * const spec = parser.pspec[n];
+        m_argTypes[n] = spec ? ArgumentTypeFromSpec(spec->m_type)
+                             : wxFormatString::Arg_Unknown;
+    }
+}
+
+wxParsedFormatString::~wxParsedFormatString()
+{
+    delete [] m_argTypes;
+}
+
+wxFormatString::ArgumentType
+wxParsedFormatString::GetArgumentType(unsigned n) const
+{
+    // see the comment in DoGetArgumentType() for why this is not an error
+    if ( n > m_argCount )
+        return wxFormatString::Arg_Unused;
+
+    return m_argTypes[n - 1];
+}
@@ -0,0 +1,604 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        src/common/threadpool.cpp
+// Purpose:     wxThreadPool and related classes implementation
+// Author:      wxWidgets team
+// Created:     2018-10-18
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+// ============================================================================
+// declarations
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// headers
+// ----------------------------------------------------------------------------
+
+// for compilers that support precompilation, includes "wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+#if wxUSE_THREADS
+
+#include "wx/threadpool.h"
+
+#ifndef WX_PRECOMP
+    #include "wx/app.h"
+    #include "wx/module.h"
+    #include "wx/thread.h"
+#endif // WX_PRECOMP
+
+#include "wx/tls.h"
+#include "wx/vector.h"
+
+// ----------------------------------------------------------------------------
+// private classes
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// A double-ended queue of tasks protected by its own lock: the thread owning
+// it adds and removes the tasks at its back while the other threads steal them
+// from its front.
+class wxTaskDeque
+{
+public:
+    wxTaskDeque()
+    {
+        m_first =
+        m_count = 0;
+    }
+
+    void PushBack(wxThreadPoolTask *task)
+    {
+        wxMutexLocker lock(m_mutex);
+
+        if ( m_count == m_tasks.size() )
+            Grow();
+
+        m_tasks[(m_first + m_count) % m_tasks.size()] = task;
+        m_count++;
+    }
+
+    wxThreadPoolTask *PopBack()
+    {
+        wxMutexLocker lock(m_mutex);
+
+        if ( !m_count )
+            return NULL;
+
+        m_count--;
+
+        return m_tasks[(m_first + m_count) % m_tasks.size()];
+    }
+
+    wxThreadPoolTask *PopFront()
+    {
+        wxMutexLocker lock(m_mutex);
+
+        if ( !m_count )
+            return NULL;
+
+        wxThreadPoolTask * const task = m_tasks[m_first];
+        m_first = (m_first + 1) % m_tasks.size();
+        m_count--;
+
+        return task;
+    }
+
+private:
+    void Grow()
+    {
+        wxVector<wxThreadPoolTask *> tasks(m_count ? 2*m_count : 16);
+        for ( size_t n = 0; n < m_count; n++ )
+            tasks[n] = m_tasks[(m_first + n) % m_tasks.size()];
+
+        m_tasks.swap(tasks);
+        m_first = 0;
+    }
+
+    wxMutex m_mutex;
+
+    // This is used as a circular buffer containing m_count tasks starting at
+    // m_first index.
+    wxVector<wxThreadPoolTask *> m_tasks;
+    size_t m_first,
+           m_count;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskDeque);
+};
+
+class wxThreadPoolWorker : public wxThread
+{
+public:
+    wxThreadPoolWorker(wxThreadPoolImpl& impl, size_t index)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_impl(impl),
+          m_index(index)
+    {
+    }
+
+    wxThreadPoolImpl& GetImpl() const { return m_impl; }
+    size_t GetIndex() const { return m_index; }
+
+    wxTaskDeque& GetTasks() { return m_tasks; }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE;
+
+private:
+    wxThreadPoolImpl& m_impl;
+    const size_t m_index;
+
+    wxTaskDeque m_tasks;
+
+    wxDECLARE_NO_COPY_CLASS(wxThreadPoolWorker);
+};
+
+// The worker running in the current thread, if any.
+inline wxTLS_TYPE_REF(wxThreadPoolWorker*) GetThisThreadWorker()
+{
+    static wxTLS_TYPE(wxThreadPoolWorker*) s_thisThreadWorker;
+
+    return s_thisThreadWorker;
+}
+
+#define wxTHIS_THREAD_WORKER wxTLS_VALUE(GetThisThreadWorker())
+
+// Functor used with CallAfter() for calling wxThreadPoolTask::OnDone().
+class wxThreadPoolDoneNotifier
+{
+public:
+    explicit wxThreadPoolDoneNotifier(wxThreadPoolTask *task)
+        : m_task(task)
+    {
+        task->IncRef();
+    }
+
+    void operator()() const { m_task->OnDone(); }
+
+private:
+    wxThreadPoolTaskPtr m_task;
+};
+
+// Check if the counter of pending tasks is 0 using atomic operations: unlike a
+// simple comparison, this ensures that all the changes done by the tasks
+// before decrementing it are visible in the current thread.
+inline bool IsZero(wxAtomicInt& counter)
+{
+    wxAtomicInc(counter);
+    return wxAtomicDec(counter) == 0;
+}
+
+wxThreadPool *gs_defaultPool = NULL;
+wxCriticalSection gs_defaultPoolCS;
+
+} // anonymous namespace
+
+class wxThreadPoolImpl
+{
+public:
+    explicit wxThreadPoolImpl(int numThreads);
+    ~wxThreadPoolImpl();
+
+    // Add a task to the queue of the current thread if it's one of our
+    // workers or to the shared queue otherwise.
+    void Push(wxThreadPoolTask *task);
+
+    // Take the next task to run in the thread of the given worker, which may
+    // be NULL if it's not one of the pool threads: this is either the last
+    // task added to its own queue or the first one of the shared queue or of
+    // one of the other threads queues.
+    wxThreadPoolTask *Pop(wxThreadPoolWorker *worker);
+
+    // Return the worker running in this thread or NULL if it doesn't belong
+    // to this pool.
+    wxThreadPoolWorker *GetCurrentWorker() const
+    {
+        wxThreadPoolWorker * const worker = wxTHIS_THREAD_WORKER;
+        return worker && &worker->GetImpl() == this ? worker : NULL;
+    }
+
+    // Run the task, unless it's cancelled, and release it.
+    void Execute(wxThreadPoolTask *task);
+
+    // Block until either the counter becomes 0 or a new task is queued.
+    void WaitForChange(const wxAtomicInt& pending);
+
+    // The function executed by all workers.
+    void WorkerMain(wxThreadPoolWorker *worker);
+
+private:
+    wxVector<wxThreadPoolWorker *> m_workers;
+
+    // The number of workers which were successfully started, normally the
+    // same as the total number of them.
+    size_t m_numRunning;
+
+    // The queue used for the tasks queued by the threads outside of the pool.
+    wxTaskDeque m_shared;
+
+    // The total number of tasks in all the queues.
+    wxAtomicInt m_numQueued;
+
+    // The workers without anything to do wait for m_wakeUp.
+    wxMutex m_sleepMutex;
+    wxCondition m_wakeUp;
+    wxAtomicInt m_numSleeping;
+
+    // The threads waiting for some tasks to finish wait for m_changed.
+    wxMutex m_changeMutex;
+    wxCondition m_changed;
+    wxAtomicInt m_numWaiting;
+
+    wxAtomicInt m_stopping;
+
+    wxDECLARE_NO_COPY_CLASS(wxThreadPoolImpl);
+};
+
+// ============================================================================
+// wxThreadPoolImpl implementation
+// ============================================================================
+
+wxThread::ExitCode wxThreadPoolWorker::Entry()
+{
+    wxTHIS_THREAD_WORKER = this;
+
+    m_impl.WorkerMain(this);
+
+    return 0;
+}
+
+wxThreadPoolImpl::wxThreadPoolImpl(int numThreads)
+    : m_wakeUp(m_sleepMutex),
+      m_changed(m_changeMutex)
+{
+    m_numQueued =
+    m_numSleeping =
+    m_numWaiting =
+    m_stopping = 0;
+
+    // Create all workers before starting any of them as they access
+    // m_workers when stealing tasks.
+    int n;
+    for ( n = 0; n < numThreads; n++ )
+        m_workers.push_back(new wxThreadPoolWorker(*this, n));
+
+    m_numRunning = 0;
+    for ( n = 0; n < numThreads; n++ )
+    {
+        if ( m_workers[n]->Run() != wxTHREAD_NO_ERROR )
+            break;
+
+        m_numRunning++;
+    }
+}
+
+wxThreadPoolImpl::~wxThreadPoolImpl()
+{
+    {
+        wxMutexLocker lock(m_sleepMutex);
+        wxAtomicInc(m_stopping);
+        m_wakeUp.Broadcast();
+    }
+
+    size_t n;
+    for ( n = 0; n < m_numRunning; n++ )
+        m_workers[n]->Wait();
+
+    // Discard all the tasks which haven't started yet, but do it properly to
+    // avoid blocking any threads waiting for them.
+    wxThreadPoolTask *task;
+    while ( (task = Pop(NULL)) != NULL )
+    {
+        task->Cancel();
+        Execute(task);
+    }
+
+    for ( n = 0; n < m_workers.size(); n++ )
+        delete m_workers[n];
+}
+
+void wxThreadPoolImpl::Push(wxThreadPoolTask *task)
+{
+    if ( !m_numRunning )
+    {
+        // We couldn't create any threads, so just run the task immediately.
+        Execute(task);
+        return;
+    }
+
+    wxThreadPoolWorker * const worker = GetCurrentWorker();
+    if ( worker )
+        worker->GetTasks().PushBack(task);
+    else
+        m_shared.PushBack(task);
+
+    // Notice that the order of the operations here and in WorkerMain() and
+    // WaitForChange() is important: as we increment the number of tasks
+    // before checking the number of the sleeping threads, while they do it in
+    // the opposite order, either we see that they're sleeping and wake them
+    // up or they see the new task and don't go to sleep.
+    wxAtomicInc(m_numQueued);
+
+    if ( m_numSleeping )
+    {
+        wxMutexLocker lock(m_sleepMutex);
+        m_wakeUp.Signal();
+    }
+
+    if ( m_numWaiting )
+    {
+        wxMutexLocker lock(m_changeMutex);
+        m_changed.Broadcast();
+    }
+}
+
+wxThreadPoolTask *wxThreadPoolImpl::Pop(wxThreadPoolWorker *worker)
+{
+    if ( !m_numQueued )
+        return NULL;
+
+    wxThreadPoolTask *task = worker ? worker->GetTasks().PopBack() : NULL;
+    if ( !task )
+        task = m_shared.PopFront();
+
+    if ( !task )
+    {
+        // Steal a task from another worker, starting with the next one to
+        // avoid all threads trying to steal from the same one.
+        const size_t count = m_workers.size();
+        const size_t start = worker ? worker->GetIndex() + 1 : 0;
+        for ( size_t n = 0; n < count && !task; n++ )
+        {
+            wxThreadPoolWorker * const other = m_workers[(start + n) % count];
+            if ( other != worker )
+                task = other->GetTasks().PopFront();
+        }
+
+        if ( !task )
+            return NULL;
+    }
+
+    wxAtomicDec(m_numQueued);
+
+    return task;
+}
+
+void wxThreadPoolImpl::Execute(wxThreadPoolTask *task)
+{
+    const bool run = !task->IsCancelled();
+    if ( run )
+        task->Run();
+
+    wxTaskGroup * const group = task->m_group;
+    if ( group )
+    {
+        // The group can be destroyed as soon as its last task is done, so
+        // don't keep a pointer to it and remember its cancellation state.
+        if ( group->IsCancelled() )
+            task->Cancel();
+
+        task->m_group = NULL;
+    }
+
+    wxAtomicDec(task->m_pending);
+    if ( group )
+        wxAtomicDec(group->m_pending);
+
+    // Only notify about the task completion after updating the counters, so
+    // that IsDone() already returns true when OnDone() is called.
+#ifdef wxHAS_CALL_AFTER
+    if ( run && task->m_notifyDone && wxTheApp )
+        wxTheApp->CallAfter(wxThreadPoolDoneNotifier(task));
+#endif // wxHAS_CALL_AFTER
+
+    if ( m_numWaiting )
+    {
+        wxMutexLocker lock(m_changeMutex);
+        m_changed.Broadcast();
+    }
+
+    task->DecRef();
+}
+
+void wxThreadPoolImpl::WaitForChange(const wxAtomicInt& pending)
+{
+    wxMutexLocker lock(m_changeMutex);
+
+    wxAtomicInc(m_numWaiting);
+
+    if ( pending && !m_numQueued )
+        m_changed.Wait();
+
+    wxAtomicDec(m_numWaiting);
+}
+
+void wxThreadPoolImpl::WorkerMain(wxThreadPoolWorker *worker)
+{
+    while ( !m_stopping )
+    {
+        wxThreadPoolTask * const task = Pop(worker);
+        if ( task )
+        {
+            Execute(task);
+            continue;
+        }
+
+        wxMutexLocker lock(m_sleepMutex);
+
+        wxAtomicInc(m_numSleeping);
+
+        if ( !m_numQueued && !m_stopping )
+            m_wakeUp.Wait();
+
+        wxAtomicDec(m_numSleeping);
+    }
+}
+
+// ============================================================================
+// wxThreadPoolTask implementation
+// ============================================================================
+
+wxThreadPoolTask::wxThreadPoolTask()
+{
+    m_refCount = 1;
+    m_cancelled = 0;
+    m_pending = 1;
+
+    m_pool = NULL;
+    m_group = NULL;
+
+    m_notifyDone = true;
+}
+
+void wxThreadPoolTask::Cancel()
+{
+    wxAtomicInc(m_cancelled);
+}
+
+bool wxThreadPoolTask::IsCancelled() const
+{
+    if ( m_cancelled )
+        return true;
+
+    wxTaskGroup * const group = m_group;
+
+    return group && group->IsCancelled();
+}
+
+void wxThreadPoolTask::Wait()
+{
+    wxCHECK_RET( m_pool, "task must be queued before waiting for it" );
+
+    m_pool->WaitForPending(m_pending);
+}
+
+// ============================================================================
+// wxThreadPool implementation
+// ============================================================================
+
+wxThreadPool::wxThreadPool(int numThreads)
+{
+    if ( numThreads <= 0 )
+    {
+        numThreads = wxThread::GetCPUCount();
+        if ( numThreads <= 0 )
+            numThreads = 1;
+    }
+
+    m_numThreads = numThreads;
+    m_impl = new wxThreadPoolImpl(numThreads);
+}
+
+wxThreadPool::~wxThreadPool()
+{
+    delete m_impl;
+}
+
+/* static */
+wxThreadPool& wxThreadPool::Get()
+{
+    wxCriticalSectionLocker lock(gs_defaultPoolCS);
+
+    if ( !gs_defaultPool )
+        gs_defaultPool = new wxThreadPool;
+
+    return *gs_defaultPool;
+}
+
+void wxThreadPool::DoQueue(wxThreadPoolTask *task, wxTaskGroup *group)
+{
+    wxCHECK_RET( task, "NULL task" );
+    wxCHECK_RET( !task->m_pool, "task can't be queued more than once" );
+
+    task->m_pool = this;
+    task->m_group = group;
+
+    if ( group )
+        wxAtomicInc(group->m_pending);
+
+    m_impl->Push(task);
+}
+
+wxThreadPoolTaskPtr wxThreadPool::Queue(wxThreadPoolTask *task)
+{
+    // Take a reference for the returned pointer before queuing the task as it
+    // could be deleted as soon as it's queued otherwise.
+    if ( task )
+        task->IncRef();
+
+    DoQueue(task, NULL);
+
+    return wxThreadPoolTaskPtr(task);
+}
+
+bool wxThreadPool::RunPendingTask()
+{
+    wxThreadPoolTask * const task = m_impl->Pop(m_impl->GetCurrentWorker());
+    if ( !task )
+        return false;
+
+    m_impl->Execute(task);
+
+    return true;
+}
+
+void wxThreadPool::WaitForPending(wxAtomicInt& pending)
+{
+    while ( !IsZero(pending) )
+    {
+        if ( !RunPendingTask() )
+            m_impl->WaitForChange(pending);
+    }
+}
+
+// ============================================================================
+// wxTaskGroup implementation
+// ============================================================================
+
+wxTaskGroup::~wxTaskGroup()
+{
+    Cancel();
+    Wait();
+}
+
+wxThreadPoolTaskPtr wxTaskGroup::Run(wxThreadPoolTask *task)
+{
+    if ( task )
+        task->IncRef();
+
+    m_pool.DoQueue(task, this);
+
+    return wxThreadPoolTaskPtr(task);
+}
+
+void wxTaskGroup::Wait()
+{
+    m_pool.WaitForPending(m_pending);
+}
+
+// ============================================================================
+// wxThreadPoolModule
+// ============================================================================
+
+class wxThreadPoolModule : public wxModule
+{
+public:
+    wxThreadPoolModule() { }
+
+    virtual bool OnInit() wxOVERRIDE { return true; }
+    virtual void OnExit() wxOVERRIDE { wxDELETE(gs_defaultPool); }
+
+private:
+    wxDECLARE_DYNAMIC_CLASS(wxThreadPoolModule);
+};
+
+wxIMPLEMENT_DYNAMIC_CLASS(wxThreadPoolModule, wxModule);
+
+#endif // wxUSE_THREADS
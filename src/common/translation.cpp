@@ -49,6 +49,11 @@
 #include "wx/scopedptr.h"
 #include "wx/stdpaths.h"
 #include "wx/private/threadinfo.h"
+#include "wx/thread.h"
+
+#ifdef __UNIX__
+    #include <sys/mman.h>
+#endif
 
 #ifdef __WINDOWS__
     #include "wx/dynlib.h"
@@ -987,8 +992,27 @@ public:
     bool LoadData(const DataBuffer& data,
                   wxPluralFormsCalculatorPtr& rPluralFormsCalculator);
 
-    // fills the hash with string-translation pairs
-    bool FillHash(wxStringToStringHashMap& hash, const wxString& domain) const;
+    // fills the hashes with string-translation pairs and with all the plural
+    // forms of the strings having them
+    bool FillHash(wxStringToStringHashMap& hash,
+                  wxMsgCatalog::PluralFormsMap& plurals,
+                  const wxString& domain) const;
+
+#if wxUSE_UNICODE
+    // prepare for looking up the strings on demand using LookupString(), this
+    // fails if the catalog doesn't have the hash table used for it
+    bool InitLookup();
+
+    // find all the forms of the translation of the given string, return false
+    // if it's not found in the catalog
+    bool LookupString(const wxString& msgid, wxArrayString& forms) const;
+
+#if wxUSE_THREADS
+    // the critical section which must be locked when using the strings which
+    // were already looked up
+    wxCriticalSection& GetLookupLock() const { return m_lookupLock; }
+#endif // wxUSE_THREADS
+#endif // wxUSE_UNICODE
 
     // return the charset of the strings in this catalog or empty string if
     // none/unknown
@@ -1019,13 +1043,33 @@ private:
     // all data is stored here
     DataBuffer m_data;
 
+#ifdef __UNIX__
+    // the memory-mapped file contents used as m_data, if non-NULL
+    void *m_mappedData;
+    size_t m_mappedSize;
+#endif // __UNIX__
+
     // data description
     size_t32          m_numStrings;   // number of strings in this domain
     wxMsgTableEntry  *m_pOrigTable,   // pointer to original   strings
                      *m_pTransTable;  //            translated
 
+    size_t32          m_nHashSize;    // hash table size, may be 0
+    const size_t32   *m_pHashTable;   // hash table of the original strings
+
     wxString m_charset;               // from the message catalog header
 
+#if wxUSE_UNICODE
+    // conversion used to convert the strings to and from catalog charset,
+    // only used by LookupString()
+    wxMBConv *m_conv;
+    wxScopedPtr<wxMBConv> m_convPtr;
+
+#if wxUSE_THREADS
+    mutable wxCriticalSection m_lookupLock;
+#endif // wxUSE_THREADS
+#endif // wxUSE_UNICODE
+
 
     // swap the 2 halves of 32 bit integer if needed
     size_t32 Swap(size_t32 ui) const
@@ -1049,6 +1093,26 @@ private:
         return m_data.data() + ofsString;
     }
 
+    // check that the table with the given number of 32 bit integers at the
+    // given offset is entirely inside the data
+    bool IsValidTable(size_t32 ofs, size_t32 count) const
+    {
+        return ofs <= m_data.length() &&
+                count <= (m_data.length() - ofs) / sizeof(size_t32);
+    }
+
+    // get all the forms of the translation of the string with the given index
+    bool GetTranslations(size_t32 i,
+                         wxMBConv *inputConv,
+                         wxArrayString& forms) const;
+
+#if wxUSE_UNICODE
+    // find the index of the given string using the hash table, the hash
+    // function and the search algorithm must be the same as in GNU gettext
+    static unsigned long HashString(const char *str);
+    bool FindString(const char *str, size_t32 *index) const;
+#endif // wxUSE_UNICODE
+
     bool m_bSwapped;   // wrong endianness?
 
     wxDECLARE_NO_COPY_CLASS(wxMsgCatalogFile);
@@ -1060,10 +1124,28 @@ private:
 
 wxMsgCatalogFile::wxMsgCatalogFile()
 {
+#ifdef __UNIX__
+    m_mappedData = NULL;
+    m_mappedSize = 0;
+#endif // __UNIX__
+
+    m_nHashSize = 0;
+    m_pHashTable = NULL;
+
+#if wxUSE_UNICODE
+    m_conv = NULL;
+#endif // wxUSE_UNICODE
 }
 
 wxMsgCatalogFile::~wxMsgCatalogFile()
 {
+#ifdef __UNIX__
+    if ( m_mappedData )
+    {
+        m_data.reset();
+        munmap(m_mappedData, m_mappedSize);
+    }
+#endif // __UNIX__
 }
 
 // open disk file and read in it's contents
@@ -1082,19 +1164,36 @@ bool wxMsgCatalogFile::LoadFile(const wxString& filename,
     size_t nSize = wx_truncate_cast(size_t, lenFile);
     wxASSERT_MSG( nSize == lenFile + size_t(0), wxS("message catalog bigger than 4GB?") );
 
-    wxMemoryBuffer filedata;
+    DataBuffer data;
 
-    // read the whole file in memory
-    if ( fileMsg.Read(filedata.GetWriteBuf(nSize), nSize) != lenFile )
-        return false;
+#ifdef __UNIX__
+    // map the file in memory instead of reading it if possible: this avoids
+    // loading the parts of it which are never used if the strings are only
+    // looked up on demand
+    void * const mapped = mmap(NULL, nSize, PROT_READ, MAP_PRIVATE,
+                               fileMsg.fd(), 0);
+    if ( mapped != MAP_FAILED )
+    {
+        m_mappedData = mapped;
+        m_mappedSize = nSize;
 
-    filedata.UngetWriteBuf(nSize);
+        data = DataBuffer::CreateNonOwned(static_cast<char *>(mapped), nSize);
+    }
+    else
+#endif // __UNIX__
+    {
+        wxMemoryBuffer filedata;
+
+        // read the whole file in memory
+        if ( fileMsg.Read(filedata.GetWriteBuf(nSize), nSize) != lenFile )
+            return false;
+
+        filedata.UngetWriteBuf(nSize);
+
+        data = DataBuffer::CreateOwned((char*)filedata.release(), nSize);
+    }
 
-    bool ok = LoadData
-              (
-                  DataBuffer::CreateOwned((char*)filedata.release(), nSize),
-                  rPluralFormsCalculator
-              );
+    bool ok = LoadData(data, rPluralFormsCalculator);
     if ( !ok )
     {
         wxLogWarning(_("'%s' is not a valid message catalog."), filename.c_str());
@@ -1135,6 +1234,14 @@ bool wxMsgCatalogFile::LoadData(const DataBuffer& data,
     m_pTransTable = (wxMsgTableEntry *)(data.data() +
                     Swap(pHeader->ofsTransTable));
 
+    // the hash table is optional, but check that it's valid if present
+    const size_t32 ofsHashTable = Swap(pHeader->ofsHashTable);
+    m_nHashSize = Swap(pHeader->nHashSize);
+    if ( m_nHashSize && IsValidTable(ofsHashTable, m_nHashSize) )
+        m_pHashTable = (const size_t32 *)(data.data() + ofsHashTable);
+    else
+        m_nHashSize = 0;
+
     // now parse catalog's header and try to extract catalog charset and
     // plural forms formula from it:
 
@@ -1196,6 +1303,7 @@ bool wxMsgCatalogFile::LoadData(const DataBuffer& data,
 }
 
 bool wxMsgCatalogFile::FillHash(wxStringToStringHashMap& hash,
+                                wxMsgCatalog::PluralFormsMap& plurals,
                                 const wxString& domain) const
 {
     wxUnusedVar(domain); // silence warning in Unicode build
@@ -1256,54 +1364,177 @@ bool wxMsgCatalogFile::FillHash(wxStringToStringHashMap& hash,
             msgid = data;
 #endif // wxUSE_UNICODE
 
-        data = StringAtOfs(m_pTransTable, i);
-        if (!data)
+        wxArrayString forms;
+        if ( !GetTranslations(i, inputConv, forms) )
             return false; // may happen for invalid MO files
 
-        size_t length = Swap(m_pTransTable[i].nLen);
-        size_t offset = 0;
-        size_t index = 0;
-        while (offset < length)
-        {
-            const char * const str = data + offset;
+        if ( !forms.empty() && !forms[0].empty() )
+            hash[msgid] = forms[0];
 
-            wxString msgstr;
+        if ( forms.size() > 1 )
+            plurals[msgid] = forms;
+    }
+
+    return true;
+}
+
+bool wxMsgCatalogFile::GetTranslations(size_t32 i,
+                                       wxMBConv *inputConv,
+                                       wxArrayString& forms) const
+{
+    const char * const data = StringAtOfs(m_pTransTable, i);
+    if (!data)
+        return false;
+
+    size_t length = Swap(m_pTransTable[i].nLen);
+    size_t offset = 0;
+    while (offset < length)
+    {
+        const char * const str = data + offset;
+
+        wxString msgstr;
 #if wxUSE_UNICODE
-            msgstr = wxString(str, *inputConv);
+        msgstr = wxString(str, *inputConv);
 #else
-            if ( inputConv )
-                msgstr = wxString(inputConv->cMB2WC(str), *wxConvUI);
-            else
-                msgstr = str;
+        if ( inputConv )
+            msgstr = wxString(inputConv->cMB2WC(str), *wxConvUI);
+        else
+            msgstr = str;
 #endif // wxUSE_UNICODE/!wxUSE_UNICODE
 
-            if ( !msgstr.empty() )
+        forms.push_back(msgstr);
+
+        // skip this string
+        // IMPORTANT: accesses to the 'data' pointer are valid only for
+        //            the first 'length+1' bytes (GNU specs says that the
+        //            final NUL is not counted in length); using wxStrnlen()
+        //            we make sure we don't access memory beyond the valid range
+        //            (which otherwise may happen for invalid MO files):
+        offset += wxStrnlen(str, length - offset) + 1;
+    }
+
+    return true;
+}
+
+#if wxUSE_UNICODE
+
+bool wxMsgCatalogFile::InitLookup()
+{
+    // the hash table size must be greater than 2 for the search algorithm
+    if ( m_nHashSize <= 2 )
+        return false;
+
+    // unlike FillHash(), we access the strings in random order, so check that
+    // the string tables are valid
+    const size_t32 tableSize = m_numStrings*(sizeof(wxMsgTableEntry)/sizeof(size_t32));
+    if ( m_numStrings > tableSize ||
+            !IsValidTable((const char *)m_pOrigTable - m_data.data(), tableSize) ||
+            !IsValidTable((const char *)m_pTransTable - m_data.data(), tableSize) )
+        return false;
+
+    // use the same conversion as FillHash() would
+    if ( !m_charset.empty() )
+    {
+        m_conv = new wxCSConv(m_charset);
+        m_convPtr.reset(m_conv);
+    }
+    else
+    {
+        m_conv = wxConvCurrent;
+    }
+
+    return true;
+}
+
+/* static */
+unsigned long wxMsgCatalogFile::HashString(const char *str)
+{
+    // this is the hashpjw function by P.J. Weinberger, as used by gettext
+    static const int HASHWORDBITS = 32;
+
+    unsigned long hval = 0;
+    while ( *str )
+    {
+        hval <<= 4;
+        hval += (unsigned char)*str++;
+
+        const unsigned long g = hval & (0xful << (HASHWORDBITS - 4));
+        if ( g )
+        {
+            hval ^= g >> (HASHWORDBITS - 8);
+            hval ^= g;
+        }
+    }
+
+    return hval;
+}
+
+bool wxMsgCatalogFile::FindString(const char *str, size_t32 *index) const
+{
+    const size_t len = strlen(str);
+
+    // use double hashing, as gettext does
+    const unsigned long hval = HashString(str);
+    size_t32 idx = hval % m_nHashSize;
+    const size_t32 incr = 1 + (hval % (m_nHashSize - 2));
+
+    // don't loop forever for invalid MO files
+    for ( size_t32 n = 0; n < m_nHashSize; n++ )
+    {
+        size_t32 i = Swap(m_pHashTable[idx]);
+        if ( !i )
+            return false; // empty entry, the string is not in the catalog
+
+        // the indices in the hash table are 1-based
+        i--;
+        if ( i < m_numStrings )
+        {
+            // the original string of a plural entry also contains the plural
+            // form after the singular one and NUL, so don't compare lengths
+            const size_t32 origLen = Swap(m_pOrigTable[i].nLen);
+            const char * const orig = StringAtOfs(m_pOrigTable, i);
+            if ( orig && origLen >= len && memcmp(orig, str, len) == 0 &&
+                    (origLen == len || orig[len] == '\0') )
             {
-                hash[index == 0 ? msgid : msgid + wxChar(index)] = msgstr;
+                *index = i;
+                return true;
             }
-
-            // skip this string
-            // IMPORTANT: accesses to the 'data' pointer are valid only for
-            //            the first 'length+1' bytes (GNU specs says that the
-            //            final NUL is not counted in length); using wxStrnlen()
-            //            we make sure we don't access memory beyond the valid range
-            //            (which otherwise may happen for invalid MO files):
-            offset += wxStrnlen(str, length - offset) + 1;
-            ++index;
         }
+
+        if ( idx >= m_nHashSize - incr )
+            idx -= m_nHashSize - incr;
+        else
+            idx += incr;
     }
 
-    return true;
+    return false;
+}
+
+bool wxMsgCatalogFile::LookupString(const wxString& msgid,
+                                    wxArrayString& forms) const
+{
+    const wxCharBuffer str(m_conv->cWC2MB(msgid.wc_str()));
+    if ( !str.data() )
+        return false;
+
+    size_t32 i;
+    if ( !FindString(str, &i) )
+        return false;
+
+    return GetTranslations(i, m_conv, forms);
 }
 
+#endif // wxUSE_UNICODE
 
 // ----------------------------------------------------------------------------
 // wxMsgCatalog class
 // ----------------------------------------------------------------------------
 
-#if !wxUSE_UNICODE
 wxMsgCatalog::~wxMsgCatalog()
 {
+    delete m_file;
+
+#if !wxUSE_UNICODE
     if ( m_conv )
     {
         if ( wxConvUI == m_conv )
@@ -1315,8 +1546,8 @@ wxMsgCatalog::~wxMsgCatalog()
 
         delete m_conv;
     }
-}
 #endif // !wxUSE_UNICODE
+}
 
 /* static */
 wxMsgCatalog *wxMsgCatalog::CreateFromFile(const wxString& filename,
@@ -1324,12 +1555,23 @@ wxMsgCatalog *wxMsgCatalog::CreateFromFile(const wxString& filename,
 {
     wxScopedPtr<wxMsgCatalog> cat(new wxMsgCatalog(domain));
 
-    wxMsgCatalogFile file;
+    wxScopedPtr<wxMsgCatalogFile> file(new wxMsgCatalogFile);
 
-    if ( !file.LoadFile(filename, cat->m_pluralFormsCalculator) )
+    if ( !file->LoadFile(filename, cat->m_pluralFormsCalculator) )
         return NULL;
 
-    if ( !file.FillHash(cat->m_messages, domain) )
+#if wxUSE_UNICODE
+    // look up the strings in the file on demand if possible: this is faster
+    // than converting all of them when loading it and uses less memory, as
+    // usually only a small part of the strings is really used
+    if ( file->InitLookup() )
+    {
+        cat->m_file = file.release();
+        return cat.release();
+    }
+#endif // wxUSE_UNICODE
+
+    if ( !file->FillHash(cat->m_messages, cat->m_plurals, domain) )
         return NULL;
 
     return cat.release();
@@ -1346,7 +1588,7 @@ wxMsgCatalog *wxMsgCatalog::CreateFromData(const wxScopedCharBuffer& data,
     if ( !file.LoadData(data, cat->m_pluralFormsCalculator) )
         return NULL;
 
-    if ( !file.FillHash(cat->m_messages, domain) )
+    if ( !file.FillHash(cat->m_messages, cat->m_plurals, domain) )
         return NULL;
 
     return cat.release();
@@ -1359,22 +1601,63 @@ const wxString *wxMsgCatalog::GetString(const wxString& str, unsigned n) const
     {
         index = m_pluralFormsCalculator->evaluate(n);
     }
-    wxStringToStringHashMap::const_iterator i;
-    if (index != 0)
-    {
-        i = m_messages.find(wxString(str) + wxChar(index));   // plural
-    }
-    else
+
+#if wxUSE_UNICODE
+    if ( m_file )
     {
-        i = m_messages.find(str);
+        // the strings looked up in the file are cached, so that we only need
+        // to search for and convert them once, but as this modifies the hash
+        // maps, it must be protected against concurrent access
+        wxCRIT_SECT_LOCKER(lock, m_file->GetLookupLock());
+
+        const bool cached = index == 0
+                                ? m_messages.find(str) != m_messages.end()
+                                : m_plurals.find(str) != m_plurals.end();
+        if ( !cached )
+        {
+            // notice that the strings which are not found are cached as well
+            // to avoid looking them up again, and that existing elements
+            // must not be modified as we could have returned pointers to them
+            wxArrayString forms;
+            m_file->LookupString(str, forms);
+
+            m_messages.insert(wxStringToStringHashMap::value_type
+                              (
+                                str,
+                                forms.empty() ? wxString() : forms[0]
+                              ));
+            if ( index != 0 || forms.size() > 1 )
+                m_plurals.insert(PluralFormsMap::value_type(str, forms));
+        }
+
+        return FindString(str, index);
     }
+#endif // wxUSE_UNICODE
+
+    return FindString(str, index);
+}
 
-    if ( i != m_messages.end() )
+const wxString *wxMsgCatalog::FindString(const wxString& str, int index) const
+{
+    if (index != 0)
     {
-        return &i->second;
+        PluralFormsMap::const_iterator i = m_plurals.find(str);
+        if ( i == m_plurals.end() )
+            return NULL;
+
+        const wxArrayString& forms = i->second;
+        if ( index < 0 || static_cast<size_t>(index) >= forms.size() ||
+                forms[index].empty() )
+            return NULL;
+
+        return &forms[index];
     }
-    else
+
+    wxStringToStringHashMap::const_iterator i = m_messages.find(str);
+    if ( i == m_messages.end() || i->second.empty() )
         return NULL;
+
+    return &i->second;
 }
 
 
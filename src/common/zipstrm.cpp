@@ -28,6 +28,7 @@
 #include "wx/zstream.h"
 #include "wx/mstream.h"
 #include "wx/scopedptr.h"
+#include "wx/threadpool.h"
 #include "wx/wfstream.h"
 #include "zlib.h"
 
@@ -78,6 +79,15 @@ enum {
     SUMS_OFFSET  = 14
 };
 
+// In parallel mode the entries are kept in memory until they're complete,
+// except for the ones bigger than PARALLEL_MAX_ENTRY which are written out
+// directly. PARALLEL_MAX_QUEUED limits the total size of the entries waiting
+// to be compressed.
+enum {
+    PARALLEL_MAX_ENTRY  = 16 * 1024 * 1024,
+    PARALLEL_MAX_QUEUED = 64 * 1024 * 1024
+};
+
 wxIMPLEMENT_DYNAMIC_CLASS(wxZipEntry, wxArchiveEntry);
 wxIMPLEMENT_DYNAMIC_CLASS(wxZipClassFactory, wxArchiveClassFactory);
 
@@ -610,6 +620,256 @@ bool wxZlibInputStream2::Open(wxInputStream& stream)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+// Jobs compressing or decompressing a whole entry in memory, used by the
+// parallel compression and decompression. They only use zlib directly and
+// don't log anything, so they can safely run in the pool threads.
+
+// Append buffer growing geometrically, as wxMemoryBuffer itself only grows
+// by a fixed amount which is too slow for big entries.
+//
+static void *GetAppendBuf(wxMemoryBuffer& buf, size_t size)
+{
+    const size_t needed = buf.GetDataLen() + size;
+    if (needed > buf.GetBufSize())
+        buf.SetBufSize(wxMax(needed, 2 * buf.GetBufSize()));
+    return buf.GetAppendBuf(size);
+}
+
+class wxZipJob
+{
+public:
+    enum Action { Store, Deflate, Inflate };
+
+    wxZipJob(Action action, const wxMemoryBuffer& input, int level = -1)
+      : m_action(action), m_input(input), m_level(level), m_size(0),
+        m_crc(0), m_ok(true), m_compressed(false), m_err(Z_OK),
+        m_msg(NULL), m_entry(NULL), m_index(0)
+    { }
+
+    ~wxZipJob() { delete m_entry; }
+
+    void Run();
+
+#if wxUSE_THREADS
+    void Wait() { if (m_task) m_task->Wait(); }
+    bool IsDone() const { return !m_task || m_task->IsDone(); }
+#else
+    void Wait() { }
+    bool IsDone() const { return true; }
+#endif
+
+    // the error message for when m_ok is false
+    wxString GetError() const;
+
+    Action m_action;
+    wxMemoryBuffer m_input;     // uncompressed data or the raw data read
+    wxMemoryBuffer m_output;    // compressed data if m_compressed is set,
+                                // or the decompressed data
+    int m_level;                // compression level when deflating
+    size_t m_size;              // expected size of the output when inflating
+    wxUint32 m_crc;             // crc of the uncompressed data
+    bool m_ok;
+    bool m_compressed;          // the output holds the data in a smaller form
+    int m_err;                  // zlib error code and message if !m_ok
+    const char *m_msg;
+
+    wxZipEntry *m_entry;        // the entry being written, owned by the job
+    size_t m_index;             // the index of the entry being read
+
+#if wxUSE_THREADS
+    wxThreadPoolTaskPtr m_task;
+#endif
+
+private:
+    void DoDeflate();
+    void DoInflate();
+
+    wxDECLARE_NO_COPY_CLASS(wxZipJob);
+};
+
+wxDECLARE_SCOPED_PTR(wxZipJob, wxZipJobPtr_)
+wxDEFINE_SCOPED_PTR (wxZipJob, wxZipJobPtr_)
+
+void wxZipJob::Run()
+{
+    if (m_action == Inflate) {
+        DoInflate();
+        m_crc = crc32(crc32(0, Z_NULL, 0), (Byte*)m_output.GetData(),
+                      m_output.GetDataLen());
+    } else {
+        if (m_action == Deflate)
+            DoDeflate();
+        m_crc = crc32(crc32(0, Z_NULL, 0), (Byte*)m_input.GetData(),
+                      m_input.GetDataLen());
+    }
+}
+
+void wxZipJob::DoDeflate()
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+
+    m_err = deflateInit2(&z, m_level == -1 ? Z_DEFAULT_COMPRESSION : m_level,
+                         Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (m_err != Z_OK) {
+        m_ok = false;
+        m_msg = z.msg;
+        return;
+    }
+
+    // the data is stored instead if compressing doesn't make it smaller, so
+    // don't bother compressing it into a buffer bigger than the input
+    const size_t len = m_input.GetDataLen();
+    z.next_in = (Byte*)m_input.GetData();
+    z.avail_in = len;
+    z.next_out = (Byte*)m_output.GetWriteBuf(len);
+    z.avail_out = len;
+
+    m_compressed = deflate(&z, Z_FINISH) == Z_STREAM_END && z.total_out < len;
+    m_output.UngetWriteBuf(m_compressed ? z.total_out : 0);
+
+    deflateEnd(&z);
+}
+
+void wxZipJob::DoInflate()
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+
+    m_err = inflateInit2(&z, -MAX_WBITS);
+    if (m_err == Z_OK) {
+        // leave room for an extra byte to detect when the data is longer
+        // than expected
+        z.next_in = (Byte*)m_input.GetData();
+        z.avail_in = m_input.GetDataLen();
+        z.next_out = (Byte*)m_output.GetWriteBuf(m_size + 1);
+        z.avail_out = m_size + 1;
+
+        m_err = inflate(&z, Z_FINISH);
+        m_output.UngetWriteBuf(z.total_out);
+
+        if (m_err == Z_STREAM_END || z.total_out > m_size)
+            m_err = Z_OK;
+        else if (m_err == Z_OK || m_err == Z_BUF_ERROR)
+            m_err = Z_DATA_ERROR;
+
+        inflateEnd(&z);
+    }
+
+    m_ok = m_err == Z_OK;
+    m_msg = z.msg;
+}
+
+wxString wxZipJob::GetError() const
+{
+    wxString msg(m_msg, *wxConvCurrent);
+    if (!msg)
+        msg = wxString::Format(_("zlib error %d"), m_err);
+    return msg;
+}
+
+#if wxUSE_THREADS
+
+class wxZipJobTask : public wxThreadPoolTask
+{
+public:
+    wxZipJobTask(wxZipJob& job) : m_job(job) { SetNotifyDone(false); }
+
+    virtual void Run() wxOVERRIDE { m_job.Run(); }
+
+private:
+    wxZipJob& m_job;
+};
+
+#endif // wxUSE_THREADS
+
+// The jobs which have been started, in the order they were queued in. The
+// output stream also uses it to keep the data of the entry being written.
+//
+class wxZipParallelQueue
+{
+public:
+    wxZipParallelQueue();
+    ~wxZipParallelQueue();
+
+    bool IsEmpty() const { return m_jobs.empty(); }
+    bool IsFull() const;
+    bool IsFrontDone() const { return !IsEmpty() && m_jobs.front()->IsDone(); }
+
+    // start running the job in the background and take ownership of it
+    void Push(wxZipJob *job);
+
+    // wait for the oldest job and give up ownership of it
+    wxZipJob *Pop();
+
+    // the entry being written hasn't been queued or written out yet
+    bool m_deferred;
+    wxMemoryBuffer m_data;
+
+private:
+    wxVector<wxZipJob*> m_jobs;
+    size_t m_maxJobs;
+    size_t m_queuedBytes;
+
+#if wxUSE_THREADS
+    wxTaskGroup m_group;
+#endif
+
+    wxDECLARE_NO_COPY_CLASS(wxZipParallelQueue);
+};
+
+wxZipParallelQueue::wxZipParallelQueue()
+  : m_deferred(false),
+    m_maxJobs(1),
+    m_queuedBytes(0)
+{
+#if wxUSE_THREADS
+    // keep all the threads busy while the oldest job is being written out
+    m_maxJobs = 2 * (m_group.GetPool().GetThreadCount() + 1);
+#endif
+}
+
+wxZipParallelQueue::~wxZipParallelQueue()
+{
+#if wxUSE_THREADS
+    m_group.Cancel();
+    m_group.Wait();
+#endif
+
+    for (size_t i = 0; i < m_jobs.size(); i++)
+        delete m_jobs[i];
+}
+
+bool wxZipParallelQueue::IsFull() const
+{
+    return m_jobs.size() >= m_maxJobs ||
+           (!IsEmpty() && m_queuedBytes >= PARALLEL_MAX_QUEUED);
+}
+
+void wxZipParallelQueue::Push(wxZipJob *job)
+{
+    m_jobs.push_back(job);
+    m_queuedBytes += job->m_input.GetDataLen();
+
+#if wxUSE_THREADS
+    job->m_task = m_group.Run(new wxZipJobTask(*job));
+#else
+    job->Run();
+#endif
+}
+
+wxZipJob *wxZipParallelQueue::Pop()
+{
+    wxZipJob *job = m_jobs.front();
+    m_jobs.erase(m_jobs.begin());
+    m_queuedBytes -= job->m_input.GetDataLen();
+
+    job->Wait();
+    return job;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 // Class to hold wxZipEntry's Extra and LocalExtra fields
 
@@ -2095,6 +2355,103 @@ size_t wxZipInputStream::OnSysRead(void *buffer, size_t size)
     return count;
 }
 
+// Read the contents of several entries at once. The compressed data of the
+// entries is read serially, as it's stored, but the entries are decompressed
+// and checked in parallel.
+//
+bool wxZipInputStream::ReadEntries(const wxVector<wxZipEntry*>& entries,
+                                   wxVector<wxMemoryBuffer>& data)
+{
+    data.clear();
+    data.resize(entries.size());
+
+    if (m_position == wxInvalidOffset)
+        if (!LoadEndRecord())
+            return false;
+    wxCHECK_MSG(m_parentSeekable, false,
+                wxT("reading several entries requires a seekable stream"));
+
+    wxZipParallelQueue queue;
+    bool ok = true;
+
+    for (size_t i = 0; i < entries.size() && ok; i++) {
+        wxZipEntry& entry = *entries[i];
+        const int method = entry.GetMethod();
+        const wxFileOffset size = entry.GetSize();
+        const wxFileOffset compressedSize = entry.GetCompressedSize();
+
+        // the other methods, and entries too big to be decompressed in one
+        // go by zlib, are decompressed here as usual
+        const bool parallel =
+            (method == wxZIP_METHOD_STORE || method == wxZIP_METHOD_DEFLATE)
+            && size != wxInvalidOffset && size < wxINT32_MAX
+            && compressedSize != wxInvalidOffset
+            && compressedSize < wxINT32_MAX;
+
+        if (!DoOpen(&entry, parallel)) {
+            ok = false;
+            break;
+        }
+
+        // read the whole entry in one go if its size is known, the extra
+        // byte lets the read reach the end of the entry
+        const wxFileOffset len = parallel ? compressedSize : size;
+        size_t chunk = 65536;
+        if (len != wxInvalidOffset && len < wxINT32_MAX)
+            chunk = static_cast<size_t>(len) + 1;
+
+        wxMemoryBuffer buf(chunk);
+        while (IsOk()) {
+            Read(GetAppendBuf(buf, chunk), chunk);
+            buf.UngetAppendBuf(LastRead());
+        }
+
+        // bad crc or length are reported when reading normally
+        ok = Eof();
+        CloseEntry();
+
+        if (!ok)
+            break;
+
+        if (parallel) {
+            wxZipJob *job = new wxZipJob(method == wxZIP_METHOD_DEFLATE ?
+                                         wxZipJob::Inflate : wxZipJob::Store,
+                                         buf);
+            job->m_size = static_cast<size_t>(size);
+            job->m_index = i;
+            queue.Push(job);
+        } else {
+            data[i] = buf;
+        }
+    }
+
+    while (!queue.IsEmpty()) {
+        wxZipJobPtr_ job(queue.Pop());
+        const wxZipEntry& entry = *entries[job->m_index];
+        const wxMemoryBuffer& buf = job->m_action == wxZipJob::Inflate ?
+                                    job->m_output : job->m_input;
+
+        if (!job->m_ok) {
+            wxLogError(_("Can't read from inflate stream: %s"),
+                       job->GetError().c_str());
+            ok = false;
+        } else if (entry.GetSize() != wxFileOffset(buf.GetDataLen())) {
+            wxLogError(_("reading zip stream (entry %s): bad length"),
+                       entry.GetName().c_str());
+            ok = false;
+        } else if (job->m_crc != entry.GetCrc()) {
+            wxLogError(_("reading zip stream (entry %s): bad crc"),
+                       entry.GetName().c_str());
+            ok = false;
+        } else {
+            data[job->m_index] = buf;
+        }
+    }
+
+    return ok;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 // Output stream
 
@@ -2133,6 +2490,7 @@ void wxZipOutputStream::Init(int level)
     m_level = level;
     m_offsetAdjustment = wxInvalidOffset;
     m_endrecWritten = false;
+    m_parallel = NULL;
 }
 
 wxZipOutputStream::~wxZipOutputStream()
@@ -2142,6 +2500,7 @@ wxZipOutputStream::~wxZipOutputStream()
     delete m_store;
     delete m_deflate;
     delete m_pending;
+    delete m_parallel;
     delete [] m_initialData;
     if (m_backlink)
         m_backlink->Release(this);
@@ -2220,6 +2579,19 @@ void wxZipOutputStream::SetLevel(int level)
     }
 }
 
+void wxZipOutputStream::SetParallelCompression(bool parallel /*=true*/)
+{
+    if (parallel) {
+        if (!m_parallel)
+            m_parallel = new wxZipParallelQueue;
+    } else if (m_parallel) {
+        if (IsOk() && IsDeferred())
+            StreamDeferredEntry();
+        WriteQueuedEntries();
+        wxDELETE(m_parallel);
+    }
+}
+
 bool wxZipOutputStream::DoCreate(wxZipEntry *entry, bool raw /*=false*/)
 {
     CloseEntry();
@@ -2228,7 +2600,34 @@ bool wxZipOutputStream::DoCreate(wxZipEntry *entry, bool raw /*=false*/)
     if (!m_pending)
         return false;
 
-    // write the signature bytes right away
+    // in parallel mode nothing is written until the entry is complete and
+    // has been compressed in the background, raw entries are written as
+    // usual after the ones which are still queued
+    if (m_parallel && !raw) {
+        m_parallel->m_deferred = true;
+    } else {
+        if (!WriteQueuedEntries())
+            return false;
+
+        // write the signature bytes right away
+        WriteLocalSignature();
+        m_pending->SetOffset(m_headerOffset);
+    }
+
+    m_crcAccumulator = crc32(0, Z_NULL, 0);
+
+    if (raw)
+        m_raw = true;
+
+    m_lasterror = wxSTREAM_NO_ERROR;
+    return true;
+}
+
+// Write the signature bytes of a local header and if this is the first entry
+// test for seekability
+//
+void wxZipOutputStream::WriteLocalSignature()
+{
     wxDataOutputStream ds(*m_parent_o_stream);
     ds << LOCAL_MAGIC;
 
@@ -2250,16 +2649,6 @@ bool wxZipOutputStream::DoCreate(wxZipEntry *entry, bool raw /*=false*/)
             }
         }
     }
-
-    m_pending->SetOffset(m_headerOffset);
-
-    m_crcAccumulator = crc32(0, Z_NULL, 0);
-
-    if (raw)
-        m_raw = true;
-
-    m_lasterror = wxSTREAM_NO_ERROR;
-    return true;
 }
 
 // Can be overridden to add support for additional compression methods
@@ -2426,11 +2815,156 @@ void wxZipOutputStream::CreatePendingEntry()
     m_lasterror = m_parent_o_stream->GetLastError();
 }
 
+bool wxZipOutputStream::IsDeferred() const
+{
+    return m_parallel && m_parallel->m_deferred;
+}
+
+// This is called in parallel mode when the entry turns out to be too big to
+// be kept in memory, or when Sync() is called, to write it out directly
+// after the queued entries. The buffer is the data about to be written, if
+// any, used by OpenCompressor() if nothing has been buffered yet.
+//
+void wxZipOutputStream::StreamDeferredEntry(const void *buffer, size_t size)
+{
+    wxASSERT(IsOk() && IsDeferred());
+    wxMemoryBuffer data(m_parallel->m_data);
+    m_parallel->m_data = wxMemoryBuffer();
+    m_parallel->m_deferred = false;
+    m_entrySize = 0;
+
+    if (!WriteQueuedEntries())
+        return;
+
+    WriteLocalSignature();
+    m_pending->SetOffset(m_headerOffset);
+
+    if (data.GetDataLen()) {
+        CreatePendingEntry(data.GetData(), data.GetDataLen());
+        if (IsOk())
+            OnSysWrite(data.GetData(), data.GetDataLen());
+    } else {
+        CreatePendingEntry(buffer, size);
+    }
+}
+
+// This is called in parallel mode when the entry is closed to queue it for
+// compressing in the background.
+//
+void wxZipOutputStream::QueueDeferredEntry()
+{
+    wxASSERT(IsOk() && IsDeferred());
+    wxZipEntryPtr_ spPending(m_pending);
+    m_pending = NULL;
+
+    wxMemoryBuffer data(m_parallel->m_data);
+    m_parallel->m_data = wxMemoryBuffer();
+    m_parallel->m_deferred = false;
+    m_entrySize = 0;
+
+    // OpenCompressor() still chooses the compression method and sets up the
+    // entry, but the standard methods are then done by a background job
+    // rather than by the returned stream
+    wxMemoryOutputStream mem;
+    Buffer bufs[] = {
+        { (const char*)data.GetData(), data.GetDataLen() },
+        { NULL, 0 }
+    };
+    wxOutputStream *comp = OpenCompressor(mem, *spPending, bufs);
+    wxZipJobPtr_ job;
+
+    if (comp == m_store) {
+        job.reset(new wxZipJob(wxZipJob::Store, data));
+    } else if (comp == m_deflate) {
+        CloseCompressor(comp);
+        job.reset(new wxZipJob(wxZipJob::Deflate, data, GetLevel()));
+    } else if (comp) {
+        bool ok = comp->Write(data.GetData(), data.GetDataLen()).IsOk();
+        CloseCompressor(comp);
+        if (ok) {
+            job.reset(new wxZipJob(wxZipJob::Store, data));
+            size_t size = mem.GetSize();
+            mem.CopyTo(job->m_output.GetWriteBuf(size), size);
+            job->m_output.UngetWriteBuf(size);
+            job->m_compressed = true;
+        }
+    }
+
+    if (!job.get()) {
+        m_lasterror = wxSTREAM_WRITE_ERROR;
+        return;
+    }
+
+    job->m_entry = spPending.release();
+    m_parallel->Push(job.release());
+
+    // write out the jobs which are already done, and wait for the oldest one
+    // if there are too many of them
+    while (IsOk() && (m_parallel->IsFrontDone() || m_parallel->IsFull()))
+        WriteQueuedEntry();
+}
+
+// Write out the oldest entry queued in parallel mode, waiting until it has
+// been compressed if necessary.
+//
+void wxZipOutputStream::WriteQueuedEntry()
+{
+    wxZipJobPtr_ job(m_parallel->Pop());
+    wxZipEntryPtr_ spEntry(job->m_entry);
+    job->m_entry = NULL;
+
+    if (!job->m_ok) {
+        wxLogError(_("Can't write to deflate stream: %s"),
+                   job->GetError().c_str());
+        m_lasterror = wxSTREAM_WRITE_ERROR;
+        return;
+    }
+
+    // as in CreatePendingEntry() fall back to 'store' if the compressor made
+    // the data larger rather than smaller
+    const wxMemoryBuffer& input = job->m_input;
+    const wxMemoryBuffer *data = &input;
+
+    if (job->m_compressed && job->m_output.GetDataLen() < input.GetDataLen())
+        data = &job->m_output;
+    else
+        spEntry->SetMethod(wxZIP_METHOD_STORE);
+
+    WriteLocalSignature();
+
+    spEntry->SetOffset(m_headerOffset);
+    spEntry->SetSize(input.GetDataLen());
+    spEntry->SetCrc(job->m_crc);
+    spEntry->SetCompressedSize(data->GetDataLen());
+    spEntry->m_Flags &= ~wxZIP_SUMS_FOLLOW;
+
+    size_t headerSize = spEntry->WriteLocal(*m_parent_o_stream, GetConv());
+    if (data->GetDataLen())
+        m_parent_o_stream->Write(data->GetData(), data->GetDataLen());
+    m_lasterror = m_parent_o_stream->GetLastError();
+
+    if (IsOk()) {
+        m_headerOffset += headerSize + data->GetDataLen();
+        m_entries.push_back(spEntry.release());
+    }
+}
+
+// Write out all the entries queued in parallel mode
+//
+bool wxZipOutputStream::WriteQueuedEntries()
+{
+    if (m_parallel)
+        while (IsOk() && !m_parallel->IsEmpty())
+            WriteQueuedEntry();
+    return IsOk();
+}
+
 // Write the 'central directory' and the 'end-central-directory' records.
 //
 bool wxZipOutputStream::Close()
 {
     CloseEntry();
+    WriteQueuedEntries();
 
     if (m_lasterror == wxSTREAM_WRITE_ERROR
         || (m_entries.size() == 0 && m_endrecWritten))
@@ -2471,7 +3005,9 @@ bool wxZipOutputStream::Close()
 //
 bool wxZipOutputStream::CloseEntry()
 {
-    if (IsOk() && m_pending)
+    if (IsOk() && IsDeferred())
+        QueueDeferredEntry();
+    else if (IsOk() && m_pending)
         CreatePendingEntry();
     if (!IsOk())
         return false;
@@ -2535,7 +3071,9 @@ bool wxZipOutputStream::CloseEntry()
 
 void wxZipOutputStream::Sync()
 {
-    if (IsOk() && m_pending)
+    if (IsOk() && IsDeferred())
+        StreamDeferredEntry();
+    else if (IsOk() && m_pending)
         CreatePendingEntry(NULL, 0);
     if (!m_comp)
         m_lasterror = wxSTREAM_WRITE_ERROR;
@@ -2547,7 +3085,16 @@ void wxZipOutputStream::Sync()
 
 size_t wxZipOutputStream::OnSysWrite(const void *buffer, size_t size)
 {
-    if (IsOk() && m_pending) {
+    if (IsOk() && IsDeferred()) {
+        if (m_parallel->m_data.GetDataLen() + size <= PARALLEL_MAX_ENTRY) {
+            memcpy(GetAppendBuf(m_parallel->m_data, size), buffer, size);
+            m_parallel->m_data.UngetAppendBuf(size);
+            m_entrySize += size;
+            return size;
+        } else {
+            StreamDeferredEntry(buffer, size);
+        }
+    } else if (IsOk() && m_pending) {
         if (m_initialSize + size < OUTPUT_LATENCY) {
             memcpy(m_initialData + m_initialSize, buffer, size);
             m_initialSize += size;
@@ -39,6 +39,7 @@
 
 enum {
     ZSTREAM_BUFFER_SIZE = 16384,
+    ZSTREAM_MAX_BUFFER_SIZE = 262144,
     ZSTREAM_GZIP        = 0x10,     // gzip header
     ZSTREAM_AUTO        = 0x20      // auto detect between gzip and zlib
 };
@@ -209,6 +210,14 @@ size_t wxZlibInputStream::OnSysRead(void *buffer, size_t size)
 
   while (err == Z_OK && m_inflate->avail_out > 0) {
     if (m_inflate->avail_in == 0 && m_parent_i_stream->IsOk()) {
+      // if the whole of the last full buffer was consumed there is plenty of
+      // input available, so read it in bigger chunks to reduce the overhead
+      if (m_inflate->next_in == m_z_buffer + m_z_size &&
+              m_z_size < ZSTREAM_MAX_BUFFER_SIZE) {
+        delete [] m_z_buffer;
+        m_z_size *= 2;
+        m_z_buffer = new unsigned char[m_z_size];
+      }
       m_parent_i_stream->Read(m_z_buffer, m_z_size);
       m_inflate->next_in = m_z_buffer;
       m_inflate->avail_in = m_parent_i_stream->LastRead();
@@ -412,6 +421,14 @@ size_t wxZlibOutputStream::OnSysWrite(const void *buffer, size_t size)
         break;
       }
 
+      // the output filled the buffer, so use a bigger one to write it to the
+      // parent stream in fewer, larger chunks
+      if (m_z_size < ZSTREAM_MAX_BUFFER_SIZE) {
+        delete [] m_z_buffer;
+        m_z_size *= 2;
+        m_z_buffer = new unsigned char[m_z_size];
+      }
+
       m_deflate->next_out = m_z_buffer;
       m_deflate->avail_out = m_z_size;
     }
@@ -51,6 +51,11 @@
 #include "wx/stopwatch.h"
 #include "wx/weakref.h"
 #include "wx/generic/private/widthcalc.h"
+#include "wx/generic/private/rowheightcache.h"
+
+#include "wx/beforestd.h"
+#include <algorithm>
+#include "wx/afterstd.h"
 
 //-----------------------------------------------------------------------------
 // classes
@@ -459,6 +464,10 @@ public:
 
     void InsertChild(wxDataViewTreeNode *node, unsigned index);
 
+    // Append all the given nodes and sort the children just once afterwards
+    // if necessary, this is much faster than inserting them one by one.
+    void AppendChildren(const wxDataViewTreeNodes& nodes);
+
     void RemoveChild(wxDataViewTreeNode *node)
     {
         wxCHECK_RET( m_branchData != NULL, "leaf node doesn't have children" );
@@ -501,6 +510,19 @@ public:
         return m_branchData && m_branchData->open;
     }
 
+    // Returns true if this node is shown in the control, i.e. if all of its
+    // parents are expanded.
+    bool IsShown() const
+    {
+        for ( const wxDataViewTreeNode* p = m_parent; p; p = p->m_parent )
+        {
+            if ( !p->IsOpen() )
+                return false;
+        }
+
+        return true;
+    }
+
     void ToggleOpen()
     {
         // We do not allow the (invisible) root node to be collapsed because
@@ -631,6 +653,7 @@ public:
 
     // notifications from wxDataViewModel
     bool ItemAdded( const wxDataViewItem &parent, const wxDataViewItem &item );
+    bool ItemsAdded( const wxDataViewItem &parent, const wxDataViewItemArray &items );
     bool ItemDeleted( const wxDataViewItem &parent, const wxDataViewItem &item );
     bool ItemChanged( const wxDataViewItem &item );
     bool ValueChanged( const wxDataViewItem &item, unsigned int model_column );
@@ -641,6 +664,11 @@ public:
         {
             SortPrepare();
             m_root->Resort();
+
+            // The rows could have been reordered, so their cached heights
+            // can't be used any more.
+            if ( m_sortColumn >= SortColumn_Default )
+                m_rowHeightCache.Clear();
         }
         UpdateDisplay();
     }
@@ -780,7 +808,13 @@ public:
     int GetLineHeight( unsigned int row ) const; // m_lineHeight in fixed mode
     int GetLineAt( unsigned int y ) const;       // y / m_lineHeight in fixed mode
 
-    void SetRowHeight( int lineHeight ) { m_lineHeight = lineHeight; }
+    void SetRowHeight( int lineHeight )
+    {
+        m_lineHeight = lineHeight;
+
+        // The row height is the minimal height of all rows.
+        m_rowHeightCache.Clear();
+    }
     int GetRowHeight() const { return m_lineHeight; }
     int GetDefaultRowHeight() const;
 
@@ -816,6 +850,9 @@ public:
 
     void OnColumnsCountChanged();
 
+    // Forget the cached row heights, e.g. because a column was changed.
+    void InvalidateRowHeights() { m_rowHeightCache.Clear(); }
+
     // Adjust last column to window size
     void UpdateColumnSizes();
 
@@ -837,6 +874,21 @@ private:
 
     int RecalculateCount() const;
 
+    // Update the cached height of the row showing the given item, if any.
+    void UpdateRowHeight(const wxDataViewItem& item);
+
+    // Return the height of the row showing the given item, i.e. the maximal
+    // height of all its cells, but not less than m_lineHeight.
+    int GetItemHeight(const wxDataViewItem& item) const;
+
+    // Compute the heights of the given range of rows of a non-virtual model.
+    void GetRowHeights(unsigned int first, unsigned int count,
+                       wxVector<int>& heights) const;
+
+    // Ensure that the heights of at least the given number of rows are in
+    // m_rowHeightCache, used in wxDV_VARIABLE_LINE_HEIGHT case only.
+    void CacheRowHeights(unsigned int count) const;
+
     // Return false only if the event was vetoed by its handler.
     bool SendExpanderEvent(wxEventType type, const wxDataViewItem& item);
 
@@ -892,6 +944,10 @@ private:
     wxDataViewTreeNode * m_root;
     int m_count;
 
+    // Heights of the first rows when using wxDV_VARIABLE_LINE_HEIGHT, filled
+    // in lazily by GetLineStart() and GetLineAt().
+    mutable wxRowHeightCache m_rowHeightCache;
+
     // This is the tree node under the cursor
     wxDataViewTreeNode * m_underMouse;
 
@@ -922,6 +978,8 @@ public:
 
     virtual bool ItemAdded( const wxDataViewItem & parent, const wxDataViewItem & item )
         { return m_mainWindow->ItemAdded( parent , item ); }
+    virtual bool ItemsAdded( const wxDataViewItem & parent, const wxDataViewItemArray & items )
+        { return m_mainWindow->ItemsAdded( parent, items ); }
     virtual bool ItemDeleted( const wxDataViewItem &parent, const wxDataViewItem &item )
         { return m_mainWindow->ItemDeleted( parent, item ); }
     virtual bool ItemChanged( const wxDataViewItem & item )
@@ -1460,35 +1518,70 @@ void wxDataViewRenameTimer::Notify()
 // wxDataViewTreeNode
 // ----------------------------------------------------------------------------
 
-// Used by wxGenericTreeModelNodeCmp sort callback only.
-//
-// This is not thread safe but it should be fine if all events are handled in
-// one thread.
-static wxDataViewModel* g_model;
-static int g_column;
-static bool g_asending;
+namespace
+{
 
-int LINKAGEMODE wxGenericTreeModelNodeCmp(wxDataViewTreeNode ** node1,
-    wxDataViewTreeNode ** node2)
+// Comparator ordering the nodes according to the current sort column and
+// order of the given window. It stores everything it needs, so that sorting
+// different controls doesn't rely on any global state.
+class wxGenericTreeModelNodeCmp
 {
-    return g_model->Compare((*node1)->GetItem(), (*node2)->GetItem(), g_column, g_asending);
-}
+public:
+    explicit wxGenericTreeModelNodeCmp(const wxDataViewMainWindow *window)
+        : m_model(window->GetModel()),
+          m_column(window->GetSortColumn()),
+          m_ascending(window->IsAscendingSort())
+    {
+    }
+
+    bool operator()(const wxDataViewTreeNode *node1,
+                    const wxDataViewTreeNode *node2) const
+    {
+        return m_model->Compare(node1->GetItem(), node2->GetItem(),
+                                m_column, m_ascending) < 0;
+    }
+
+private:
+    const wxDataViewModel *m_model;
+    int m_column;
+    bool m_ascending;
+};
 
+} // anonymous namespace
 
 void wxDataViewTreeNode::InsertChild(wxDataViewTreeNode *node, unsigned index)
 {
     if (!m_branchData)
         m_branchData = new BranchNodeData;
 
-    m_branchData->children.Insert(node, index);
+    wxDataViewTreeNodes& nodes = m_branchData->children;
 
-    // TODO: insert into sorted array directly in O(log n) instead of resorting in O(n log n)
-    if ((g_column = m_window->GetSortColumn()) >= -1)
+    // Insert the new node directly in its sorted position instead of resorting
+    // all the children if they're sorted.
+    if ( m_window->GetSortColumn() >= SortColumn_Default )
     {
-        g_model = m_window->GetModel();
-        g_asending = m_window->IsAscendingSort();
+        index = std::upper_bound(nodes.begin(), nodes.end(), node,
+                                 wxGenericTreeModelNodeCmp(m_window))
+                    - nodes.begin();
+    }
 
-        m_branchData->children.Sort(&wxGenericTreeModelNodeCmp);
+    nodes.Insert(node, index);
+}
+
+void wxDataViewTreeNode::AppendChildren(const wxDataViewTreeNodes& nodes)
+{
+    if (!m_branchData)
+        m_branchData = new BranchNodeData;
+
+    wxDataViewTreeNodes& children = m_branchData->children;
+    children.reserve(children.size() + nodes.size());
+    for ( size_t n = 0; n < nodes.size(); n++ )
+        children.push_back(nodes[n]);
+
+    if ( m_window->GetSortColumn() >= SortColumn_Default )
+    {
+        std::stable_sort(children.begin(), children.end(),
+                         wxGenericTreeModelNodeCmp(m_window));
     }
 }
 
@@ -1497,13 +1590,12 @@ void wxDataViewTreeNode::Resort()
     if (!m_branchData)
         return;
 
-    if ((g_column = m_window->GetSortColumn()) >= -1)
+    if ( m_window->GetSortColumn() >= SortColumn_Default )
     {
         wxDataViewTreeNodes& nodes = m_branchData->children;
 
-        g_model = m_window->GetModel();
-        g_asending = m_window->IsAscendingSort();
-        nodes.Sort(&wxGenericTreeModelNodeCmp);
+        std::stable_sort(nodes.begin(), nodes.end(),
+                         wxGenericTreeModelNodeCmp(m_window));
         int len = nodes.GetCount();
         for (int i = 0; i < len; i++)
         {
@@ -2385,6 +2477,19 @@ bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxData
         parentNode->ChangeSubTreeCount(+1);
         parentNode->InsertChild(itemNode, nodePos);
 
+        // The heights of the following rows remain valid, they're just
+        // shifted by one, so only measure the new row.
+        if ( !m_rowHeightCache.IsEmpty() && itemNode->IsShown() )
+        {
+            const int itemRow = GetRowByItem(item);
+            if ( itemRow != -1 )
+            {
+                wxVector<int> heights;
+                heights.push_back(GetItemHeight(item));
+                m_rowHeightCache.Insert(itemRow, heights);
+            }
+        }
+
         InvalidateCount();
     }
 
@@ -2394,6 +2499,87 @@ bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxData
     return true;
 }
 
+bool wxDataViewMainWindow::ItemsAdded(const wxDataViewItem& parent,
+                                      const wxDataViewItemArray& items)
+{
+    size_t i;
+
+    wxDataViewTreeNode *parentNode = NULL;
+    if ( !IsVirtualList() && items.size() > 1 )
+    {
+        SortPrepare();
+
+        parentNode = FindNode(parent);
+    }
+
+    if ( parentNode && GetSortColumn() < SortColumn_Default )
+    {
+        // Without sorting, the nodes must be in the same order as the items
+        // in the model, which is simple to ensure only if the new items were
+        // appended to the existing ones, as is usually the case.
+        wxDataViewItemArray modelSiblings;
+        GetModel()->GetChildren(parent, modelSiblings);
+
+        const size_t nodeSiblingsSize = parentNode->HasChildren()
+                                            ? parentNode->GetChildNodes().size()
+                                            : 0;
+        if ( modelSiblings.size() != nodeSiblingsSize + items.size() )
+        {
+            parentNode = NULL;
+        }
+        else
+        {
+            for ( i = 0; i < items.size(); i++ )
+            {
+                if ( modelSiblings[nodeSiblingsSize + i] != items[i] )
+                {
+                    parentNode = NULL;
+                    break;
+                }
+            }
+        }
+    }
+
+    if ( !parentNode )
+    {
+        // Just add the items one by one, this is fine for virtual lists and
+        // for a few items and ItemAdded() handles all the other cases too.
+        for ( i = 0; i < items.size(); i++ )
+        {
+            if ( !ItemAdded(parent, items[i]) )
+                return false;
+        }
+
+        return true;
+    }
+
+    wxDataViewTreeNodes nodes;
+    nodes.reserve(items.size());
+    for ( i = 0; i < items.size(); i++ )
+    {
+        wxDataViewTreeNode *itemNode = new wxDataViewTreeNode(this, parentNode, items[i]);
+        itemNode->SetHasChildren(GetModel()->IsContainer(items[i]));
+
+        nodes.push_back(itemNode);
+    }
+
+    parentNode->SetHasChildren(true);
+    parentNode->ChangeSubTreeCount(+nodes.size());
+
+    // Sort the children only once after adding all of them, instead of doing
+    // it for every new item.
+    parentNode->AppendChildren(nodes);
+
+    // The new rows could have been inserted anywhere.
+    InvalidateRowHeights();
+    InvalidateCount();
+
+    GetOwner()->InvalidateColBestWidths();
+    UpdateDisplay();
+
+    return true;
+}
+
 bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
                                        const wxDataViewItem& item)
 {
@@ -2448,6 +2634,9 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
             return true;
         }
 
+        // Check this before modifying the parent node below.
+        const bool itemWasShown = parentNode->IsOpen() && parentNode->IsShown();
+
         // Delete the item from wxDataViewTreeNode representation:
         const int itemsDeleted = 1 + itemNode->GetSubTreeCount();
 
@@ -2473,8 +2662,10 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
             }
         }
 
-        // Update selection by removing 'item' and its entire children tree from the selection.
-        if ( !m_selection.IsEmpty() )
+        // Update selection and row heights by removing 'item' and its entire
+        // children tree from them.
+        if ( !m_selection.IsEmpty() ||
+                (itemWasShown && !m_rowHeightCache.IsEmpty()) )
         {
             // we can't call GetRowByItem() on 'item', as it's already deleted, so compute it from
             // the parent ('parentNode') and position in its list of children
@@ -2494,7 +2685,11 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
                           1;
             }
 
-            m_selection.OnItemsDeleted(itemRow, itemsDeleted);
+            if ( !m_selection.IsEmpty() )
+                m_selection.OnItemsDeleted(itemRow, itemsDeleted);
+
+            if ( itemWasShown )
+                m_rowHeightCache.Remove(itemRow, itemsDeleted);
         }
     }
 
@@ -2513,6 +2708,8 @@ bool wxDataViewMainWindow::ItemChanged(const wxDataViewItem & item)
     SortPrepare();
     GetModel()->Resort();
 
+    UpdateRowHeight(item);
+
     GetOwner()->InvalidateColBestWidths();
 
     // Send event
@@ -2540,6 +2737,8 @@ bool wxDataViewMainWindow::ValueChanged( const wxDataViewItem & item, unsigned i
     SortPrepare();
     GetModel()->Resort();
 
+    UpdateRowHeight(item);
+
     GetOwner()->InvalidateColBestWidth(view_column);
 
     // Send event
@@ -2550,6 +2749,16 @@ bool wxDataViewMainWindow::ValueChanged( const wxDataViewItem & item, unsigned i
     return true;
 }
 
+void wxDataViewMainWindow::UpdateRowHeight(const wxDataViewItem& item)
+{
+    if ( m_rowHeightCache.IsEmpty() )
+        return;
+
+    const int row = GetRowByItem(item);
+    if ( row != -1 && static_cast<unsigned>(row) < m_rowHeightCache.GetCount() )
+        m_rowHeightCache.SetHeight(row, GetItemHeight(item));
+}
+
 bool wxDataViewMainWindow::Cleared()
 {
     DestroyTree();
@@ -2852,49 +3061,57 @@ wxRect wxDataViewMainWindow::GetLineRect( unsigned int row ) const
     return rect;
 }
 
-int wxDataViewMainWindow::GetLineStart( unsigned int row ) const
+int wxDataViewMainWindow::GetItemHeight( const wxDataViewItem& item ) const
 {
     const wxDataViewModel *model = GetModel();
 
-    if (GetOwner()->GetWindowStyle() & wxDV_VARIABLE_LINE_HEIGHT)
+    int height = m_lineHeight;
+
+    unsigned int cols = GetOwner()->GetColumnCount();
+    unsigned int col;
+    for (col = 0; col < cols; col++)
     {
-        // TODO make more efficient
+        const wxDataViewColumn *column = GetOwner()->GetColumn(col);
+        if (column->IsHidden())
+            continue;      // skip it!
 
-        int start = 0;
+        if ((col != 0) &&
+            model->IsContainer(item) &&
+            !model->HasContainerColumns(item))
+            continue;      // skip it!
 
-        unsigned int r;
-        for (r = 0; r < row; r++)
-        {
-            const wxDataViewTreeNode* node = GetTreeNodeByRow(r);
-            if (!node) return start;
+        wxDataViewRenderer *renderer =
+            const_cast<wxDataViewRenderer*>(column->GetRenderer());
+        renderer->PrepareForItem(model, item, column->GetModelColumn());
 
-            wxDataViewItem item = node->GetItem();
+        height = wxMax( height, renderer->GetSize().y );
+    }
 
-            unsigned int cols = GetOwner()->GetColumnCount();
-            unsigned int col;
-            int height = m_lineHeight;
-            for (col = 0; col < cols; col++)
-            {
-                const wxDataViewColumn *column = GetOwner()->GetColumn(col);
-                if (column->IsHidden())
-                    continue;      // skip it!
+    return height;
+}
 
-                if ((col != 0) &&
-                    model->IsContainer(item) &&
-                    !model->HasContainerColumns(item))
-                    continue;      // skip it!
+void wxDataViewMainWindow::CacheRowHeights( unsigned int count ) const
+{
+    count = wxMin( count, GetRowCount() );
 
-                wxDataViewRenderer *renderer =
-                    const_cast<wxDataViewRenderer*>(column->GetRenderer());
-                renderer->PrepareForItem(model, item, column->GetModelColumn());
+    const unsigned int first = m_rowHeightCache.GetCount();
+    if ( count <= first )
+        return;
 
-                height = wxMax( height, renderer->GetSize().y );
-            }
+    wxVector<int> heights;
+    GetRowHeights( first, count - first, heights );
 
-            start += height;
-        }
+    for ( unsigned int n = 0; n < heights.size(); n++ )
+        m_rowHeightCache.Append( heights[n] );
+}
+
+int wxDataViewMainWindow::GetLineStart( unsigned int row ) const
+{
+    if ( GetOwner()->HasFlag(wxDV_VARIABLE_LINE_HEIGHT) && !IsVirtualList() )
+    {
+        CacheRowHeights( row );
 
-        return start;
+        return m_rowHeightCache.GetStart( wxMin(row, m_rowHeightCache.GetCount()) );
     }
     else
     {
@@ -2904,92 +3121,43 @@ int wxDataViewMainWindow::GetLineStart( unsigned int row ) const
 
 int wxDataViewMainWindow::GetLineAt( unsigned int y ) const
 {
-    const wxDataViewModel *model = GetModel();
-
     // check for the easy case first
-    if ( !GetOwner()->HasFlag(wxDV_VARIABLE_LINE_HEIGHT) )
+    if ( !GetOwner()->HasFlag(wxDV_VARIABLE_LINE_HEIGHT) || IsVirtualList() )
         return y / m_lineHeight;
 
-    // TODO make more efficient
-    unsigned int row = 0;
-    unsigned int yy = 0;
-    for (;;)
+    // Cache the heights of the rows until the given position, knowing that
+    // no row can be smaller than m_lineHeight.
+    for ( ;; )
     {
-        const wxDataViewTreeNode* node = GetTreeNodeByRow(row);
-        if (!node)
-        {
-            // not really correct...
-            return row + ((y-yy) / m_lineHeight);
-        }
-
-        wxDataViewItem item = node->GetItem();
+        const unsigned int count = m_rowHeightCache.GetCount();
+        const unsigned int yy = m_rowHeightCache.GetTotalHeight();
+        if ( y < yy )
+            return m_rowHeightCache.FindRow( y );
 
-        unsigned int cols = GetOwner()->GetColumnCount();
-        unsigned int col;
-        int height = m_lineHeight;
-        for (col = 0; col < cols; col++)
+        if ( count >= GetRowCount() )
         {
-            const wxDataViewColumn *column = GetOwner()->GetColumn(col);
-            if (column->IsHidden())
-                continue;      // skip it!
-
-            if ((col != 0) &&
-                model->IsContainer(item) &&
-                !model->HasContainerColumns(item))
-                continue;      // skip it!
-
-            wxDataViewRenderer *renderer =
-                const_cast<wxDataViewRenderer*>(column->GetRenderer());
-            renderer->PrepareForItem(model, item, column->GetModelColumn());
-
-            height = wxMax( height, renderer->GetSize().y );
+            // not really correct...
+            return count + ((y-yy) / m_lineHeight);
         }
 
-        yy += height;
-        if (y < yy)
-            return row;
-
-        row++;
+        CacheRowHeights( count + (y-yy) / m_lineHeight + 1 );
     }
 }
 
 int wxDataViewMainWindow::GetLineHeight( unsigned int row ) const
 {
-    const wxDataViewModel *model = GetModel();
-
     if (GetOwner()->GetWindowStyle() & wxDV_VARIABLE_LINE_HEIGHT)
     {
         wxASSERT( !IsVirtualList() );
 
+        if ( row < m_rowHeightCache.GetCount() )
+            return m_rowHeightCache.GetHeight( row );
+
         const wxDataViewTreeNode* node = GetTreeNodeByRow(row);
         // wxASSERT( node );
         if (!node) return m_lineHeight;
 
-        wxDataViewItem item = node->GetItem();
-
-        int height = m_lineHeight;
-
-        unsigned int cols = GetOwner()->GetColumnCount();
-        unsigned int col;
-        for (col = 0; col < cols; col++)
-        {
-            const wxDataViewColumn *column = GetOwner()->GetColumn(col);
-            if (column->IsHidden())
-                continue;      // skip it!
-
-            if ((col != 0) &&
-                model->IsContainer(item) &&
-                !model->HasContainerColumns(item))
-                continue;      // skip it!
-
-            wxDataViewRenderer *renderer =
-                const_cast<wxDataViewRenderer*>(column->GetRenderer());
-            renderer->PrepareForItem(model, item, column->GetModelColumn());
-
-            height = wxMax( height, renderer->GetSize().y );
-        }
-
-        return height;
+        return GetItemHeight( node->GetItem() );
     }
     else
     {
@@ -3064,6 +3232,70 @@ wxDataViewTreeNode * wxDataViewMainWindow::GetTreeNodeByRow(unsigned int row) co
     return job.GetResult();
 }
 
+// Collects the nodes shown in the given range of rows.
+class RowRangeToTreeNodesJob : public DoJob
+{
+public:
+    RowRangeToTreeNodesJob( unsigned int first, unsigned int count )
+        : m_first(static_cast<int>(first)),
+          m_last(static_cast<int>(first + count)),
+          m_current(-2)
+    {
+    }
+
+    virtual int operator() ( wxDataViewTreeNode * node )
+    {
+        m_current++;
+        if ( m_current < m_first )
+        {
+            if ( node->GetSubTreeCount() + m_current < m_first )
+            {
+                m_current += node->GetSubTreeCount();
+                return DoJob::SKIP_SUBTREE;
+            }
+
+            return DoJob::CONTINUE;
+        }
+
+        m_nodes.push_back(node);
+        if ( m_current + 1 >= m_last )
+            return DoJob::DONE;
+
+        // Collapsed nodes have 0 sub-tree count, so their children, if any,
+        // are skipped as they should be.
+        return node->GetSubTreeCount() ? DoJob::CONTINUE : DoJob::SKIP_SUBTREE;
+    }
+
+    const wxVector<wxDataViewTreeNode*>& GetResult() const
+        { return m_nodes; }
+
+private:
+    const int m_first,
+              m_last;
+    int m_current;
+    wxVector<wxDataViewTreeNode*> m_nodes;
+};
+
+void wxDataViewMainWindow::GetRowHeights(unsigned int first,
+                                         unsigned int count,
+                                         wxVector<int>& heights) const
+{
+    wxASSERT( !IsVirtualList() );
+
+    if ( !count )
+        return;
+
+    // Walk the tree only once for all rows instead of calling
+    // GetTreeNodeByRow() for each of them.
+    RowRangeToTreeNodesJob job( first, count );
+    Walker( m_root, job );
+
+    const wxVector<wxDataViewTreeNode*>& nodes = job.GetResult();
+    heights.reserve(heights.size() + nodes.size());
+    for ( unsigned int n = 0; n < nodes.size(); n++ )
+        heights.push_back(GetItemHeight(nodes[n]->GetItem()));
+}
+
 wxDataViewItem wxDataViewMainWindow::GetItemByRow(unsigned int row) const
 {
     wxDataViewItem item;
@@ -3154,6 +3386,13 @@ void wxDataViewMainWindow::Expand( unsigned int row )
         // Shift all stored indices after this row by the number of newly added
         // rows.
         m_selection.OnItemsInserted(row + 1, countNewRows);
+
+        // Don't measure all the new rows right now, there could be a lot of
+        // them and most of them are typically not even going to be shown, so
+        // just forget the heights of the rows after this one: they will be
+        // computed on demand when they're needed.
+        m_rowHeightCache.Truncate(row + 1);
+
         if ( m_currentRow > row )
             ChangeCurrentRow(m_currentRow + countNewRows);
 
@@ -3197,6 +3436,8 @@ void wxDataViewMainWindow::Collapse(unsigned int row)
                 SendSelectionChangedEvent(GetItemByRow(row));
             }
 
+            m_rowHeightCache.Remove(row + 1, countDeletedRows);
+
             node->ToggleOpen();
 
             // Adjust the current row if necessary.
@@ -3470,6 +3711,8 @@ static void BuildTreeHelper( wxDataViewMainWindow *window, const wxDataViewModel
     wxDataViewItemArray children;
     unsigned int num = model->GetChildren( item, children);
 
+    wxDataViewTreeNodes nodes;
+    nodes.reserve(num);
     for ( unsigned int index = 0; index < num; index++ )
     {
         wxDataViewTreeNode *n = new wxDataViewTreeNode(window, node, children[index]);
@@ -3477,9 +3720,11 @@ static void BuildTreeHelper( wxDataViewMainWindow *window, const wxDataViewModel
         if( model->IsContainer(children[index]) )
             n->SetHasChildren( true );
 
-        node->InsertChild(n, index);
+        nodes.push_back(n);
     }
 
+    node->AppendChildren(nodes);
+
     wxASSERT( node->IsOpen() );
     node->ChangeSubTreeCount(+num);
 }
@@ -3505,6 +3750,8 @@ void wxDataViewMainWindow::BuildTree(wxDataViewModel * model)
 
 void wxDataViewMainWindow::DestroyTree()
 {
+    m_rowHeightCache.Clear();
+
     if (!IsVirtualList())
     {
         wxDELETE(m_root);
@@ -4499,6 +4746,7 @@ void wxDataViewMainWindow::OnColumnsCountChanged()
 
     m_useCellFocus = (editableCount > 0);
 
+    InvalidateRowHeights();
     UpdateDisplay();
 }
 
@@ -4804,6 +5052,7 @@ void wxDataViewCtrl::OnColumnChange(unsigned int idx)
     if ( m_headerArea )
         m_headerArea->UpdateColumn(idx);
 
+    m_clientArea->InvalidateRowHeights();
     m_clientArea->UpdateDisplay();
 }
 
@@ -1400,6 +1400,243 @@ void wxListFindTimer::Notify()
     m_owner->OnFindTimer();
 }
 
+//-----------------------------------------------------------------------------
+// wxListFindIndex (internal)
+//-----------------------------------------------------------------------------
+
+void wxListFindIndex::Clear()
+{
+    for ( size_t n = 0; n < m_entries.size(); n++ )
+        delete m_entries[n].label;
+
+    m_entries.clear();
+    m_positions.clear();
+    m_built = false;
+    m_updates = 0;
+}
+
+void wxListFindIndex::BeginBuild(size_t count)
+{
+    Clear();
+
+    m_entries.reserve(count);
+}
+
+void wxListFindIndex::Add(const wxString& label)
+{
+    Entry entry;
+    entry.label = new wxString(label.Lower());
+    entry.item = m_entries.size();
+
+    m_entries.push_back(entry);
+}
+
+void wxListFindIndex::EndBuild()
+{
+    wxVectorSort(m_entries);
+
+    m_built = true;
+}
+
+bool wxListFindIndex::CountUpdate()
+{
+    if ( !m_built )
+        return false;
+
+    // Each update takes linear time, so rebuilding the index from scratch is
+    // cheaper than updating it after many changes.
+    static const unsigned MAX_UPDATES = 64;
+
+    if ( ++m_updates > MAX_UPDATES )
+    {
+        Clear();
+        return false;
+    }
+
+    return true;
+}
+
+void wxListFindIndex::Insert(const Entry& entry)
+{
+    // find the first entry greater than the new one
+    size_t lo = 0,
+           hi = m_entries.size();
+    while ( lo < hi )
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if ( entry < m_entries[mid] )
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    m_entries.insert(m_entries.begin() + lo, entry);
+    m_positions.clear();
+}
+
+size_t wxListFindIndex::Remove(size_t item, bool shift)
+{
+    size_t pos = (size_t)-1;
+
+    const size_t count = m_entries.size();
+    size_t out = 0;
+    for ( size_t n = 0; n < count; n++ )
+    {
+        Entry& entry = m_entries[n];
+        if ( entry.item == item )
+        {
+            delete entry.label;
+            pos = n;
+            continue;
+        }
+
+        if ( shift && entry.item > item )
+            entry.item--;
+
+        if ( out != n )
+            m_entries[out] = entry;
+        out++;
+    }
+
+    if ( out != count )
+        m_entries.resize(out);
+
+    m_positions.clear();
+
+    return pos;
+}
+
+void wxListFindIndex::OnItemInserted(size_t item, const wxString& label)
+{
+    if ( !CountUpdate() )
+        return;
+
+    for ( size_t n = 0; n < m_entries.size(); n++ )
+    {
+        if ( m_entries[n].item >= item )
+            m_entries[n].item++;
+    }
+
+    Entry entry;
+    entry.label = new wxString(label.Lower());
+    entry.item = item;
+    Insert(entry);
+}
+
+void wxListFindIndex::OnItemDeleted(size_t item)
+{
+    if ( !CountUpdate() )
+        return;
+
+    Remove(item, true /* shift the following items */);
+}
+
+void wxListFindIndex::OnItemChanged(size_t item, const wxString& label)
+{
+    if ( !CountUpdate() )
+        return;
+
+    Remove(item, false /* don't shift */);
+
+    Entry entry;
+    entry.label = new wxString(label.Lower());
+    entry.item = item;
+    Insert(entry);
+}
+
+size_t wxListFindIndex::Find(size_t start,
+                             const wxString& str,
+                             bool partial,
+                             bool wrap)
+{
+    wxASSERT_MSG( m_built, "index must be built before using it" );
+
+    m_updates = 0;
+
+    const wxString prefix = str.Lower();
+
+    // find the first entry not less than the prefix
+    const size_t count = m_entries.size();
+    size_t lo = 0,
+           hi = count;
+    while ( lo < hi )
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if ( m_entries[mid].label->compare(prefix) < 0 )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    // and then the first one after it which doesn't match any more, all the
+    // matching entries are between these two
+    const size_t begin = lo;
+    hi = count;
+    while ( lo < hi )
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        const wxString& label = *m_entries[mid].label;
+        if ( partial ? label.StartsWith(prefix) : label == prefix )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    const size_t end = lo;
+    if ( begin == end )
+        return (size_t)-1;
+
+    if ( m_positions.empty() )
+    {
+        m_positions.resize(count);
+        for ( size_t n = 0; n < count; n++ )
+            m_positions[m_entries[n].item] = n;
+    }
+
+    // The matching entries are ordered by their labels and not the item
+    // indices, so we may need to check all of them to find the first one
+    // after start. But if there are many of them, one of the items following
+    // start is likely to match, so also check the items in index order and
+    // stop as soon as either of these searches is done.
+    const size_t numItems = wrap ? count : start < count ? count - start : 0;
+    size_t item = start < count ? start : 0;
+
+    size_t found = (size_t)-1,
+           first = (size_t)-1;
+    size_t n = begin;
+    for ( size_t checked = 0; checked < numItems && n < end; checked++ )
+    {
+        const size_t pos = m_positions[item];
+        if ( pos >= begin && pos < end )
+            return item;
+
+        if ( ++item == count )
+            item = 0;
+
+        const Entry& entry = m_entries[n++];
+        if ( entry.item >= start )
+        {
+            // the entries with the same label are sorted by item index
+            if ( !partial )
+                return entry.item;
+
+            if ( entry.item < found )
+                found = entry.item;
+        }
+        else if ( entry.item < first )
+        {
+            first = entry.item;
+        }
+    }
+
+    // if we didn't check all the matching entries, it means that none of the
+    // items we were allowed to return matched
+    if ( n < end )
+        return (size_t)-1;
+
+    return found == (size_t)-1 && wrap ? first : found;
+}
+
 //-----------------------------------------------------------------------------
 // wxListTextCtrlWrapper (internal)
 //-----------------------------------------------------------------------------
@@ -3359,6 +3596,9 @@ void wxListMainWindow::SetItem( wxListItem &item )
         wxListLineData *line = GetLine((size_t)id);
         line->SetItem( item.m_col, item );
 
+        if ( item.m_col == 0 && (item.m_mask & wxLIST_MASK_TEXT) )
+            m_findIndex.OnItemChanged((size_t)id, item.m_text);
+
         // Set item state if user wants
         if ( item.m_mask & wxLIST_MASK_STATE )
             SetItemState( item.m_itemId, item.m_state, item.m_state );
@@ -4086,6 +4326,7 @@ void wxListMainWindow::DeleteItem( long lindex )
     else
     {
         m_lines.RemoveAt( index );
+        m_findIndex.OnItemDeleted(index);
     }
 
     // we need to refresh the (vert) scrollbar as the number of items changed
@@ -4104,6 +4345,10 @@ void wxListMainWindow::DeleteColumn( int col )
     delete node->GetData();
     m_columns.Erase( node );
 
+    // items are searched by their labels in the first column
+    if ( col == 0 )
+        m_findIndex.Clear();
+
     if ( !IsVirtual() )
     {
         // update all the items
@@ -4175,6 +4420,7 @@ void wxListMainWindow::DoDeleteAllItems()
         ResetVisibleLinesRange();
 
     m_lines.Clear();
+    m_findIndex.Clear();
 }
 
 void wxListMainWindow::DeleteAllItems()
@@ -4215,10 +4461,16 @@ long wxListMainWindow::FindItem(long start, const wxString& str, bool partial )
         return wxNOT_FOUND;
 
     long pos = start;
-    wxString str_upper = str.Upper();
     if (pos < 0)
         pos = 0;
 
+    if ( !IsVirtual() )
+    {
+        const size_t item = GetFindIndex().Find(pos, str, partial);
+        return item == (size_t)-1 ? wxNOT_FOUND : (long)item;
+    }
+
+    wxString str_upper = str.Upper();
     size_t count = GetItemCount();
     for ( size_t i = (size_t)pos; i < count; i++ )
     {
@@ -4360,6 +4612,7 @@ void wxListMainWindow::InsertItem( wxListItem &item )
     }
 
     m_lines.Insert( line, id );
+    m_findIndex.OnItemInserted(id, line->GetText(0));
 
     m_dirty = true;
 
@@ -4395,6 +4648,10 @@ long wxListMainWindow::InsertColumn( long col, const wxListItem &item )
             m_columns.Insert( node, column );
             m_aColWidths.Insert( colWidthInfo, col );
             idx = col;
+
+            // items are searched by their labels in the first column
+            if ( col == 0 )
+                m_findIndex.Clear();
         }
         else
         {
@@ -4476,6 +4733,7 @@ void wxListMainWindow::SortItems( wxListCtrlCompare fn, wxIntPtr data )
     list_ctrl_compare_func_2 = fn;
     list_ctrl_compare_data = data;
     m_lines.Sort( list_ctrl_compare_func_1 );
+    m_findIndex.Clear();
     m_dirty = true;
 }
 
@@ -4551,6 +4809,23 @@ void wxListMainWindow::GetVisibleLinesRange(size_t *from, size_t *to)
         *to = m_lineTo;
 }
 
+wxListFindIndex& wxListMainWindow::GetFindIndex() const
+{
+    wxASSERT_MSG( !IsVirtual(), "virtual controls don't store item labels" );
+
+    if ( !m_findIndex.IsBuilt() )
+    {
+        const size_t count = GetItemCount();
+
+        m_findIndex.BeginBuild(count);
+        for ( size_t n = 0; n < count; n++ )
+            m_findIndex.Add(GetLine(n)->GetText(0));
+        m_findIndex.EndBuild();
+    }
+
+    return m_findIndex;
+}
+
 size_t
 wxListMainWindow::PrefixFindItem(size_t idParent,
                                  const wxString& prefixOrig) const
@@ -4559,21 +4834,28 @@ wxListMainWindow::PrefixFindItem(size_t idParent,
     if ( idParent == (size_t)-1 )
         return idParent;
 
-    // match is case insensitive as this is more convenient to the user: having
-    // to press Shift-letter to go to the item starting with a capital letter
-    // would be too bothersome
-    wxString prefix = prefixOrig.Lower();
-
     // determine the starting point: we shouldn't take the current item (this
     // allows to switch between two items starting with the same letter just by
     // pressing it) but we shouldn't jump to the next one if the user is
     // continuing to type as otherwise he might easily skip the item he wanted
     size_t itemid = idParent;
-    if ( prefix.length() == 1 )
+    if ( prefixOrig.length() == 1 )
     {
         itemid += 1;
     }
 
+    // match is case insensitive as this is more convenient to the user: having
+    // to press Shift-letter to go to the item starting with a capital letter
+    // would be too bothersome
+    if ( !IsVirtual() )
+    {
+        // look for the item starting with the given prefix after the starting
+        // point or, if there is none, before it
+        return GetFindIndex().Find(itemid, prefixOrig, true, true /* wrap */);
+    }
+
+    wxString prefix = prefixOrig.Lower();
+
     // look for the item starting with the given prefix after it
     while ( ( itemid < (size_t)GetItemCount() ) &&
             !GetLine(itemid)->GetText(0).Lower().StartsWith(prefix) )
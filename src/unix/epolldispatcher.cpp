@@ -27,46 +27,71 @@
 #ifndef WX_PRECOMP
     #include "wx/log.h"
     #include "wx/intl.h"
+    #include "wx/utils.h"
 #endif
 
 #include <sys/epoll.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #define wxEpollDispatcher_Trace wxT("epolldispatcher")
 
+namespace
+{
+
+// the initial and maximal number of events retrieved by a single epoll_wait()
+const int INITIAL_EVENTS = 16;
+const int MAX_EVENTS = 1024;
+
+} // anonymous namespace
+
 // ============================================================================
 // implementation
 // ============================================================================
 
-// helper: return EPOLLxxx mask corresponding to the given flags (and also log
-// debugging messages about it)
-static uint32_t GetEpollMask(int flags, int fd)
+// helper: return EPOLLxxx mask corresponding to the given flags
+static uint32_t GetEpollMask(int flags)
 {
-    wxUnusedVar(fd); // unused if wxLogTrace() disabled
-
     uint32_t ep = 0;
 
     if ( flags & wxFDIO_INPUT )
-    {
         ep |= EPOLLIN;
-        wxLogTrace(wxEpollDispatcher_Trace,
-                   wxT("Registered fd %d for input events"), fd);
-    }
 
     if ( flags & wxFDIO_OUTPUT )
-    {
         ep |= EPOLLOUT;
-        wxLogTrace(wxEpollDispatcher_Trace,
-                   wxT("Registered fd %d for output events"), fd);
-    }
 
     if ( flags & wxFDIO_EXCEPTION )
-    {
         ep |= EPOLLERR | EPOLLHUP;
+
+    if ( flags & wxFDIO_EDGE_TRIGGERED )
+        ep |= EPOLLET;
+
+    return ep;
+}
+
+// same as above but also log debugging messages about the mask
+static uint32_t GetEpollMask(int flags, int fd)
+{
+    wxUnusedVar(fd); // unused if wxLogTrace() disabled
+
+    const uint32_t ep = GetEpollMask(flags);
+
+    if ( ep & EPOLLIN )
+        wxLogTrace(wxEpollDispatcher_Trace,
+                   wxT("Registered fd %d for input events"), fd);
+
+    if ( ep & EPOLLOUT )
+        wxLogTrace(wxEpollDispatcher_Trace,
+                   wxT("Registered fd %d for output events"), fd);
+
+    if ( ep & EPOLLERR )
         wxLogTrace(wxEpollDispatcher_Trace,
                    wxT("Registered fd %d for exceptional events"), fd);
-    }
+
+    if ( ep & EPOLLET )
+        wxLogTrace(wxEpollDispatcher_Trace,
+                   wxT("Using edge-triggered notifications for fd %d"), fd);
 
     return ep;
 }
@@ -94,21 +119,47 @@ wxEpollDispatcher::wxEpollDispatcher(int epollDescriptor)
     wxASSERT_MSG( epollDescriptor != -1, wxT("invalid descriptor") );
 
     m_epollDescriptor = epollDescriptor;
+    m_numFDs = 0;
+
+    m_events = static_cast<epoll_event *>(
+                    malloc(INITIAL_EVENTS*sizeof(epoll_event)));
+    m_eventsSize = m_events ? INITIAL_EVENTS : 0;
+    m_eventsFirst =
+    m_eventsCount = 0;
 }
 
 wxEpollDispatcher::~wxEpollDispatcher()
 {
+    free(m_events);
+
     if ( close(m_epollDescriptor) != 0 )
     {
         wxLogSysError(_("Error closing epoll descriptor"));
     }
 }
 
+void wxEpollDispatcher::SetHandler(int fd, wxFDIOHandler *handler, int flags)
+{
+    if ( fd < 0 )
+        return;
+
+    if ( static_cast<size_t>(fd) >= m_handlers.size() )
+        m_handlers.resize(fd + 1, wxFDIOHandlerEntry(NULL, 0));
+
+    wxFDIOHandlerEntry& entry = m_handlers[fd];
+    if ( !entry.handler && handler )
+        m_numFDs++;
+    else if ( entry.handler && !handler )
+        m_numFDs--;
+
+    entry = wxFDIOHandlerEntry(handler, flags);
+}
+
 bool wxEpollDispatcher::RegisterFD(int fd, wxFDIOHandler* handler, int flags)
 {
     epoll_event ev;
     ev.events = GetEpollMask(flags, fd);
-    ev.data.ptr = handler;
+    ev.data.fd = fd;
 
     const int ret = epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, fd, &ev);
     if ( ret != 0 )
@@ -118,6 +169,8 @@ bool wxEpollDispatcher::RegisterFD(int fd, wxFDIOHandler* handler, int flags)
 
         return false;
     }
+
+    SetHandler(fd, handler, flags);
     wxLogTrace(wxEpollDispatcher_Trace,
                wxT("Added fd %d (handler %p) to epoll %d"), fd, handler, m_epollDescriptor);
 
@@ -128,7 +181,7 @@ bool wxEpollDispatcher::ModifyFD(int fd, wxFDIOHandler* handler, int flags)
 {
     epoll_event ev;
     ev.events = GetEpollMask(flags, fd);
-    ev.data.ptr = handler;
+    ev.data.fd = fd;
 
     const int ret = epoll_ctl(m_epollDescriptor, EPOLL_CTL_MOD, fd, &ev);
     if ( ret != 0 )
@@ -139,6 +192,8 @@ bool wxEpollDispatcher::ModifyFD(int fd, wxFDIOHandler* handler, int flags)
         return false;
     }
 
+    SetHandler(fd, handler, flags);
+
     wxLogTrace(wxEpollDispatcher_Trace,
                 wxT("Modified fd %d (handler: %p) on epoll %d"), fd, handler, m_epollDescriptor);
     return true;
@@ -148,13 +203,27 @@ bool wxEpollDispatcher::UnregisterFD(int fd)
 {
     epoll_event ev;
     ev.events = 0;
-    ev.data.ptr = NULL;
+    ev.data.fd = fd;
 
     if ( epoll_ctl(m_epollDescriptor, EPOLL_CTL_DEL, fd, &ev) != 0 )
     {
         wxLogSysError(_("Failed to unregister descriptor %d from epoll descriptor %d"),
                       fd, m_epollDescriptor);
     }
+
+    // forget about the handler even if we failed above, it's not going to be
+    // used any more anyhow and any still pending events for this descriptor
+    // will be ignored
+    SetHandler(fd, NULL, 0);
+
+    // also discard the events for it which were already retrieved but not
+    // dispatched yet, as the descriptor could be reused and registered again
+    // before they're dispatched and they must not be passed to its new handler
+    for ( int n = m_eventsFirst; n < m_eventsCount; n++ )
+    {
+        if ( m_events[n].data.fd == fd )
+            m_events[n].events = 0;
+    }
     wxLogTrace(wxEpollDispatcher_Trace,
                 wxT("removed fd %d from %d"), fd, m_epollDescriptor);
     return true;
@@ -192,23 +261,55 @@ wxEpollDispatcher::DoPoll(epoll_event *events, int numEvents, int timeout) const
     return rc;
 }
 
-bool wxEpollDispatcher::HasPending() const
+int wxEpollDispatcher::RetrieveEvents(int timeout) const
 {
-    epoll_event event;
+    const int rc = DoPoll(m_events, m_eventsSize, timeout);
+    if ( rc == -1 )
+        return -1;
+
+    m_eventsFirst = 0;
 
     // NB: it's not really clear if epoll_wait() can return a number greater
     //     than the number of events passed to it but just in case it can, use
-    //     >= instead of == here, see #10397
-    return DoPoll(&event, 1, 0) >= 1;
+    //     wxMin() here, see #10397
+    m_eventsCount = wxMin(rc, m_eventsSize);
+
+    // if the buffer was filled, more events are probably waiting, so make it
+    // bigger to retrieve all of them at once the next time, but there is no
+    // point in retrieving more events than we have descriptors
+    if ( m_eventsCount == m_eventsSize && m_eventsSize < MAX_EVENTS &&
+            static_cast<size_t>(m_eventsSize) < m_numFDs )
+    {
+        const int size = 2*m_eventsSize;
+        void * const events = realloc(m_events, size*sizeof(epoll_event));
+        if ( events )
+        {
+            m_events = static_cast<epoll_event *>(events);
+            m_eventsSize = size;
+
+            wxLogTrace(wxEpollDispatcher_Trace,
+                       wxT("Using buffer for %d events for epoll %d"),
+                       size, m_epollDescriptor);
+        }
+    }
+
+    return m_eventsCount;
 }
 
-int wxEpollDispatcher::Dispatch(int timeout)
+bool wxEpollDispatcher::HasPending() const
 {
-    epoll_event events[16];
+    if ( m_eventsFirst < m_eventsCount )
+        return true;
 
-    const int rc = DoPoll(events, WXSIZEOF(events), timeout);
+    // retrieve all the available events instead of just checking whether
+    // there are any, Dispatch() will use them if we return true, so that there
+    // is still a single epoll_wait() call per event loop iteration
+    return RetrieveEvents(0) > 0;
+}
 
-    if ( rc == -1 )
+int wxEpollDispatcher::Dispatch(int timeout)
+{
+    if ( m_eventsFirst == m_eventsCount && RetrieveEvents(timeout) == -1 )
     {
         wxLogSysError(_("Waiting for IO on epoll descriptor %d failed"),
                       m_epollDescriptor);
@@ -216,24 +317,34 @@ int wxEpollDispatcher::Dispatch(int timeout)
     }
 
     int numEvents = 0;
-    for ( epoll_event *p = events; p < events + rc; p++ )
+    while ( m_eventsFirst < m_eventsCount )
     {
-        wxFDIOHandler * const handler = (wxFDIOHandler *)(p->data.ptr);
+        // copy the event as the handler may call Dispatch() recursively, which
+        // would consume the remaining events and reuse the buffer
+        const epoll_event ev = m_events[m_eventsFirst++];
+
+        // the handler can be NULL if the descriptor was unregistered by one of
+        // the handlers called before, just ignore the event in this case
+        wxFDIOHandler * const handler = FindHandler(ev.data.fd);
         if ( !handler )
-        {
-            wxFAIL_MSG( wxT("NULL handler in epoll_event?") );
             continue;
-        }
+
+        // the event could also have been retrieved before the handler flags
+        // were changed, e.g. by one of the handlers called before or from
+        // HasPending(), so ignore the events it isn't interested in any more,
+        // except for EPOLLERR and EPOLLHUP which are always reported
+        const uint32_t events = ev.events &
+            (GetEpollMask(m_handlers[ev.data.fd].flags) | EPOLLERR | EPOLLHUP);
 
         // note that for compatibility with wxSelectDispatcher we call
         // OnReadWaiting() on EPOLLHUP as this is what epoll_wait() returns
         // when the write end of a pipe is closed while with select() the
         // remaining pipe end becomes ready for reading when this happens
-        if ( p->events & (EPOLLIN | EPOLLHUP) )
+        if ( events & (EPOLLIN | EPOLLHUP) )
             handler->OnReadWaiting();
-        else if ( p->events & EPOLLOUT )
+        else if ( events & EPOLLOUT )
             handler->OnWriteWaiting();
-        else if ( p->events & EPOLLERR )
+        else if ( events & EPOLLERR )
             handler->OnExceptionWaiting();
         else
             continue;
@@ -23,7 +23,6 @@
     #include "wx/log.h"
     #include "wx/module.h"
     #include "wx/app.h"
-    #include "wx/list.h"
     #include "wx/hashmap.h"
     #include "wx/event.h"
 #endif
@@ -38,12 +37,13 @@
 
 #include "wx/unix/private/timer.h"
 
-#include "wx/listimpl.cpp"
-WX_DEFINE_LIST(wxTimerList)
-
 // trace mask for the debugging messages used here
 #define wxTrace_Timer wxT("timer")
 
+// all timers expiring during the same tick, i.e. the smallest interval which
+// can be used as the event loop timeout, are notified together
+static const long wxTIMER_TICK_USEC = 1000;
+
 // ============================================================================
 // wxTimerScheduler implementation
 // ============================================================================
@@ -52,33 +52,32 @@ wxTimerScheduler *wxTimerScheduler::ms_instance = NULL;
 
 wxTimerScheduler::~wxTimerScheduler()
 {
-    for ( wxTimerList::iterator node = m_timers.begin();
-          node != m_timers.end();
-          ++node )
+    for ( wxTimerHeap::iterator i = m_timers.begin();
+          i != m_timers.end();
+          ++i )
     {
-        delete *node;
+        (*i)->m_timer->SetSchedule(NULL);
+        delete *i;
     }
 }
 
 void wxTimerScheduler::AddTimer(wxUnixTimerImpl *timer, wxUsecClock_t expiration)
 {
-    DoAddTimer(new wxTimerSchedule(timer, expiration));
+    wxASSERT_MSG( !timer->GetSchedule(), wxT("adding the same timer twice?") );
+
+    wxTimerSchedule * const s = new wxTimerSchedule(timer, expiration);
+    timer->SetSchedule(s);
+
+    DoAddTimer(s);
 }
 
 void wxTimerScheduler::DoAddTimer(wxTimerSchedule *s)
 {
-    // do an insertion sort to keep the list sorted in expiration order
-    wxTimerList::iterator node;
-    for ( node = m_timers.begin(); node != m_timers.end(); ++node )
-    {
-        wxASSERT_MSG( (*node)->m_timer != s->m_timer,
-                      wxT("adding the same timer twice?") );
+    s->m_serial = m_serial++;
 
-        if ( (*node)->m_expiration > s->m_expiration )
-            break;
-    }
-
-    m_timers.insert(node, s);
+    m_timers.push_back(s);
+    s->m_index = m_timers.size() - 1;
+    SiftUp(s->m_index);
 
     wxLogTrace(wxTrace_Timer, wxT("Inserted timer %d expiring at %s"),
                s->m_timer->GetId(),
@@ -89,19 +88,74 @@ void wxTimerScheduler::RemoveTimer(wxUnixTimerImpl *timer)
 {
     wxLogTrace(wxTrace_Timer, wxT("Removing timer %d"), timer->GetId());
 
-    for ( wxTimerList::iterator node = m_timers.begin();
-          node != m_timers.end();
-          ++node )
+    wxTimerSchedule * const s = timer->GetSchedule();
+    wxCHECK_RET( s && s->m_index < m_timers.size() && m_timers[s->m_index] == s,
+                 wxT("removing inexistent timer?") );
+
+    DoRemoveAt(s->m_index);
+
+    timer->SetSchedule(NULL);
+    delete s;
+}
+
+void wxTimerScheduler::DoRemoveAt(size_t n)
+{
+    const size_t last = m_timers.size() - 1;
+    if ( n != last )
     {
-        if ( (*node)->m_timer == timer )
-        {
-            delete *node;
-            m_timers.erase(node);
-            return;
-        }
+        // replace the removed element with the last one and move it to its
+        // correct position, which may be either above or below this one
+        DoSetAt(n, m_timers[last]);
+        m_timers.pop_back();
+
+        if ( n > 0 && IsBefore(m_timers[n], m_timers[(n - 1) / 2]) )
+            SiftUp(n);
+        else
+            SiftDown(n);
+    }
+    else
+    {
+        m_timers.pop_back();
+    }
+}
+
+void wxTimerScheduler::SiftUp(size_t n)
+{
+    wxTimerSchedule * const s = m_timers[n];
+    while ( n > 0 )
+    {
+        const size_t parent = (n - 1) / 2;
+        if ( !IsBefore(s, m_timers[parent]) )
+            break;
+
+        DoSetAt(n, m_timers[parent]);
+        n = parent;
     }
 
-    wxFAIL_MSG( wxT("removing inexistent timer?") );
+    DoSetAt(n, s);
+}
+
+void wxTimerScheduler::SiftDown(size_t n)
+{
+    const size_t count = m_timers.size();
+    wxTimerSchedule * const s = m_timers[n];
+    for ( ;; )
+    {
+        size_t child = 2*n + 1;
+        if ( child >= count )
+            break;
+
+        if ( child + 1 < count && IsBefore(m_timers[child + 1], m_timers[child]) )
+            child++;
+
+        if ( !IsBefore(m_timers[child], s) )
+            break;
+
+        DoSetAt(n, m_timers[child]);
+        n = child;
+    }
+
+    DoSetAt(n, s);
 }
 
 bool wxTimerScheduler::GetNext(wxUsecClock_t *remaining) const
@@ -111,12 +165,21 @@ bool wxTimerScheduler::GetNext(wxUsecClock_t *remaining) const
 
     wxCHECK_MSG( remaining, false, wxT("NULL pointer") );
 
-    *remaining = (*m_timers.begin())->m_expiration - wxGetUTCTimeUSec();
+    *remaining = m_timers[0]->m_expiration - wxGetUTCTimeUSec();
     if ( *remaining < 0 )
     {
         // timer already expired, don't wait at all before notifying it
         *remaining = 0;
     }
+    else
+    {
+        // round the time up to the end of the tick: this ensures that we don't
+        // wake up just before the timer expiration only to find that nothing
+        // can be notified yet and also that all the other timers expiring
+        // during the same tick are notified at once, after a single wakeup
+        *remaining += wxTIMER_TICK_USEC - 1;
+        *remaining -= *remaining % wxTIMER_TICK_USEC;
+    }
 
     return true;
 }
@@ -130,21 +193,22 @@ bool wxTimerScheduler::NotifyExpired()
 
     typedef wxVector<wxUnixTimerImpl *> TimerImpls;
     TimerImpls toNotify;
-    for ( wxTimerList::iterator next,
-            cur = m_timers.begin(); cur != m_timers.end(); cur = next )
+
+    // periodic timers are rescheduled only after collecting all the expired
+    // ones, otherwise a timer with 0 interval would be found again and again
+    typedef wxVector<wxTimerSchedule *> TimerSchedules;
+    TimerSchedules toReschedule;
+
+    while ( !m_timers.empty() )
     {
-        wxTimerSchedule * const s = *cur;
+        wxTimerSchedule * const s = m_timers[0];
         if ( s->m_expiration > now )
         {
-            // as the list is sorted by expiration time, we can skip the rest
+            // the heap top expires first, so no other timers expired neither
             break;
         }
 
-        // remember next as we will delete the node pointed to by cur
-        next = cur;
-        ++next;
-
-        m_timers.erase(cur);
+        DoRemoveAt(0);
 
         // check whether we need to keep this timer
         wxUnixTimerImpl * const timer = s->m_timer;
@@ -154,6 +218,7 @@ bool wxTimerScheduler::NotifyExpired()
             // here as it would attempt to remove the timer from our list and
             // we had already done it, so we just need to reset its state
             timer->MarkStopped();
+            timer->SetSchedule(NULL);
 
             // don't need it any more
             delete s;
@@ -165,19 +230,27 @@ bool wxTimerScheduler::NotifyExpired()
             // expiration time because it could happen that we're late and the
             // current expiration time is (far) in the past
             s->m_expiration = now + timer->GetInterval()*1000;
-            DoAddTimer(s);
+            toReschedule.push_back(s);
         }
 
         // we can't notify the timer from this loop as the timer event handler
         // could modify m_timers (for example, but not only, by stopping this
-        // timer) which would render our iterators invalid, so do it after the
-        // loop end
+        // timer) which would invalidate the heap top we're working with, so
+        // do it after the loop end
         toNotify.push_back(timer);
     }
 
     if ( toNotify.empty() )
         return false;
 
+    for ( TimerSchedules::const_iterator i = toReschedule.begin(),
+                                         end = toReschedule.end();
+          i != end;
+          ++i )
+    {
+        DoAddTimer(*i);
+    }
+
     for ( TimerImpls::const_iterator i = toNotify.begin(),
                                      end = toNotify.end();
           i != end;
@@ -197,6 +270,7 @@ wxUnixTimerImpl::wxUnixTimerImpl(wxTimer* timer)
                : wxTimerImpl(timer)
 {
     m_isRunning = false;
+    m_schedule = NULL;
 }
 
 bool wxUnixTimerImpl::Start(int milliseconds, bool oneShot)
@@ -29,6 +29,7 @@
 #include "wx/zstream.h"
 #include "wx/strconv.h"
 #include "wx/scopedptr.h"
+#include "wx/vector.h"
 #include "wx/versioninfo.h"
 
 #include "expat.h" // from Expat
@@ -42,6 +43,7 @@ wxIMPLEMENT_CLASS(wxXmlDocument, wxObject);
 
 // a private utility used by wxXML
 static bool wxIsWhiteOnly(const wxString& buf);
+static bool wxIsWhiteOnly(const char *buf, size_t len);
 
 
 //-----------------------------------------------------------------------------
@@ -650,6 +652,18 @@ bool wxIsWhiteOnly(const wxString& buf)
     return true;
 }
 
+// the same function for the UTF-8 strings produced by Expat
+bool wxIsWhiteOnly(const char *buf, size_t len)
+{
+    for ( const char * const end = buf + len; buf != end; ++buf )
+    {
+        const char c = *buf;
+        if ( c != ' ' && c != '\t' && c != '\n' && c != '\r' )
+            return false;
+    }
+    return true;
+}
+
 
 struct wxXmlParsingContext
 {
@@ -658,6 +672,7 @@ struct wxXmlParsingContext
           node(NULL),
           lastChild(NULL),
           lastAsText(NULL),
+          textLineNo(-1),
           doctype(NULL),
           removeWhiteOnlyNodes(false)
     {}
@@ -666,7 +681,9 @@ struct wxXmlParsingContext
     wxMBConv  *conv;
     wxXmlNode *node;                    // the node being parsed
     wxXmlNode *lastChild;               // the last child of "node"
-    wxXmlNode *lastAsText;              // the last _text_ child of "node"
+    wxXmlNode *lastAsText;              // the CDATA section being parsed
+    wxMemoryBuffer text;                // text not added to the tree yet
+    int        textLineNo;              // and the line where it started
     wxString   encoding;
     wxString   version;
     wxXmlDoctype *doctype;
@@ -680,23 +697,64 @@ struct wxXmlParsingContext
     wxASSERT( ctx->lastChild == NULL ||                             \
               ctx->lastChild->GetParent() == ctx->node )
 
+// Text is reported by Expat in several pieces, so it is accumulated in
+// ctx->text and added to the tree only when something else is found: this
+// avoids reallocating the node contents for each of the pieces.
+static void FlushText(wxXmlParsingContext *ctx)
+{
+    if ( !ctx->text.GetDataLen() )
+        return;
+
+    const wxString str = CharToString(ctx->conv,
+                                      (const char *)ctx->text.GetData(),
+                                      ctx->text.GetDataLen());
+    ctx->text.SetDataLen(0);
+
+    if (ctx->lastAsText)
+    {
+        ctx->lastAsText->SetContent(ctx->lastAsText->GetContent() + str);
+    }
+    else
+    {
+        wxXmlNode *textnode =
+            new wxXmlNode(wxXML_TEXT_NODE, wxS("text"), str, ctx->textLineNo);
+
+        ASSERT_LAST_CHILD_OK(ctx);
+        ctx->node->InsertChildAfter(textnode, ctx->lastChild);
+        ctx->lastChild = textnode;
+    }
+}
+
 extern "C" {
 static void StartElementHnd(void *userData, const char *name, const char **atts)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
-    wxXmlNode *node = new wxXmlNode(wxXML_ELEMENT_NODE,
-                                    CharToString(ctx->conv, name),
-                                    wxEmptyString,
-                                    XML_GetCurrentLineNumber(ctx->parser));
-    const char **a = atts;
+    FlushText(ctx);
 
-    // add node attributes
-    while (*a)
+    // create the list of node attributes directly instead of using
+    // AddAttribute() which would need to find the end of the list every time
+    wxXmlAttribute *attrs = NULL,
+                   *lastAttr = NULL;
+    for ( const char **a = atts; *a; a += 2 )
     {
-        node->AddAttribute(CharToString(ctx->conv, a[0]), CharToString(ctx->conv, a[1]));
-        a += 2;
+        wxXmlAttribute * const attr =
+            new wxXmlAttribute(CharToString(ctx->conv, a[0]),
+                               CharToString(ctx->conv, a[1]));
+        if ( lastAttr )
+            lastAttr->SetNext(attr);
+        else
+            attrs = attr;
+
+        lastAttr = attr;
     }
 
+    wxXmlNode *node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE,
+                                    CharToString(ctx->conv, name),
+                                    wxEmptyString,
+                                    attrs,
+                                    NULL,
+                                    XML_GetCurrentLineNumber(ctx->parser));
+
     ASSERT_LAST_CHILD_OK(ctx);
     ctx->node->InsertChildAfter(node, ctx->lastChild);
     ctx->lastAsText = NULL;
@@ -708,6 +766,7 @@ static void StartElementHnd(void *userData, const char *name, const char **atts)
 static void EndElementHnd(void *userData, const char* WXUNUSED(name))
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    FlushText(ctx);
 
     // we're exiting the last children of ctx->node->GetParent() and going
     // back one level up, so current value of ctx->node points to the last
@@ -721,34 +780,23 @@ static void EndElementHnd(void *userData, const char* WXUNUSED(name))
 static void TextHnd(void *userData, const char *s, int len)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
-    wxString str = CharToString(ctx->conv, s, len);
 
-    if (ctx->lastAsText)
+    // check if this is the start of a new text node
+    if ( !ctx->lastAsText && !ctx->text.GetDataLen() )
     {
-        ctx->lastAsText->SetContent(ctx->lastAsText->GetContent() + str);
-    }
-    else
-    {
-        bool whiteOnly = false;
-        if (ctx->removeWhiteOnlyNodes)
-            whiteOnly = wxIsWhiteOnly(str);
-
-        if (!whiteOnly)
-        {
-            wxXmlNode *textnode =
-                new wxXmlNode(wxXML_TEXT_NODE, wxS("text"), str,
-                              XML_GetCurrentLineNumber(ctx->parser));
+        if ( ctx->removeWhiteOnlyNodes && wxIsWhiteOnly(s, len) )
+            return;
 
-            ASSERT_LAST_CHILD_OK(ctx);
-            ctx->node->InsertChildAfter(textnode, ctx->lastChild);
-            ctx->lastChild= ctx->lastAsText = textnode;
-        }
+        ctx->textLineNo = XML_GetCurrentLineNumber(ctx->parser);
     }
+
+    ctx->text.AppendData(s, len);
 }
 
 static void StartCdataHnd(void *userData)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    FlushText(ctx);
 
     wxXmlNode *textnode =
         new wxXmlNode(wxXML_CDATA_SECTION_NODE, wxS("cdata"), wxS(""),
@@ -762,6 +810,7 @@ static void StartCdataHnd(void *userData)
 static void EndCdataHnd(void *userData)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    FlushText(ctx);
 
     // we need to reset this pointer so that subsequent text nodes don't append
     // their contents to this one but create new wxXML_TEXT_NODE objects (or
@@ -773,6 +822,7 @@ static void EndCdataHnd(void *userData)
 static void CommentHnd(void *userData, const char *data)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    FlushText(ctx);
 
     wxXmlNode *commentnode =
         new wxXmlNode(wxXML_COMMENT_NODE,
@@ -788,6 +838,7 @@ static void CommentHnd(void *userData, const char *data)
 static void PIHnd(void *userData, const char *target, const char *data)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    FlushText(ctx);
 
     wxXmlNode *pinode =
         new wxXmlNode(wxXML_PI_NODE, CharToString(ctx->conv, target),
@@ -874,7 +925,7 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
     m_encoding = encoding;
 #endif
 
-    const size_t BUFSIZE = 1024;
+    const size_t BUFSIZE = 16384;
     char buf[BUFSIZE];
     wxXmlParsingContext ctx;
     bool done;
@@ -921,6 +972,8 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
 
     if (ok)
     {
+        FlushText(&ctx);
+
         if (!ctx.version.empty())
             SetVersion(ctx.version);
         if (!ctx.encoding.empty())
@@ -944,6 +997,384 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
 
 
 
+//-----------------------------------------------------------------------------
+//  wxXmlReader
+//-----------------------------------------------------------------------------
+
+// an item found by the parser, all offsets are in wxXmlReaderData::m_buf
+struct wxXmlReaderItem
+{
+    wxXmlReaderItemType type;
+    int lineNo;
+    size_t name;                        // element name
+    size_t firstAttr, numAttrs;         // index in wxXmlReaderData::m_attrs
+    size_t text, textLen;               // text contents
+};
+
+// The data used by wxXmlReader: Expat is a push parser, so we feed it with
+// the stream data in chunks and remember all the items found in each chunk
+// to return them one by one later. All the strings are stored in the same
+// buffer which is reused for all chunks, so that nothing needs to be
+// allocated once it becomes big enough.
+class wxXmlReaderData
+{
+public:
+    wxXmlReaderData(wxInputStream& stream, int flags)
+        : m_stream(stream)
+    {
+        m_parser = XML_ParserCreate(NULL);
+        m_removeWhiteOnly = (flags & wxXMLDOC_KEEP_WHITESPACE_NODES) == 0;
+        m_ok = true;
+        m_done = false;
+        m_textOpen = false;
+        m_current = 0;
+
+        m_items.push_back(wxXmlReaderItem());
+        m_items[0].type = wxXML_READER_END;
+        m_items[0].lineNo = -1;
+
+        m_buf.SetBufSize(2*BUFSIZE);
+    }
+
+    ~wxXmlReaderData()
+    {
+        XML_ParserFree(m_parser);
+    }
+
+    XML_Parser GetParser() const { return m_parser; }
+
+    wxXmlReaderItemType Next();
+
+    bool IsOk() const { return m_ok; }
+
+    const wxXmlReaderItem& GetItem() const { return m_items[m_current]; }
+
+    const char *GetString(size_t ofs) const
+        { return static_cast<const char *>(m_buf.GetData()) + ofs; }
+
+    const char *GetAttributeName(size_t n) const
+        { return GetString(m_attrs[2*(GetItem().firstAttr + n)]); }
+    const char *GetAttributeValue(size_t n) const
+        { return GetString(m_attrs[2*(GetItem().firstAttr + n)+1]); }
+
+    // Called by Expat handlers.
+    void OnStartElement(const char *name, const char **atts);
+    void OnEndElement(const char *name);
+    void OnText(const char *s, int len);
+
+private:
+    enum { BUFSIZE = 16384 };
+
+    // parse the next chunk of data, return false if there is no more
+    bool ParseMore();
+
+    // add a new item without any strings, closing the current text item
+    wxXmlReaderItem& AddItem(wxXmlReaderItemType type);
+
+    // add a NUL-terminated string to the buffer and return its offset
+    size_t AddString(const char *s, size_t len);
+    size_t AddString(const char *s) { return AddString(s, strlen(s)); }
+
+    // the text item being accumulated, if any, is complete now
+    void CloseText();
+
+    // the number of items which can be returned
+    size_t GetCompleteCount() const
+        { return m_textOpen ? m_items.size() - 1 : m_items.size(); }
+
+    wxInputStream& m_stream;
+    XML_Parser m_parser;
+
+    bool m_removeWhiteOnly;
+    bool m_ok;                          // false after an error
+    bool m_done;                        // true after parsing the last chunk
+    bool m_textOpen;                    // last item is still being added to
+
+    wxVector<wxXmlReaderItem> m_items;  // the items found in the last chunk
+    size_t m_current;                   // index of the current one
+    wxVector<size_t> m_attrs;           // the attributes names and values
+    wxMemoryBuffer m_buf;               // all the strings
+    char m_chunk[BUFSIZE];              // the data read from the stream
+};
+
+extern "C" {
+static void ReaderStartElementHnd(void *userData, const char *name, const char **atts)
+{
+    static_cast<wxXmlReaderData *>(userData)->OnStartElement(name, atts);
+}
+
+static void ReaderEndElementHnd(void *userData, const char *name)
+{
+    static_cast<wxXmlReaderData *>(userData)->OnEndElement(name);
+}
+
+static void ReaderTextHnd(void *userData, const char *s, int len)
+{
+    static_cast<wxXmlReaderData *>(userData)->OnText(s, len);
+}
+} // extern "C"
+
+size_t wxXmlReaderData::AddString(const char *s, size_t len)
+{
+    const size_t ofs = m_buf.GetDataLen();
+    m_buf.AppendData(s, len);
+    m_buf.AppendByte('\0');
+
+    return ofs;
+}
+
+wxXmlReaderItem& wxXmlReaderData::AddItem(wxXmlReaderItemType type)
+{
+    CloseText();
+
+    wxXmlReaderItem item;
+    item.type = type;
+    item.lineNo = XML_GetCurrentLineNumber(m_parser);
+    item.name =
+    item.firstAttr =
+    item.numAttrs =
+    item.text =
+    item.textLen = 0;
+
+    m_items.push_back(item);
+
+    return m_items.back();
+}
+
+void wxXmlReaderData::CloseText()
+{
+    if ( !m_textOpen )
+        return;
+
+    m_textOpen = false;
+
+    const wxXmlReaderItem& item = m_items.back();
+    if ( m_removeWhiteOnly && wxIsWhiteOnly(GetString(item.text), item.textLen) )
+    {
+        // the text is always the last string in the buffer
+        m_buf.SetDataLen(item.text);
+        m_items.pop_back();
+    }
+}
+
+void wxXmlReaderData::OnStartElement(const char *name, const char **atts)
+{
+    wxXmlReaderItem& item = AddItem(wxXML_READER_START_ELEMENT);
+    item.name = AddString(name);
+    item.firstAttr = m_attrs.size() / 2;
+
+    for ( const char **a = atts; *a; a += 2 )
+    {
+        m_attrs.push_back(AddString(a[0]));
+        m_attrs.push_back(AddString(a[1]));
+        item.numAttrs++;
+    }
+}
+
+void wxXmlReaderData::OnEndElement(const char *name)
+{
+    wxXmlReaderItem& item = AddItem(wxXML_READER_END_ELEMENT);
+    item.name = AddString(name);
+}
+
+void wxXmlReaderData::OnText(const char *s, int len)
+{
+    if ( m_textOpen )
+    {
+        // append to the existing text, overwriting its trailing NUL
+        wxXmlReaderItem& item = m_items.back();
+        m_buf.SetDataLen(m_buf.GetDataLen() - 1);
+        m_buf.AppendData(s, len);
+        m_buf.AppendByte('\0');
+        item.textLen += len;
+    }
+    else
+    {
+        wxXmlReaderItem& item = AddItem(wxXML_READER_TEXT);
+        item.text = AddString(s, len);
+        item.textLen = len;
+        m_textOpen = true;
+    }
+}
+
+bool wxXmlReaderData::ParseMore()
+{
+    if ( m_done || !m_ok )
+        return false;
+
+    // forget all the items which were already returned, except for the text
+    // which may still be continued in the next chunk
+    if ( m_textOpen )
+    {
+        wxXmlReaderItem item = m_items.back();
+
+        char * const buf = static_cast<char *>(m_buf.GetData());
+        memmove(buf, buf + item.text, item.textLen + 1);
+        m_buf.SetDataLen(item.textLen + 1);
+        item.text = 0;
+
+        m_items.erase(m_items.begin(), m_items.end());
+        m_items.push_back(item);
+    }
+    else
+    {
+        m_buf.SetDataLen(0);
+        m_items.erase(m_items.begin(), m_items.end());
+    }
+
+    m_attrs.erase(m_attrs.begin(), m_attrs.end());
+    m_current = 0;
+
+    const size_t len = m_stream.Read(m_chunk, BUFSIZE).LastRead();
+    m_done = len < BUFSIZE;
+    if ( !XML_Parse(m_parser, m_chunk, len, m_done) )
+    {
+        wxString error(XML_ErrorString(XML_GetErrorCode(m_parser)),
+                       *wxConvCurrent);
+        wxLogError(_("XML parsing error: '%s' at line %d"),
+                   error.c_str(),
+                   (int)XML_GetCurrentLineNumber(m_parser));
+        // still return the items found before the error
+        m_ok = false;
+        m_done = true;
+    }
+
+    if ( m_done )
+        CloseText();
+
+    return true;
+}
+
+wxXmlReaderItemType wxXmlReaderData::Next()
+{
+    if ( m_current < m_items.size() &&
+            m_items[m_current].type == wxXML_READER_END )
+    {
+        // only happens initially, before parsing anything: just remove the
+        // dummy item
+        m_items.erase(m_items.begin(), m_items.end());
+    }
+    else
+    {
+        m_current++;
+    }
+
+    while ( m_current >= GetCompleteCount() )
+    {
+        if ( !ParseMore() )
+        {
+            // add a dummy item to make GetType() return wxXML_READER_END
+            m_items.erase(m_items.begin(), m_items.end());
+            m_items.push_back(wxXmlReaderItem());
+            m_items[0].type = wxXML_READER_END;
+            m_items[0].lineNo = XML_GetCurrentLineNumber(m_parser);
+            m_current = 0;
+            m_textOpen = false;
+
+            return wxXML_READER_END;
+        }
+    }
+
+    return m_items[m_current].type;
+}
+
+wxXmlReader::wxXmlReader(wxInputStream& stream, int flags)
+{
+    m_data = new wxXmlReaderData(stream, flags);
+
+    XML_Parser parser = m_data->GetParser();
+    XML_SetUserData(parser, m_data);
+    XML_SetElementHandler(parser, ReaderStartElementHnd, ReaderEndElementHnd);
+    XML_SetCharacterDataHandler(parser, ReaderTextHnd);
+    XML_SetUnknownEncodingHandler(parser, UnknownEncodingHnd, NULL);
+}
+
+wxXmlReader::~wxXmlReader()
+{
+    delete m_data;
+}
+
+wxXmlReaderItemType wxXmlReader::Next()
+{
+    return m_data->Next();
+}
+
+bool wxXmlReader::IsOk() const
+{
+    return m_data->IsOk();
+}
+
+wxXmlReaderItemType wxXmlReader::GetType() const
+{
+    return m_data->GetItem().type;
+}
+
+int wxXmlReader::GetLineNumber() const
+{
+    return m_data->GetItem().lineNo;
+}
+
+const char *wxXmlReader::GetName() const
+{
+    const wxXmlReaderItem& item = m_data->GetItem();
+    wxCHECK_MSG( item.type == wxXML_READER_START_ELEMENT ||
+                    item.type == wxXML_READER_END_ELEMENT, "",
+                 "only elements have names" );
+
+    return m_data->GetString(item.name);
+}
+
+size_t wxXmlReader::GetAttributesCount() const
+{
+    return m_data->GetItem().numAttrs;
+}
+
+const char *wxXmlReader::GetAttributeName(size_t n) const
+{
+    wxCHECK_MSG( n < GetAttributesCount(), "", "invalid attribute index" );
+
+    return m_data->GetAttributeName(n);
+}
+
+const char *wxXmlReader::GetAttributeValue(size_t n) const
+{
+    wxCHECK_MSG( n < GetAttributesCount(), "", "invalid attribute index" );
+
+    return m_data->GetAttributeValue(n);
+}
+
+const char *wxXmlReader::GetAttribute(const char *name) const
+{
+    const size_t count = GetAttributesCount();
+    for ( size_t n = 0; n < count; n++ )
+    {
+        if ( strcmp(m_data->GetAttributeName(n), name) == 0 )
+            return m_data->GetAttributeValue(n);
+    }
+
+    return NULL;
+}
+
+const char *wxXmlReader::GetText() const
+{
+    const wxXmlReaderItem& item = m_data->GetItem();
+    wxCHECK_MSG( item.type == wxXML_READER_TEXT, "",
+                 "only text items have text" );
+
+    return m_data->GetString(item.text);
+}
+
+size_t wxXmlReader::GetTextLength() const
+{
+    const wxXmlReaderItem& item = m_data->GetItem();
+    wxCHECK_MSG( item.type == wxXML_READER_TEXT, 0,
+                 "only text items have text" );
+
+    return item.textLen;
+}
+
+
+
 //-----------------------------------------------------------------------------
 //  wxXmlDocument saving routines
 //-----------------------------------------------------------------------------
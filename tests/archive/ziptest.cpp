@@ -19,6 +19,7 @@
 #if wxUSE_STREAMS && wxUSE_ZIPSTREAM
 
 #include "archivetest.h"
+#include "wx/mstream.h"
 #include "wx/zipstrm.h"
 
 using std::string;
@@ -204,6 +205,145 @@ void ZipPipeTestCase::runTest()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Check that the entries compressed in parallel are written in order and can
+// be read back both as usual and using wxZipInputStream::ReadEntries()
+
+class ZipParallelTestCase : public CppUnit::TestCase
+{
+public:
+    ZipParallelTestCase(string name) :
+        CppUnit::TestCase(TestId::MakeId() + name)
+    { }
+
+protected:
+    void runTest();
+};
+
+void ZipParallelTestCase::runTest()
+{
+    // entries of various sizes, some of them not compressible at all
+    const int count = 20;
+    wxVector<wxMemoryBuffer> contents;
+
+    for (int i = 0; i < count; i++) {
+        wxMemoryBuffer buf;
+        size_t size = i % 5 ? i * 3571 : 0;
+        char *p = (char*)buf.GetWriteBuf(size);
+        for (size_t j = 0; j < size; j++)
+            p[j] = i % 3 ? char('a' + j % 26) : char(rand());
+        buf.UngetWriteBuf(size);
+        contents.push_back(buf);
+    }
+
+    wxMemoryOutputStream out;
+    {
+        wxZipOutputStream zip(out);
+        zip.SetParallelCompression();
+        CPPUNIT_ASSERT(zip.IsParallelCompression());
+
+        for (int i = 0; i < count; i++) {
+            wxZipEntry *entry = new wxZipEntry(wxString::Format("file%d", i));
+            if (i == 7)
+                entry->SetMethod(wxZIP_METHOD_STORE);
+            CPPUNIT_ASSERT(zip.PutNextEntry(entry));
+            zip.Write(contents[i].GetData(), contents[i].GetDataLen());
+
+            // the entry being written is written out directly when synced
+            if (i == 11)
+                zip.Sync();
+        }
+
+        CPPUNIT_ASSERT(zip.Close());
+    }
+
+    wxMemoryInputStream in(out);
+    wxZipInputStream zip(in);
+    wxVector<wxZipEntry*> entries;
+
+    for (int i = 0; i < count; i++) {
+        wxZipEntry *entry = zip.GetNextEntry();
+        CPPUNIT_ASSERT(entry != NULL);
+        entries.push_back(entry);
+
+        CPPUNIT_ASSERT_EQUAL(wxString::Format("file%d", i), entry->GetName());
+
+        wxMemoryOutputStream data;
+        zip.Read(data);
+        CPPUNIT_ASSERT(zip.Eof());
+        CPPUNIT_ASSERT_EQUAL(contents[i].GetDataLen(), size_t(data.GetSize()));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(int(wxZIP_METHOD_STORE), entries[7]->GetMethod());
+
+    wxVector<wxMemoryBuffer> data;
+    CPPUNIT_ASSERT(zip.ReadEntries(entries, data));
+    CPPUNIT_ASSERT_EQUAL(size_t(count), data.size());
+
+    for (int i = 0; i < count; i++) {
+        const size_t size = contents[i].GetDataLen();
+        CPPUNIT_ASSERT_EQUAL(size, data[i].GetDataLen());
+        CPPUNIT_ASSERT(memcmp(contents[i].GetData(), data[i].GetData(), size) == 0);
+        delete entries[i];
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Entries too big to be kept in memory in parallel mode are written out
+// directly, check that they are still compressed and have the data descriptor
+// needed when the output stream is not seekable
+
+class ZipParallelBigEntryTestCase : public CppUnit::TestCase
+{
+public:
+    ZipParallelBigEntryTestCase(string name) :
+        CppUnit::TestCase(TestId::MakeId() + name)
+    { }
+
+protected:
+    void runTest();
+};
+
+void ZipParallelBigEntryTestCase::runTest()
+{
+    // more than 16MB of compressible data written all at once
+    const size_t size = 17 * 1024 * 1024;
+    wxMemoryBuffer contents;
+    char *p = (char*)contents.GetWriteBuf(size);
+    for (size_t i = 0; i < size; i++)
+        p[i] = char('a' + i % 26);
+    contents.UngetWriteBuf(size);
+
+    TestOutputStream out(PipeOut);
+    {
+        wxZipOutputStream zip(out);
+        zip.SetParallelCompression();
+
+        CPPUNIT_ASSERT(zip.PutNextEntry(wxT("big")));
+        CPPUNIT_ASSERT(zip.Write(contents.GetData(), size).IsOk());
+        CPPUNIT_ASSERT(zip.Close());
+    }
+
+    CPPUNIT_ASSERT(out.GetLength() < wxFileOffset(size / 100));
+
+    TestInputStream in(out, 0);
+    wxZipInputStream zip(in);
+
+    auto_ptr<wxZipEntry> entry(zip.GetNextEntry());
+    CPPUNIT_ASSERT(entry.get() != NULL);
+    CPPUNIT_ASSERT_EQUAL(int(wxZIP_METHOD_DEFLATE), entry->GetMethod());
+
+    wxMemoryOutputStream data;
+    zip.Read(data);
+    CPPUNIT_ASSERT(zip.Eof());
+    CPPUNIT_ASSERT_EQUAL(size, size_t(data.GetSize()));
+    CPPUNIT_ASSERT(memcmp(contents.GetData(),
+                          data.GetOutputStreamBuffer()->GetBufferStart(),
+                          size) == 0);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Zip suite 
 
@@ -242,6 +382,9 @@ ArchiveTestSuite *ziptest::makeSuite()
         }
 #endif
 
+    addTest(new ZipParallelTestCase("ZipParallelTestCase"));
+    addTest(new ZipParallelBigEntryTestCase("ZipParallelBigEntryTestCase"));
+
     return this;
 }
 
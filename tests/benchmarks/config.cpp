@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/config.cpp
+// Purpose:     wxFileConfig benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/fileconf.h"
+#include "wx/sstream.h"
+
+#include "bench.h"
+
+#if wxUSE_CONFIG && wxUSE_FILECONFIG && wxUSE_STREAMS
+
+// The config object used by the benchmarks contains the given number of
+// entries (50000 by default) in a single group.
+static wxFileConfig *gs_config = NULL;
+static long gs_numEntries = 0;
+
+static wxString GetEntryName(long n)
+{
+    return wxString::Format("/Group/Entry%ld", n);
+}
+
+static bool ConfigInit()
+{
+    gs_numEntries = Bench::GetNumericParameter();
+    if ( !gs_numEntries )
+        gs_numEntries = 50000;
+
+    wxStringInputStream is(wxEmptyString);
+    gs_config = new wxFileConfig(is);
+
+    // Write the entries in the reverse order as this is the worst case for
+    // keeping them sorted.
+    for ( long n = gs_numEntries - 1; n >= 0; n-- )
+        gs_config->Write(GetEntryName(n), n);
+
+    return true;
+}
+
+static void ConfigDone()
+{
+    delete gs_config;
+    gs_config = NULL;
+}
+
+BENCHMARK_FUNC_WITH_INIT(FileConfigRead, ConfigInit, ConfigDone)
+{
+    static long s_entry = 0;
+
+    s_entry = (s_entry + 7919) % gs_numEntries;
+
+    long value;
+    return gs_config->Read(GetEntryName(s_entry), &value) && value == s_entry;
+}
+
+BENCHMARK_FUNC_WITH_INIT(FileConfigWrite, ConfigInit, ConfigDone)
+{
+    static long s_entry = 0;
+
+    // Add new entries in random order.
+    s_entry = (s_entry + 7919) % gs_numEntries;
+
+    return gs_config->Write(GetEntryName(gs_numEntries + s_entry), s_entry);
+}
+
+#endif // wxUSE_CONFIG && wxUSE_FILECONFIG && wxUSE_STREAMS
@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/events.cpp
+// Purpose:     Event queuing benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/app.h"
+#include "wx/event.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
+
+#include "bench.h"
+
+#if wxUSE_THREADS
+
+// During each benchmark run, every thread queues the given number of events
+// for the handler in the main thread.
+static const int NUM_THREADS = 4;
+static const int EVENTS_PER_THREAD = 25;
+
+class EventSink : public wxEvtHandler
+{
+public:
+    EventSink()
+    {
+        m_received = 0;
+
+        Bind(wxEVT_THREAD, &EventSink::OnThreadEvent, this);
+    }
+
+    long GetReceived() const { return m_received; }
+
+private:
+    void OnThreadEvent(wxThreadEvent& WXUNUSED(event)) { m_received++; }
+
+    long m_received;
+};
+
+static EventSink *gs_sink = NULL;
+static wxSemaphore *gs_semStart = NULL;
+static bool gs_stop = false;
+
+class EventSourceThread : public wxThread
+{
+public:
+    EventSourceThread() : wxThread(wxTHREAD_JOINABLE) { }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        for ( ;; )
+        {
+            gs_semStart->Wait();
+            if ( gs_stop )
+                break;
+
+            for ( int n = 0; n < EVENTS_PER_THREAD; n++ )
+                wxQueueEvent(gs_sink, new wxThreadEvent);
+        }
+
+        return 0;
+    }
+};
+
+static wxVector<EventSourceThread *> gs_threads;
+
+static bool EventsInit()
+{
+    gs_sink = new EventSink;
+    gs_semStart = new wxSemaphore;
+    gs_stop = false;
+
+    for ( int n = 0; n < NUM_THREADS; n++ )
+    {
+        EventSourceThread * const thread = new EventSourceThread;
+        if ( thread->Run() != wxTHREAD_NO_ERROR )
+        {
+            delete thread;
+            return false;
+        }
+
+        gs_threads.push_back(thread);
+    }
+
+    return true;
+}
+
+static void EventsDone()
+{
+    gs_stop = true;
+
+    size_t n;
+    for ( n = 0; n < gs_threads.size(); n++ )
+        gs_semStart->Post();
+
+    for ( n = 0; n < gs_threads.size(); n++ )
+    {
+        gs_threads[n]->Wait();
+        delete gs_threads[n];
+    }
+
+    gs_threads.clear();
+
+    wxDELETE(gs_semStart);
+    wxDELETE(gs_sink);
+}
+
+BENCHMARK_FUNC_WITH_INIT(QueueEventFromThreads, EventsInit, EventsDone)
+{
+    const long expected = gs_sink->GetReceived() +
+                            NUM_THREADS*EVENTS_PER_THREAD;
+
+    for ( int n = 0; n < NUM_THREADS; n++ )
+        gs_semStart->Post();
+
+    while ( gs_sink->GetReceived() < expected )
+        wxTheApp->ProcessPendingEvents();
+
+    return gs_sink->GetReceived() == expected;
+}
+
+#endif // wxUSE_THREADS
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/fdio.cpp
+// Purpose:     wxFDIODispatcher benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/defs.h"
+
+#ifdef __UNIX__
+
+#include "wx/utils.h"
+#include "wx/vector.h"
+#include "wx/private/fdiodispatcher.h"
+
+#include "bench.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+
+// The benchmarks here register the given number of pipes (500 by default, use
+// "-p 5000" to check how the dispatcher scales, possibly after increasing the
+// limit on the number of open files) with the global dispatcher and then make
+// a fixed number of them ready during each run.
+static const int NUM_ACTIVE = 64;
+
+static long gs_received = 0;
+
+class PipeHandler : public wxFDIOHandler
+{
+public:
+    PipeHandler()
+    {
+        m_fds[0] =
+        m_fds[1] = -1;
+    }
+
+    virtual ~PipeHandler()
+    {
+        if ( m_fds[0] != -1 )
+        {
+            close(m_fds[0]);
+            close(m_fds[1]);
+        }
+    }
+
+    bool Create()
+    {
+        if ( pipe(m_fds) != 0 )
+        {
+            m_fds[0] =
+            m_fds[1] = -1;
+            return false;
+        }
+
+        fcntl(m_fds[0], F_SETFL, fcntl(m_fds[0], F_GETFL) | O_NONBLOCK);
+
+        return true;
+    }
+
+    int GetReadFD() const { return m_fds[0]; }
+
+    bool Notify() { return write(m_fds[1], "x", 1) == 1; }
+
+    virtual void OnReadWaiting() wxOVERRIDE
+    {
+        // read everything as required for the edge-triggered notifications
+        char buf[16];
+        ssize_t rc;
+        while ( (rc = read(m_fds[0], buf, sizeof(buf))) > 0 )
+            gs_received += rc;
+    }
+
+    virtual void OnWriteWaiting() wxOVERRIDE { }
+    virtual void OnExceptionWaiting() wxOVERRIDE { }
+
+private:
+    int m_fds[2];
+};
+
+static wxVector<PipeHandler *> gs_pipes;
+
+static void FDIODone()
+{
+    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+
+    for ( size_t n = 0; n < gs_pipes.size(); n++ )
+    {
+        dispatcher->UnregisterFD(gs_pipes[n]->GetReadFD());
+        delete gs_pipes[n];
+    }
+
+    gs_pipes.clear();
+}
+
+static bool DoFDIOInit(int flags)
+{
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 500;
+
+    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+    if ( !dispatcher )
+        return false;
+
+    for ( long n = 0; n < count; n++ )
+    {
+        PipeHandler * const handler = new PipeHandler;
+        if ( !handler->Create() )
+        {
+            delete handler;
+            FDIODone();
+            return false;
+        }
+
+        gs_pipes.push_back(handler);
+
+        if ( !dispatcher->RegisterFD(handler->GetReadFD(), handler, flags) )
+        {
+            FDIODone();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool FDIOInit()
+{
+    return DoFDIOInit(wxFDIO_INPUT);
+}
+
+static bool FDIOEdgeInit()
+{
+    return DoFDIOInit(wxFDIO_INPUT | wxFDIO_EDGE_TRIGGERED);
+}
+
+// Notify some of the pipes and process the events in the same way as the
+// console event loop does it, i.e. calling Dispatch() only if HasPending().
+static bool DoDispatchPipes()
+{
+    static size_t s_pipe = 0;
+
+    const int active = wxMin(NUM_ACTIVE, static_cast<int>(gs_pipes.size()));
+    for ( int n = 0; n < active; n++ )
+    {
+        s_pipe = (s_pipe + 7919) % gs_pipes.size();
+        if ( !gs_pipes[s_pipe]->Notify() )
+            return false;
+    }
+
+    // Notice that the same pipe can be notified more than once.
+    const long expected = gs_received + active;
+
+    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+    while ( gs_received < expected )
+    {
+        if ( !dispatcher->HasPending() )
+            return false;
+
+        if ( dispatcher->Dispatch() == -1 )
+            return false;
+    }
+
+    return gs_received == expected;
+}
+
+BENCHMARK_FUNC_WITH_INIT(DispatchPipes, FDIOInit, FDIODone)
+{
+    return DoDispatchPipes();
+}
+
+BENCHMARK_FUNC_WITH_INIT(DispatchPipesEdge, FDIOEdgeInit, FDIODone)
+{
+    return DoDispatchPipes();
+}
+
+#endif // __UNIX__
@@ -7,7 +7,15 @@
 // Licence:     wxWindows licence
 /////////////////////////////////////////////////////////////////////////////
 
+#include "wx/anidecod.h"
+#include "wx/atomic.h"
+#include "wx/gifdecod.h"
 #include "wx/image.h"
+#include "wx/imaggif.h"
+#include "wx/mstream.h"
+#include "wx/quantize.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
 
 #include "bench.h"
 
@@ -88,3 +96,278 @@ BENCHMARK_FUNC(ShrinkHighQuality)
 {
     return GetTestImage().Scale(50, 50, wxIMAGE_QUALITY_HIGH).IsOk();
 }
+
+// Blurring is typically applied to bigger images, so enlarge the test one.
+static const wxImage& GetBigTestImage()
+{
+    static wxImage s_image;
+    if ( !s_image.IsOk() && GetTestImage().IsOk() )
+    {
+        s_image = GetTestImage().Scale(2000, 2000);
+        if ( !s_image.HasAlpha() )
+            s_image.InitAlpha();
+    }
+
+    return s_image;
+}
+
+// The blur radius can be given on the command line and is 10 by default.
+static int GetBlurRadius()
+{
+    long radius = Bench::GetNumericParameter();
+    if ( !radius )
+        radius = 10;
+
+    return radius;
+}
+
+BENCHMARK_FUNC(BlurHorizontal)
+{
+    return GetBigTestImage().BlurHorizontal(GetBlurRadius()).IsOk();
+}
+
+BENCHMARK_FUNC(BlurVertical)
+{
+    return GetBigTestImage().BlurVertical(GetBlurRadius()).IsOk();
+}
+
+BENCHMARK_FUNC(Blur)
+{
+    return GetBigTestImage().Blur(GetBlurRadius()).IsOk();
+}
+
+// Use a 4K image for quantization benchmarks, as the time taken by it depends
+// mostly on the number of pixels.
+static const wxImage& Get4KTestImage()
+{
+    static wxImage s_image;
+    if ( !s_image.IsOk() && GetTestImage().IsOk() )
+        s_image = GetTestImage().Scale(3840, 2160, wxIMAGE_QUALITY_HIGH);
+
+    return s_image;
+}
+
+static bool QuantizeTestImage(int flags)
+{
+    wxImage image;
+    return wxQuantize::Quantize(Get4KTestImage(), image, 236, NULL,
+                                flags | wxQUANTIZE_FILL_DESTINATION_IMAGE) &&
+                image.IsOk();
+}
+
+BENCHMARK_FUNC(Quantize)
+{
+    return QuantizeTestImage(0);
+}
+
+BENCHMARK_FUNC(QuantizeOrdered)
+{
+    return QuantizeTestImage(wxQUANTIZE_ORDERED_DITHER);
+}
+
+#if wxUSE_GIF && wxUSE_PALETTE
+
+// Animated GIF benchmarks use an animation with the given number of frames
+// (100 by default) of the size typical for the animations found on the web.
+static wxMemoryBuffer gs_animationData;
+
+static bool AnimationInit()
+{
+    wxImage frame;
+    if ( !wxQuantize::Quantize(GetTestImage().Scale(480, 360), frame) )
+        return false;
+
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 100;
+
+    wxImageArray frames;
+    for ( long n = 0; n < count; n++ )
+        frames.push_back(frame);
+
+    wxMemoryOutputStream os;
+    wxGIFHandler handler;
+    if ( !handler.SaveAnimation(frames, &os, false, 40) )
+        return false;
+
+    gs_animationData.SetDataLen(0);
+    gs_animationData.AppendData(os.GetOutputStreamBuffer()->GetBufferStart(),
+                                os.GetSize());
+
+    return true;
+}
+
+static void AnimationDone()
+{
+    gs_animationData.Clear();
+}
+
+static bool LoadAnimation(wxGIFDecoder& decoder)
+{
+    wxMemoryInputStream is(gs_animationData.GetData(),
+                           gs_animationData.GetDataLen());
+
+    return decoder.LoadGIF(is) == wxGIF_OK;
+}
+
+// This measures the time needed to start showing the animation.
+BENCHMARK_FUNC_WITH_INIT(LoadAnimatedGIF, AnimationInit, AnimationDone)
+{
+    wxGIFDecoder decoder;
+    wxImage image;
+    return LoadAnimation(decoder) && decoder.ConvertToImage(0, &image);
+}
+
+BENCHMARK_FUNC_WITH_INIT(DecodeAnimatedGIF, AnimationInit, AnimationDone)
+{
+    wxGIFDecoder decoder;
+    if ( !LoadAnimation(decoder) )
+        return false;
+
+    wxImage image;
+    for ( unsigned n = 0; n < decoder.GetFrameCount(); n++ )
+    {
+        if ( !decoder.ConvertToImage(n, &image) )
+            return false;
+    }
+
+    return true;
+}
+
+#endif // wxUSE_GIF && wxUSE_PALETTE
+
+#if wxUSE_THREADS
+
+// This benchmark measures the throughput of transcoding images, i.e. loading,
+// scaling them down and saving them in another format, in the given number of
+// worker threads (by default, as many as there are CPUs): each run transcodes
+// the same number of images, so the results for different numbers of threads
+// can be compared directly.
+static const int TRANSCODE_IMAGES = 16;
+
+static wxMemoryBuffer gs_transcodeData;
+static wxSemaphore *gs_transcodeStart = NULL;
+static wxSemaphore *gs_transcodeDone = NULL;
+static wxAtomicInt gs_transcodeErrors = 0;
+static bool gs_transcodeStop = false;
+
+static bool TranscodeImage()
+{
+    wxMemoryInputStream is(gs_transcodeData.GetData(),
+                           gs_transcodeData.GetDataLen());
+
+    wxImage image;
+    if ( !image.LoadFile(is, wxBITMAP_TYPE_PNG) )
+        return false;
+
+    image.Rescale(image.GetWidth() / 4, image.GetHeight() / 4,
+                  wxIMAGE_QUALITY_HIGH);
+
+    wxMemoryOutputStream os;
+    return image.SaveFile(os, wxBITMAP_TYPE_JPEG);
+}
+
+class TranscodeThread : public wxThread
+{
+public:
+    TranscodeThread() : wxThread(wxTHREAD_JOINABLE) { }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        for ( ;; )
+        {
+            gs_transcodeStart->Wait();
+            if ( gs_transcodeStop )
+                break;
+
+            if ( !TranscodeImage() )
+                wxAtomicInc(gs_transcodeErrors);
+
+            gs_transcodeDone->Post();
+        }
+
+        return 0;
+    }
+};
+
+static wxVector<TranscodeThread *> gs_transcodeThreads;
+
+static void TranscodeDone()
+{
+    gs_transcodeStop = true;
+
+    size_t n;
+    for ( n = 0; n < gs_transcodeThreads.size(); n++ )
+        gs_transcodeStart->Post();
+
+    for ( n = 0; n < gs_transcodeThreads.size(); n++ )
+    {
+        gs_transcodeThreads[n]->Wait();
+        delete gs_transcodeThreads[n];
+    }
+
+    gs_transcodeThreads.clear();
+
+    wxDELETE(gs_transcodeStart);
+    wxDELETE(gs_transcodeDone);
+}
+
+static bool TranscodeInit()
+{
+    // Image handlers must be added before using them from multiple threads.
+    if ( !wxImage::FindHandler(wxBITMAP_TYPE_PNG) )
+        wxImage::AddHandler(new wxPNGHandler);
+    if ( !wxImage::FindHandler(wxBITMAP_TYPE_JPEG) )
+        wxImage::AddHandler(new wxJPEGHandler);
+
+    // Use a reasonably big image, as thumbnails are usually created from.
+    wxImage image = GetTestImage().Scale(1600, 1600);
+    wxMemoryOutputStream os;
+    if ( !image.IsOk() || !image.SaveFile(os, wxBITMAP_TYPE_PNG) )
+        return false;
+
+    gs_transcodeData.SetDataLen(0);
+    gs_transcodeData.AppendData(os.GetOutputStreamBuffer()->GetBufferStart(),
+                                os.GetSize());
+
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = wxThread::GetCPUCount();
+
+    gs_transcodeStart = new wxSemaphore;
+    gs_transcodeDone = new wxSemaphore;
+    gs_transcodeErrors = 0;
+    gs_transcodeStop = false;
+
+    for ( long n = 0; n < count; n++ )
+    {
+        TranscodeThread * const thread = new TranscodeThread;
+        if ( thread->Run() != wxTHREAD_NO_ERROR )
+        {
+            delete thread;
+
+            // don't leave the already started threads waiting forever
+            TranscodeDone();
+            return false;
+        }
+
+        gs_transcodeThreads.push_back(thread);
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_INIT(TranscodeImages, TranscodeInit, TranscodeDone)
+{
+    int n;
+    for ( n = 0; n < TRANSCODE_IMAGES; n++ )
+        gs_transcodeStart->Post();
+
+    for ( n = 0; n < TRANSCODE_IMAGES; n++ )
+        gs_transcodeDone->Wait();
+
+    return gs_transcodeErrors == 0;
+}
+
+#endif // wxUSE_THREADS
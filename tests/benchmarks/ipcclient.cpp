@@ -9,6 +9,7 @@
 
 #include "bench.h"
 
+#include "wx/app.h"
 #include "wx/evtloop.h"
 
 // do this before including wx/ipc.h under Windows to use TCP even there
@@ -22,7 +23,12 @@ namespace
 class PokeAdviseConn : public wxConnection
 {
 public:
-    PokeAdviseConn() { m_gotAdvised = false; }
+    PokeAdviseConn()
+    {
+        m_gotAdvised = false;
+        m_numReplies = 0;
+        m_replyError = false;
+    }
 
     bool GotAdvised()
     {
@@ -57,10 +63,30 @@ public:
         return true;
     }
 
+    // the number of the replies to RequestAsync() received so far and whether
+    // any of them was an error
+    int GetNumReplies() const { return m_numReplies; }
+    bool HadReplyError() const { return m_replyError; }
+
+    virtual void OnRequestReply(wxUint32 WXUNUSED(id),
+                                const wxString& item,
+                                const void *data,
+                                size_t WXUNUSED(size),
+                                wxIPCFormat format)
+    {
+        m_numReplies++;
+
+        if ( !data || item != IPC_BENCHMARK_ITEM || format != wxIPC_TEXT )
+            m_replyError = true;
+    }
+
 private:
     wxString m_item;
     bool m_gotAdvised;
 
+    int m_numReplies;
+    bool m_replyError;
+
     wxDECLARE_NO_COPY_CLASS(PokeAdviseConn);
 };
 
@@ -147,6 +173,14 @@ void ConnDone()
     delete theConnection;
 }
 
+// wait for the next socket event and process it: notice that the socket
+// events are queued and are not processed by Dispatch() itself
+void DispatchIPCEvents(wxEventLoop& loop)
+{
+    loop.Dispatch();
+    wxTheApp->ProcessPendingEvents();
+}
+
 } // anonymous namespace
 
 BENCHMARK_FUNC_WITH_INIT(IPCPokeAdvise, ConnInit, ConnDone)
@@ -161,10 +195,49 @@ BENCHMARK_FUNC_WITH_INIT(IPCPokeAdvise, ConnInit, ConnDone)
         return false;
 
     while ( !conn->GotAdvised() )
-        loop.Dispatch();
+        DispatchIPCEvents(loop);
 
     if ( conn->GetItem() != s )
         return false;
 
     return true;
 }
+
+// The request benchmarks perform this many requests.
+static const int NUM_REQUESTS = 100;
+
+BENCHMARK_FUNC_WITH_INIT(IPCRequest, ConnInit, ConnDone)
+{
+    PokeAdviseConn * const conn = theConnection->Get();
+
+    for ( int n = 0; n < NUM_REQUESTS; n++ )
+    {
+        size_t size;
+        if ( !conn->Request(IPC_BENCHMARK_ITEM, &size) )
+            return false;
+    }
+
+    return true;
+}
+
+// Send all requests without waiting for the replies, this is much faster than
+// waiting for the reply to each of them in turn as IPCRequest does.
+BENCHMARK_FUNC_WITH_INIT(IPCRequestAsync, ConnInit, ConnDone)
+{
+    wxEventLoop loop;
+
+    PokeAdviseConn * const conn = theConnection->Get();
+
+    const int numRepliesOld = conn->GetNumReplies();
+    for ( int n = 0; n < NUM_REQUESTS; n++ )
+    {
+        if ( !conn->RequestAsync(IPC_BENCHMARK_ITEM) )
+            return false;
+    }
+
+    while ( conn->GetPendingRequestsCount() )
+        DispatchIPCEvents(loop);
+
+    return conn->GetNumReplies() - numRepliesOld == NUM_REQUESTS &&
+                !conn->HadReplyError();
+}
@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/listctrl.cpp
+// Purpose:     wxListCtrl benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/app.h"
+#include "wx/listctrl.h"
+#include "wx/generic/listctrl.h"
+
+#include "bench.h"
+
+// Use the generic control explicitly as this is what we want to measure, even
+// under the platforms with a native wxListCtrl implementation.
+static wxGenericListCtrl *gs_listCtrl = NULL;
+
+static bool ListCtrlInit()
+{
+    // the number of items can be given on the command line
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 100000;
+
+    gs_listCtrl = new wxGenericListCtrl(wxTheApp->GetTopWindow(), wxID_ANY,
+                                        wxDefaultPosition, wxDefaultSize,
+                                        wxLC_REPORT);
+    gs_listCtrl->InsertColumn(0, "Label");
+
+    for ( long n = 0; n < count; n++ )
+        gs_listCtrl->InsertItem(n, wxString::Format("Item %ld", n));
+
+    return true;
+}
+
+static void ListCtrlDone()
+{
+    delete gs_listCtrl;
+    gs_listCtrl = NULL;
+}
+
+// Search for different items every time to avoid measuring the best case only.
+static long GetItemToFind()
+{
+    static long s_item = 0;
+
+    s_item = (s_item + 7919) % gs_listCtrl->GetItemCount();
+
+    return s_item;
+}
+
+BENCHMARK_FUNC_WITH_INIT(ListCtrlFindItem, ListCtrlInit, ListCtrlDone)
+{
+    const long item = GetItemToFind();
+    return gs_listCtrl->FindItem(0, wxString::Format("ITEM %ld", item)) == item;
+}
+
+BENCHMARK_FUNC_WITH_INIT(ListCtrlFindItemPartial, ListCtrlInit, ListCtrlDone)
+{
+    // Look for the items having the label with the given prefix after the
+    // given item, as the incremental search does. The result doesn't matter,
+    // nothing is found after the last matching item, but this is fine.
+    gs_listCtrl->FindItem(GetItemToFind(), "item 99", true);
+
+    return true;
+}
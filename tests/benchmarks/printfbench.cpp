@@ -137,3 +137,22 @@ BENCHMARK_FUNC(SystemSnprintf)
     return true;
 }
 
+
+// ----------------------------------------------------------------------------
+// wxString::Format() with a plain and pre-parsed format string
+// ----------------------------------------------------------------------------
+
+#define FORMAT_STRING   "Processing item %d of %s: %s (%.1f%% done)"
+#define FORMAT_ARGS     17, "the list", "item name", 12.5
+
+BENCHMARK_FUNC(StringFormat)
+{
+    return !wxString::Format(FORMAT_STRING, FORMAT_ARGS).empty();
+}
+
+BENCHMARK_FUNC(StringFormatParsed)
+{
+    static const wxParsedFormatString s_format(FORMAT_STRING);
+
+    return !wxString::Format(s_format, FORMAT_ARGS).empty();
+}
@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/socket.cpp
+// Purpose:     wxSocket benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/socket.h"
+
+#include "bench.h"
+
+// The benchmarks here send the given number of small messages (100 by
+// default) over a local TCP connection and then read them back, which is
+// what typically happens when using sockets for IPC.
+static const wxUint32 MSG_SIZE = 32;
+
+static wxSocketServer *gs_server = NULL;
+static wxSocketClient *gs_client = NULL;
+static wxSocketBase *gs_peer = NULL;
+
+static long gs_numMessages = 0;
+
+static void SocketDone()
+{
+    delete gs_peer;
+    gs_peer = NULL;
+
+    delete gs_client;
+    gs_client = NULL;
+
+    delete gs_server;
+    gs_server = NULL;
+}
+
+static bool SocketInit()
+{
+    gs_numMessages = Bench::GetNumericParameter();
+    if ( !gs_numMessages )
+        gs_numMessages = 100;
+
+    wxIPV4address addr;
+    addr.LocalHost();
+    addr.Service(0);
+
+    gs_server = new wxSocketServer(addr, wxSOCKET_BLOCK | wxSOCKET_REUSEADDR);
+    if ( !gs_server->IsOk() || !gs_server->GetLocal(addr) )
+    {
+        SocketDone();
+        return false;
+    }
+
+    gs_client = new wxSocketClient(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+    if ( !gs_client->Connect(addr) )
+    {
+        SocketDone();
+        return false;
+    }
+
+    gs_peer = gs_server->Accept();
+    if ( !gs_peer )
+    {
+        SocketDone();
+        return false;
+    }
+
+    gs_peer->SetFlags(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+
+    return true;
+}
+
+static bool SocketBufferedInit()
+{
+    if ( !SocketInit() )
+        return false;
+
+    gs_client->SetWriteBuffering(true);
+
+    return true;
+}
+
+// Read back all the messages sent by the benchmark.
+static bool ReadMessages()
+{
+    char buf[MSG_SIZE];
+    for ( long n = 0; n < gs_numMessages; n++ )
+    {
+        if ( gs_peer->ReadMsg(buf, sizeof(buf)).LastReadCount() != MSG_SIZE )
+            return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_INIT(SocketWrite, SocketInit, SocketDone)
+{
+    // Send a small header followed by the payload, as many IPC protocols do.
+    const wxUint32 header = MSG_SIZE;
+    char buf[MSG_SIZE] = { 0 };
+    for ( long n = 0; n < gs_numMessages; n++ )
+    {
+        gs_client->Write(&header, sizeof(header));
+        gs_client->Write(buf, sizeof(buf));
+    }
+
+    char received[sizeof(header) + MSG_SIZE];
+    for ( long n = 0; n < gs_numMessages; n++ )
+    {
+        if ( gs_peer->Read(received, sizeof(received)).LastReadCount()
+                != sizeof(received) )
+            return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_INIT(SocketWriteV, SocketInit, SocketDone)
+{
+    const wxUint32 header = MSG_SIZE;
+    char buf[MSG_SIZE] = { 0 };
+
+    wxSocketIOVec vec[2];
+    vec[0] = wxSocketIOVec(&header, sizeof(header));
+    vec[1] = wxSocketIOVec(buf, sizeof(buf));
+
+    for ( long n = 0; n < gs_numMessages; n++ )
+        gs_client->WriteV(vec, WXSIZEOF(vec));
+
+    char received[sizeof(header) + MSG_SIZE];
+    for ( long n = 0; n < gs_numMessages; n++ )
+    {
+        wxUint32 len;
+        vec[0] = wxSocketIOVec(&len, sizeof(len));
+        vec[1] = wxSocketIOVec(received, MSG_SIZE);
+        if ( gs_peer->ReadV(vec, WXSIZEOF(vec)).LastReadCount()
+                != sizeof(len) + MSG_SIZE )
+            return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_INIT(SocketWriteMsg, SocketInit, SocketDone)
+{
+    char buf[MSG_SIZE] = { 0 };
+    for ( long n = 0; n < gs_numMessages; n++ )
+        gs_client->WriteMsg(buf, sizeof(buf));
+
+    return ReadMessages();
+}
+
+BENCHMARK_FUNC_WITH_INIT(SocketWriteMsgBuffered, SocketBufferedInit, SocketDone)
+{
+    char buf[MSG_SIZE] = { 0 };
+    for ( long n = 0; n < gs_numMessages; n++ )
+        gs_client->WriteMsg(buf, sizeof(buf));
+
+    if ( !gs_client->Flush() )
+        return false;
+
+    return ReadMessages();
+}
@@ -58,6 +58,24 @@ const wxString& GetTestAsciiString()
     return testString;
 }
 
+const wxString& GetTestUTF8String()
+{
+    static wxString testString;
+    if ( testString.empty() )
+    {
+        long num = Bench::GetNumericParameter();
+        if ( !num )
+            num = 1;
+
+        // use a longer string by default as the random access to short
+        // strings is not interesting
+        for ( long n = 0; n < 10*num; n++ )
+            testString += wxString::FromUTF8(utf8str);
+    }
+
+    return testString;
+}
+
 } // anonymous namespace
 
 // this is just a baseline
@@ -244,6 +262,23 @@ BENCHMARK_FUNC(ForStringRIter)
     return true;
 }
 
+// Access characters of a long non-ASCII string in a pseudo-random order, which
+// is the worst case for UTF-8 build where indexing is not O(1).
+BENCHMARK_FUNC(StringRandomIndex)
+{
+    const wxString& s = GetTestUTF8String();
+    const size_t len = s.length();
+    size_t pos = 0;
+    for ( size_t n = 0; n < len; n++ )
+    {
+        pos = (pos + 7919) % len;
+        if ( s[pos] == '~' )
+            return false;
+    }
+
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // wxString::Replace()
 // ----------------------------------------------------------------------------
@@ -416,6 +451,36 @@ BENCHMARK_FUNC(CharBuffer)
            wxStrlen(str.wc_str()) == ASCIISTR_LEN;
 }
 
+// Converting the same string object after changing its length is common in
+// the code filling it in a loop, the conversion buffer should be reused here.
+BENCHMARK_FUNC(CharBufferAfterChange)
+{
+    static wxString s_str;
+    static size_t s_len = 0;
+
+    s_len = (s_len + 7) % ASCIISTR_LEN;
+    s_str.assign(asciistr, s_len);
+
+    return wxStrlen(s_str.mb_str()) == s_len &&
+           wxStrlen(s_str.wc_str()) == s_len;
+}
+
+
+// ----------------------------------------------------------------------------
+// assignment of temporary strings
+// ----------------------------------------------------------------------------
+
+BENCHMARK_FUNC(AssignTemporary)
+{
+    static wxString s_str;
+
+    // The contents of the temporary string should be just taken over by our
+    // string without copying it when using C++11.
+    s_str = GetTestAsciiString().Lower();
+
+    return s_str.length() == GetTestAsciiString().length();
+}
+
 
 // ----------------------------------------------------------------------------
 // wxString::operator[] - parse large HTML page
@@ -0,0 +1,80 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/threadpool.cpp
+// Purpose:     wxThreadPool benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/threadpool.h"
+#include "wx/vector.h"
+
+#include "bench.h"
+
+#if wxUSE_THREADS
+
+// Measure the overhead of running small tasks, which is what matters when
+// many of them are queued, e.g. by ParallelFor().
+static const int NUM_TASKS = 100;
+
+static wxAtomicInt gs_counter;
+
+class IncrementTask : public wxThreadPoolTask
+{
+public:
+    IncrementTask() { SetNotifyDone(false); }
+
+    virtual void Run() wxOVERRIDE { wxAtomicInc(gs_counter); }
+};
+
+BENCHMARK_FUNC(ThreadPoolTasks)
+{
+    gs_counter = 0;
+
+    wxTaskGroup group;
+    for ( int n = 0; n < NUM_TASKS; n++ )
+        group.Run(new IncrementTask);
+
+    group.Wait();
+
+    return gs_counter == NUM_TASKS;
+}
+
+// The size of the array processed by ParallelFor benchmark can be given on
+// the command line and is 1000000 by default.
+static wxVector<double> gs_values;
+
+static bool ParallelForInit()
+{
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 1000000;
+
+    gs_values.resize(count);
+
+    return true;
+}
+
+static void ParallelForDone()
+{
+    gs_values.clear();
+}
+
+class SquareRange
+{
+public:
+    void operator()(int from, int to) const
+    {
+        for ( int n = from; n < to; n++ )
+            gs_values[n] = static_cast<double>(n)*n;
+    }
+};
+
+BENCHMARK_FUNC_WITH_INIT(ParallelFor, ParallelForInit, ParallelForDone)
+{
+    wxThreadPool::Get().ParallelFor(0, gs_values.size(), SquareRange(), 1000);
+
+    return gs_values.back() > 0;
+}
+
+#endif // wxUSE_THREADS
@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/timers.cpp
+// Purpose:     wxTimer benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/timer.h"
+#include "wx/vector.h"
+
+#include "bench.h"
+
+// The benchmarks here use the given number of running timers (10000 by
+// default, use "-p 100000" to check how they scale) which never expire, as we
+// only want to measure the cost of managing them.
+static wxVector<wxTimer *> gs_timers;
+
+static int GetTimerInterval(size_t n)
+{
+    // Use different intervals to avoid always adding the timers at the end,
+    // but make them long enough for the timers to never expire.
+    return 1000000 + (n * 7919) % 100000;
+}
+
+static bool TimersInit()
+{
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 10000;
+
+    for ( long n = 0; n < count; n++ )
+    {
+        wxTimer * const timer = new wxTimer;
+        timer->Start(GetTimerInterval(n), wxTIMER_ONE_SHOT);
+        gs_timers.push_back(timer);
+    }
+
+    return true;
+}
+
+static void TimersDone()
+{
+    for ( size_t n = 0; n < gs_timers.size(); n++ )
+    {
+        gs_timers[n]->Stop();
+        delete gs_timers[n];
+    }
+
+    gs_timers.clear();
+}
+
+// This corresponds to the typical use of timers for the timeouts, which are
+// restarted when there is some activity, while many other timers are running.
+BENCHMARK_FUNC_WITH_INIT(TimerRestart, TimersInit, TimersDone)
+{
+    static size_t s_timer = 0;
+
+    s_timer = (s_timer + 7919) % gs_timers.size();
+    gs_timers[s_timer]->Start(GetTimerInterval(s_timer), wxTIMER_ONE_SHOT);
+
+    return true;
+}
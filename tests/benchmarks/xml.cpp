@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/xml.cpp
+// Purpose:     XML parsing benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/mstream.h"
+#include "wx/xml/xml.h"
+
+#include "bench.h"
+
+#if wxUSE_XML
+
+// The document used by the benchmarks contains the given number of records
+// (100 by default) and we look for the value of a single field in all of them.
+static wxCharBuffer gs_xmlData;
+
+static bool XmlInit()
+{
+    long count = Bench::GetNumericParameter();
+    if ( !count )
+        count = 100;
+
+    wxString xml("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<records>\n");
+    for ( long n = 0; n < count; n++ )
+    {
+        xml << wxString::Format
+               (
+                "  <record id=\"%ld\" type=\"item\">\n"
+                "    <name>Record number %ld</name>\n"
+                "    <description>This is a description of the record "
+                "which is long enough to be realistic &amp; has an entity."
+                "</description>\n"
+                "    <price currency=\"EUR\">%ld.99</price>\n"
+                "  </record>\n",
+                n, n, n
+               );
+    }
+    xml << "</records>\n";
+
+    gs_xmlData = xml.utf8_str();
+
+    return true;
+}
+
+static void XmlDone()
+{
+    gs_xmlData.reset();
+}
+
+BENCHMARK_FUNC_WITH_INIT(XmlDocumentLoad, XmlInit, XmlDone)
+{
+    wxMemoryInputStream is(gs_xmlData.data(), gs_xmlData.length());
+
+    wxXmlDocument doc;
+    if ( !doc.Load(is) )
+        return false;
+
+    long total = 0;
+    for ( wxXmlNode *rec = doc.GetRoot()->GetChildren(); rec; rec = rec->GetNext() )
+    {
+        for ( wxXmlNode *n = rec->GetChildren(); n; n = n->GetNext() )
+        {
+            if ( n->GetName() == "price" )
+                total += wxAtol(n->GetNodeContent());
+        }
+    }
+
+    return total > 0;
+}
+
+BENCHMARK_FUNC_WITH_INIT(XmlReaderRead, XmlInit, XmlDone)
+{
+    wxMemoryInputStream is(gs_xmlData.data(), gs_xmlData.length());
+
+    wxXmlReader reader(is);
+
+    long total = 0;
+    bool inPrice = false;
+    for ( ;; )
+    {
+        switch ( reader.Next() )
+        {
+            case wxXML_READER_START_ELEMENT:
+                inPrice = strcmp(reader.GetName(), "price") == 0;
+                break;
+
+            case wxXML_READER_TEXT:
+                if ( inPrice )
+                    total += atol(reader.GetText());
+                break;
+
+            case wxXML_READER_END_ELEMENT:
+                inPrice = false;
+                break;
+
+            case wxXML_READER_END:
+                return reader.IsOk() && total > 0;
+        }
+    }
+}
+
+#endif // wxUSE_XML
@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/zip.cpp
+// Purpose:     wxZipOutputStream and wxZipInputStream benchmarks
+// Author:      wxWidgets team
+// Copyright:   (c) 2018 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/mstream.h"
+#include "wx/zipstrm.h"
+
+#include "bench.h"
+
+// The benchmarks here create or extract an archive with the given number of
+// entries (100 by default) of 64KB each, containing moderately compressible
+// data.
+static const size_t ENTRY_SIZE = 65536;
+
+static long gs_numEntries = 0;
+static wxMemoryBuffer gs_entryData;
+static wxMemoryOutputStream *gs_archive = NULL;
+
+static bool CreateArchive(wxOutputStream& stream, bool parallel)
+{
+    wxZipOutputStream zip(stream);
+    zip.SetParallelCompression(parallel);
+
+    for ( long n = 0; n < gs_numEntries; n++ )
+    {
+        if ( !zip.PutNextEntry(wxString::Format("entry%ld", n)) )
+            return false;
+
+        zip.Write(gs_entryData.GetData(), gs_entryData.GetDataLen());
+    }
+
+    return zip.Close();
+}
+
+static void ZipDone()
+{
+    delete gs_archive;
+    gs_archive = NULL;
+
+    gs_entryData.Clear();
+}
+
+static bool ZipInit()
+{
+    gs_numEntries = Bench::GetNumericParameter();
+    if ( !gs_numEntries )
+        gs_numEntries = 100;
+
+    char *p = static_cast<char *>(gs_entryData.GetWriteBuf(ENTRY_SIZE));
+    unsigned seed = 1;
+    for ( size_t n = 0; n < ENTRY_SIZE; n++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        p[n] = 'a' + (seed >> 16) % 16;
+    }
+    gs_entryData.UngetWriteBuf(ENTRY_SIZE);
+
+    gs_archive = new wxMemoryOutputStream;
+    if ( !CreateArchive(*gs_archive, false) )
+    {
+        ZipDone();
+        return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_INIT(ZipWrite, ZipInit, ZipDone)
+{
+    wxMemoryOutputStream out;
+    return CreateArchive(out, false);
+}
+
+BENCHMARK_FUNC_WITH_INIT(ZipWriteParallel, ZipInit, ZipDone)
+{
+    wxMemoryOutputStream out;
+    return CreateArchive(out, true);
+}
+
+BENCHMARK_FUNC_WITH_INIT(ZipRead, ZipInit, ZipDone)
+{
+    wxMemoryInputStream in(*gs_archive);
+    wxZipInputStream zip(in);
+
+    char buf[ENTRY_SIZE];
+    long count = 0;
+    for ( ;; )
+    {
+        wxZipEntry *entry = zip.GetNextEntry();
+        if ( !entry )
+            break;
+        delete entry;
+
+        if ( zip.Read(buf, sizeof(buf)).LastRead() != ENTRY_SIZE )
+            return false;
+
+        count++;
+    }
+
+    return count == gs_numEntries;
+}
+
+BENCHMARK_FUNC_WITH_INIT(ZipReadEntries, ZipInit, ZipDone)
+{
+    wxMemoryInputStream in(*gs_archive);
+    wxZipInputStream zip(in);
+
+    wxVector<wxZipEntry*> entries;
+    for ( ;; )
+    {
+        wxZipEntry *entry = zip.GetNextEntry();
+        if ( !entry )
+            break;
+        entries.push_back(entry);
+    }
+
+    wxVector<wxMemoryBuffer> data;
+    bool ok = zip.ReadEntries(entries, data);
+
+    for ( size_t n = 0; n < entries.size(); n++ )
+    {
+        if ( data[n].GetDataLen() != ENTRY_SIZE )
+            ok = false;
+        delete entries[n];
+    }
+
+    return ok && entries.size() == static_cast<size_t>(gs_numEntries);
+}
@@ -423,8 +423,18 @@ void FileConfigTestCase::DeleteAll()
     wxStringInputStream sis(testconfig);
     wxFileConfig fc(sis);
 
+    fc.SetPath(wxT("/root/group1"));
     CPPUNIT_ASSERT( fc.DeleteAll() );
     CPPUNIT_ASSERT( Dump(fc).empty() );
+    CPPUNIT_ASSERT_EQUAL( wxString(), fc.GetPath() );
+
+    // the path must be recreated after deleting everything
+    fc.SetPath(wxT("/root/group1"));
+    fc.Write(wxT("entry"), wxT("value"));
+    wxVERIFY_FILECONFIG( wxT("[root]\n")
+                         wxT("[root/group1]\n")
+                         wxT("entry=value\n"),
+                         fc );
 }
 
 void FileConfigTestCase::RenameEntry()
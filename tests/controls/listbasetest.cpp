@@ -352,6 +352,19 @@ void ListBaseTestCase::Find()
     CPPUNIT_ASSERT_EQUAL(2, list->FindItem(-1, "Item 4", true));
     CPPUNIT_ASSERT_EQUAL(2, list->FindItem(1, "Item 40"));
     CPPUNIT_ASSERT_EQUAL(3, list->FindItem(2, "Item 0", true));
+
+    // check that the items can still be found after modifying them
+    list->InsertItem(0, "Item 4");
+    CPPUNIT_ASSERT_EQUAL(0, list->FindItem(-1, "Item 4", true));
+    CPPUNIT_ASSERT_EQUAL(3, list->FindItem(1, "Item 4", true));
+
+    list->SetItemText(3, "Item 2");
+    CPPUNIT_ASSERT_EQUAL(3, list->FindItem(-1, "Item 2"));
+    CPPUNIT_ASSERT_EQUAL(wxNOT_FOUND, list->FindItem(-1, "Item 40"));
+
+    list->DeleteItem(0);
+    CPPUNIT_ASSERT_EQUAL(2, list->FindItem(-1, "Item 2"));
+    CPPUNIT_ASSERT_EQUAL(wxNOT_FOUND, list->FindItem(-1, "Item 4", true));
 }
 
 void ListBaseTestCase::Visible()
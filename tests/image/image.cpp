@@ -24,6 +24,7 @@
 
 #include "wx/anidecod.h" // wxImageArray
 #include "wx/palette.h"
+#include "wx/quantize.h"
 #include "wx/url.h"
 #include "wx/log.h"
 #include "wx/mstream.h"
@@ -79,6 +80,9 @@ private:
         CPPUNIT_TEST( DibPadding );
         CPPUNIT_TEST( BMPFlippingAndRLECompression );
         CPPUNIT_TEST( ScaleCompare );
+        CPPUNIT_TEST( LoadPNGWithMaxSize );
+        CPPUNIT_TEST( QuantizeOrderedDither );
+        CPPUNIT_TEST( QuantizeBigImage );
     CPPUNIT_TEST_SUITE_END();
 
     void LoadFromSocketStream();
@@ -95,6 +99,9 @@ private:
     void DibPadding();
     void BMPFlippingAndRLECompression();
     void ScaleCompare();
+    void LoadPNGWithMaxSize();
+    void QuantizeOrderedDither();
+    void QuantizeBigImage();
 
     wxDECLARE_NO_COPY_CLASS(ImageTestCase);
 };
@@ -1424,6 +1431,232 @@ void ImageTestCase::ScaleCompare()
                                "image/horse_bilinear_300x300.png");
 }
 
+// Returns the image made of the averages of the blocks of scale*scale pixels
+// of the given one, this is what the PNG handler does when loading an image
+// with the maximal size specified.
+static wxImage AverageBlocks(const wxImage& image, int scale)
+{
+    const int width = image.GetWidth() / scale,
+              height = image.GetHeight() / scale;
+
+    wxImage result(width, height, false);
+    for ( int y = 0; y < height; y++ )
+    {
+        for ( int x = 0; x < width; x++ )
+        {
+            unsigned r = 0, g = 0, b = 0;
+            for ( int j = y*scale; j < (y + 1)*scale; j++ )
+            {
+                for ( int i = x*scale; i < (x + 1)*scale; i++ )
+                {
+                    r += image.GetRed(i, j);
+                    g += image.GetGreen(i, j);
+                    b += image.GetBlue(i, j);
+                }
+            }
+
+            const unsigned count = scale*scale;
+            result.SetRGB(x, y, r / count, g / count, b / count);
+        }
+    }
+
+    return result;
+}
+
+void ImageTestCase::LoadPNGWithMaxSize()
+{
+    // non-interlaced PNG images are scaled down while loading them if the
+    // maximal size is given, by averaging the blocks of 2^N*2^N pixels
+    static const char *const FILE_NAME = "image/horse_box_average_300x300.png";
+
+    wxImage original;
+    CPPUNIT_ASSERT( original.LoadFile(FILE_NAME) );
+
+    wxImage image;
+    image.SetOption(wxIMAGE_OPTION_MAX_WIDTH, 100);
+    image.SetOption(wxIMAGE_OPTION_MAX_HEIGHT, 100);
+    CPPUNIT_ASSERT( image.LoadFile(FILE_NAME) );
+
+    CPPUNIT_ASSERT_EQUAL( 75, image.GetWidth() );
+    CPPUNIT_ASSERT_EQUAL( 75, image.GetHeight() );
+    CPPUNIT_ASSERT_EQUAL( 300, image.GetOptionInt(wxIMAGE_OPTION_ORIGINAL_WIDTH) );
+    CPPUNIT_ASSERT_EQUAL( 300, image.GetOptionInt(wxIMAGE_OPTION_ORIGINAL_HEIGHT) );
+    CPPUNIT_ASSERT_EQUAL( AverageBlocks(original, 4), image );
+
+    // only one of the limits can be given too and the incomplete blocks at
+    // the right and bottom edges of the image are dropped
+    const wxImage part = original.GetSubImage(wxRect(0, 0, 299, 150));
+    wxMemoryOutputStream mos;
+    CPPUNIT_ASSERT( part.SaveFile(mos, wxBITMAP_TYPE_PNG) );
+
+    wxMemoryInputStream mis(mos);
+    image = wxImage();
+    image.SetOption(wxIMAGE_OPTION_MAX_HEIGHT, 70);
+    CPPUNIT_ASSERT( image.LoadFile(mis, wxBITMAP_TYPE_PNG) );
+
+    CPPUNIT_ASSERT_EQUAL( 74, image.GetWidth() );
+    CPPUNIT_ASSERT_EQUAL( 37, image.GetHeight() );
+    CPPUNIT_ASSERT_EQUAL( 299, image.GetOptionInt(wxIMAGE_OPTION_ORIGINAL_WIDTH) );
+    CPPUNIT_ASSERT_EQUAL( 150, image.GetOptionInt(wxIMAGE_OPTION_ORIGINAL_HEIGHT) );
+    CPPUNIT_ASSERT_EQUAL( AverageBlocks(part, 4), image );
+
+#if wxUSE_PALETTE
+    // the averaged pixels of a palettized image don't use its palette
+    wxImage paletted;
+    CPPUNIT_ASSERT( paletted.LoadFile("horse.gif") );
+    paletted.SetOption(wxIMAGE_OPTION_PNG_FORMAT, wxPNG_TYPE_PALETTE);
+
+    wxMemoryOutputStream mosPal;
+    CPPUNIT_ASSERT( paletted.SaveFile(mosPal, wxBITMAP_TYPE_PNG) );
+
+    wxMemoryInputStream misPal(mosPal);
+    image = wxImage();
+    image.SetOption(wxIMAGE_OPTION_MAX_WIDTH, paletted.GetWidth() / 2);
+    CPPUNIT_ASSERT( image.LoadFile(misPal, wxBITMAP_TYPE_PNG) );
+
+    CPPUNIT_ASSERT_EQUAL( paletted.GetWidth() / 2, image.GetWidth() );
+    CPPUNIT_ASSERT( !image.HasPalette() );
+#endif // wxUSE_PALETTE
+}
+
+// Quantizes the given RGB data using wxQuantize::DoQuantize() and returns the
+// palette indices of its pixels.
+static wxVector<unsigned char>
+QuantizeData(int width, int height, unsigned char *rgb,
+             unsigned char *palette, int colours, int flags)
+{
+    wxVector<unsigned char> indices(width*height);
+    wxVector<unsigned char *> inRows(height),
+                              outRows(height);
+    for ( int y = 0; y < height; y++ )
+    {
+        inRows[y] = rgb + 3*width*y;
+        outRows[y] = &indices[width*y];
+    }
+
+    wxQuantize::DoQuantize(width, height, &inRows[0], &outRows[0],
+                           palette, colours, flags);
+
+    return indices;
+}
+
+void ImageTestCase::QuantizeOrderedDither()
+{
+    // a band of grey between black and white: when quantizing it to 2 colours
+    // the grey pixels must be represented by a regular pattern of both of
+    // them, repeating every 8 pixels, with the same average colour
+    static const int WIDTH = 64, HEIGHT = 64;
+    static const int GREY = 128, GREY_TOP = 24, GREY_BOTTOM = 32;
+
+    wxVector<unsigned char> rgb(WIDTH*HEIGHT*3);
+    for ( int y = 0; y < HEIGHT; y++ )
+    {
+        const int value = y < GREY_TOP ? 0 : y < GREY_BOTTOM ? GREY : 255;
+        memset(&rgb[3*WIDTH*y], value, 3*WIDTH);
+    }
+
+    unsigned char palette[2*3];
+    const wxVector<unsigned char>
+        indices = QuantizeData(WIDTH, HEIGHT, &rgb[0], palette, 2,
+                               wxQUANTIZE_ORDERED_DITHER);
+
+    int sum = 0;
+    bool usesBoth = false;
+    for ( int y = GREY_TOP; y < GREY_BOTTOM; y++ )
+    {
+        for ( int x = 0; x < WIDTH; x++ )
+        {
+            const unsigned char index = indices[y*WIDTH + x];
+            WX_ASSERT_MESSAGE
+            (
+                ("Pattern differs at (%d, %d)", x, y),
+                index == indices[(GREY_TOP + (y - GREY_TOP) % 8)*WIDTH + x % 8]
+            );
+
+            if ( index != indices[GREY_TOP*WIDTH] )
+                usesBoth = true;
+
+            sum += palette[3*index + 1];
+        }
+    }
+
+    CPPUNIT_ASSERT( usesBoth );
+
+    // the palette colours are not exactly black and white, so the average is
+    // only approximately preserved
+    const int average = sum / (WIDTH*(GREY_BOTTOM - GREY_TOP));
+    WX_ASSERT_MESSAGE
+    (
+        ("Average of dithered grey is %d", average),
+        abs(average - GREY) <= 4
+    );
+}
+
+void ImageTestCase::QuantizeBigImage()
+{
+    // an image big enough to be processed by several threads (if there are
+    // several CPUs) made of copies of a smaller one which is processed by a
+    // single thread: the palettes must be the same and, as ordered dithering
+    // maps each pixel independently, so must be the pixels
+    static const int TILE_SIZE = 256, COPIES = 4;
+    static const int SIZE = TILE_SIZE*COPIES;
+    static const int COLOURS = 16;
+
+    wxVector<unsigned char> tile(TILE_SIZE*TILE_SIZE*3);
+    for ( int y = 0; y < TILE_SIZE; y++ )
+    {
+        for ( int x = 0; x < TILE_SIZE; x++ )
+        {
+            unsigned char * const p = &tile[3*(y*TILE_SIZE + x)];
+            p[0] = x;
+            p[1] = y;
+            p[2] = x*y / TILE_SIZE;
+        }
+    }
+
+    wxVector<unsigned char> big(SIZE*SIZE*3);
+    for ( int y = 0; y < SIZE; y++ )
+    {
+        for ( int x = 0; x < SIZE; x += TILE_SIZE )
+        {
+            memcpy(&big[3*(y*SIZE + x)],
+                   &tile[3*(y % TILE_SIZE)*TILE_SIZE],
+                   3*TILE_SIZE);
+        }
+    }
+
+    for ( int n = 0; n < 2; n++ )
+    {
+        const int flags = n ? wxQUANTIZE_ORDERED_DITHER : 0;
+
+        unsigned char paletteTile[COLOURS*3],
+                      paletteBig[COLOURS*3];
+        const wxVector<unsigned char>
+            indicesTile = QuantizeData(TILE_SIZE, TILE_SIZE, &tile[0],
+                                       paletteTile, COLOURS, flags),
+            indicesBig = QuantizeData(SIZE, SIZE, &big[0],
+                                      paletteBig, COLOURS, flags);
+
+        CPPUNIT_ASSERT( memcmp(paletteTile, paletteBig, sizeof(paletteBig)) == 0 );
+
+        if ( !(flags & wxQUANTIZE_ORDERED_DITHER) )
+            continue;
+
+        for ( int y = 0; y < SIZE; y++ )
+        {
+            for ( int x = 0; x < SIZE; x++ )
+            {
+                WX_ASSERT_MESSAGE
+                (
+                    ("Pixel differs at (%d, %d)", x, y),
+                    indicesBig[y*SIZE + x] ==
+                        indicesTile[(y % TILE_SIZE)*TILE_SIZE + x % TILE_SIZE]
+                );
+            }
+        }
+    }
+}
+
 #endif //wxUSE_IMAGE
 
 
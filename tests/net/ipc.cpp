@@ -25,6 +25,7 @@
 // for all others, include the necessary headers
 #ifndef WX_PRECOMP
     #include "wx/app.h"
+    #include "wx/utils.h"
 #endif
 
 #include "wx/ipc.h"
@@ -38,6 +39,12 @@ namespace
 const char *IPC_TEST_PORT = "4242";
 const char *IPC_TEST_TOPIC = "IPC TEST";
 
+// how long to wait for the other thread in the asynchronous requests test
+const int IPC_TEST_TIMEOUT = 5000;
+
+// posted by RequestAsync() test once it has sent all its requests
+wxSemaphore gs_asyncRequestsSent;
+
 } // anonymous namespace
 
 // ----------------------------------------------------------------------------
@@ -57,10 +64,74 @@ public:
         return data == "Date";
     }
 
+    // reply to the requests with the upper-cased item name, except for the
+    // items starting with "fail"
+    virtual const void *OnRequest(const wxString& topic,
+                                  const wxString& item,
+                                  size_t *size,
+                                  wxIPCFormat WXUNUSED(format))
+    {
+        // don't reply to the asynchronous requests until all of them are
+        // sent: the replies are handled in our thread, so this ensures that
+        // the client connection is never used by both threads at once
+        if ( item == "first" )
+            gs_asyncRequestsSent.WaitTimeout(IPC_TEST_TIMEOUT);
+
+        if ( topic != IPC_TEST_TOPIC || item.StartsWith("fail") )
+        {
+            *size = 0;
+            return NULL;
+        }
+
+        m_reply = item.Upper().utf8_str();
+        *size = m_reply.length() + 1;
+        return m_reply.data();
+    }
+
 private:
+    wxCharBuffer m_reply;
+
     wxDECLARE_NO_COPY_CLASS(IPCTestConnection);
 };
 
+#if wxUSE_SOCKETS_FOR_IPC
+
+// ----------------------------------------------------------------------------
+// test connection class used by IPCTestClient
+// ----------------------------------------------------------------------------
+
+class IPCTestClientConnection : public wxConnection
+{
+public:
+    IPCTestClientConnection() { }
+
+    // the IDs and the data of the replies to the asynchronous requests, in
+    // order of their arrival, the data is empty if the request failed
+    wxVector<wxUint32> m_replyIds;
+    wxArrayString m_replies;
+
+    // posted for each reply, as they're received in the event thread
+    wxSemaphore m_replyReceived;
+
+    virtual void OnRequestReply(wxUint32 id,
+                                const wxString& WXUNUSED(item),
+                                const void *data,
+                                size_t size,
+                                wxIPCFormat format)
+    {
+        m_replyIds.push_back(id);
+        m_replies.push_back(data ? GetTextFromData(data, size, format)
+                                 : wxString());
+
+        m_replyReceived.Post();
+    }
+
+private:
+    wxDECLARE_NO_COPY_CLASS(IPCTestClientConnection);
+};
+
+#endif // wxUSE_SOCKETS_FOR_IPC
+
 // ----------------------------------------------------------------------------
 // event dispatching thread class
 // ----------------------------------------------------------------------------
@@ -181,6 +252,13 @@ public:
         return *m_conn;
     }
 
+#if wxUSE_SOCKETS_FOR_IPC
+    virtual wxConnectionBase *OnMakeConnection()
+    {
+        return new IPCTestClientConnection;
+    }
+#endif // wxUSE_SOCKETS_FOR_IPC
+
 private:
     wxConnectionBase *m_conn;
 
@@ -202,11 +280,13 @@ private:
     CPPUNIT_TEST_SUITE( IPCTestCase );
         CPPUNIT_TEST( Connect );
         CPPUNIT_TEST( Execute );
+        CPPUNIT_TEST( RequestAsync );
         CPPUNIT_TEST( Disconnect );
     CPPUNIT_TEST_SUITE_END();
 
     void Connect();
     void Execute();
+    void RequestAsync();
     void Disconnect();
 
     wxDECLARE_NO_COPY_CLASS(IPCTestCase);
@@ -243,6 +323,46 @@ void IPCTestCase::Execute()
     CPPUNIT_ASSERT( conn.Execute(bytes, WXSIZEOF(bytes)) );
 }
 
+void IPCTestCase::RequestAsync()
+{
+#if wxUSE_SOCKETS_FOR_IPC
+    IPCTestClientConnection&
+        conn = static_cast<IPCTestClientConnection&>(gs_client->GetConn());
+
+    const wxUint32 id1 = conn.RequestAsync("first");
+    const wxUint32 id2 = conn.RequestAsync("fail");
+    const wxUint32 id3 = conn.RequestAsync("third");
+
+    // the replies are processed by the event loop running in the server
+    // thread, let the server send them and wait until all of them arrive
+    gs_asyncRequestsSent.Post();
+    for ( int n = 0; n < 3; n++ )
+    {
+        CPPUNIT_ASSERT_EQUAL( wxSEMA_NO_ERROR,
+                              conn.m_replyReceived.WaitTimeout(IPC_TEST_TIMEOUT) );
+    }
+
+    CPPUNIT_ASSERT( id1 );
+    CPPUNIT_ASSERT( id2 );
+    CPPUNIT_ASSERT( id3 );
+
+    CPPUNIT_ASSERT_EQUAL( 0, conn.GetPendingRequestsCount() );
+
+    CPPUNIT_ASSERT_EQUAL( 3, conn.m_replyIds.size() );
+    CPPUNIT_ASSERT_EQUAL( id1, conn.m_replyIds[0] );
+    CPPUNIT_ASSERT_EQUAL( id2, conn.m_replyIds[1] );
+    CPPUNIT_ASSERT_EQUAL( id3, conn.m_replyIds[2] );
+
+    CPPUNIT_ASSERT_EQUAL( "FIRST", conn.m_replies[0] );
+    CPPUNIT_ASSERT( conn.m_replies[1].empty() );
+    CPPUNIT_ASSERT_EQUAL( "THIRD", conn.m_replies[2] );
+
+    // notice that we can't use the synchronous Request() here: its reply
+    // could be read by the server thread too, as it dispatches the events of
+    // all the sockets, and not only of the server ones
+#endif // wxUSE_SOCKETS_FOR_IPC
+}
+
 void IPCTestCase::Disconnect()
 {
     if ( gs_client )
@@ -54,6 +54,9 @@ private:
 
     CPPUNIT_TEST_SUITE( SocketTestCase );
         ALL_SOCKET_TESTS();
+        CPPUNIT_TEST( ReadWriteV );
+        CPPUNIT_TEST( WriteMsg );
+        CPPUNIT_TEST( WriteBuffering );
         CPPUNIT_TEST( PseudoTest_SetUseEventLoop );
         ALL_SOCKET_TESTS();
     CPPUNIT_TEST_SUITE_END();
@@ -94,6 +97,11 @@ private:
     // disabled
     wxSocketClientPtr GetHTTPSocket(int flags = wxSOCKET_NONE) const;
 
+    // connect the client to a local server and return the server side of the
+    // connection, which must be deleted by the caller, or NULL on error
+    static wxSocketBase *ConnectLocal(wxSocketServer& server,
+                                      wxSocketClient& client);
+
     void PseudoTest_SetUseEventLoop() { ms_useLoop = true; }
 
     void BlockingConnect();
@@ -105,6 +113,10 @@ private:
 
     void UrlTest();
 
+    void ReadWriteV();
+    void WriteMsg();
+    void WriteBuffering();
+
     static bool ms_useLoop;
 
     wxDECLARE_NO_COPY_CLASS(SocketTestCase);
@@ -264,4 +276,124 @@ void SocketTestCase::UrlTest()
     CPPUNIT_ASSERT_EQUAL( wxSTREAM_EOF, in->Read(out).GetLastError() );
 }
 
+wxSocketBase *
+SocketTestCase::ConnectLocal(wxSocketServer& server, wxSocketClient& client)
+{
+    wxIPV4address addr;
+    if ( !server.GetLocal(addr) || !client.Connect(addr) )
+        return NULL;
+
+    wxSocketBase * const peer = server.Accept();
+    if ( peer )
+        peer->SetFlags(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+
+    return peer;
+}
+
+void SocketTestCase::ReadWriteV()
+{
+    wxIPV4address addr;
+    addr.LocalHost();
+    addr.Service(0);
+
+    wxSocketServer server(addr, wxSOCKET_BLOCK | wxSOCKET_REUSEADDR);
+    wxSocketClient client(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+    const std::auto_ptr<wxSocketBase> peer(ConnectLocal(server, client));
+    CPPUNIT_ASSERT( peer.get() );
+
+    wxSocketIOVec vec[3];
+    vec[0] = wxSocketIOVec("Hello", 5);
+    vec[1] = wxSocketIOVec(NULL, 0);
+    vec[2] = wxSocketIOVec(", world", 7);
+
+    client.WriteV(vec, WXSIZEOF(vec));
+    CPPUNIT_ASSERT_EQUAL( wxSOCKET_NOERROR, client.LastError() );
+    CPPUNIT_ASSERT_EQUAL( 12, (int)client.LastWriteCount() );
+
+    // Check that data pushed back with Unread() is returned first.
+    peer->Unread("<", 1);
+
+    char buf1[4] = { 0 },
+         buf2[10] = { 0 };
+    vec[0] = wxSocketIOVec(buf1, 3);
+    vec[1] = wxSocketIOVec(buf2, 10);
+
+    peer->ReadV(vec, 2);
+    CPPUNIT_ASSERT_EQUAL( wxSOCKET_NOERROR, peer->LastError() );
+    CPPUNIT_ASSERT_EQUAL( 13, (int)peer->LastReadCount() );
+    CPPUNIT_ASSERT_EQUAL( std::string("<He"), std::string(buf1) );
+    CPPUNIT_ASSERT_EQUAL( std::string("llo, world"), std::string(buf2, 10) );
+}
+
+void SocketTestCase::WriteMsg()
+{
+    wxIPV4address addr;
+    addr.LocalHost();
+    addr.Service(0);
+
+    wxSocketServer server(addr, wxSOCKET_BLOCK | wxSOCKET_REUSEADDR);
+    wxSocketClient client(wxSOCKET_BLOCK);
+    const std::auto_ptr<wxSocketBase> peer(ConnectLocal(server, client));
+    CPPUNIT_ASSERT( peer.get() );
+
+    client.WriteMsg("Hello", 5);
+    CPPUNIT_ASSERT_EQUAL( 5, (int)client.LastWriteCount() );
+    client.WriteMsg("", 0);
+    client.WriteMsg("0123456789", 10);
+    CPPUNIT_ASSERT( !client.Error() );
+
+    char buf[8];
+    peer->ReadMsg(buf, sizeof(buf));
+    CPPUNIT_ASSERT( !peer->Error() );
+    CPPUNIT_ASSERT_EQUAL( std::string("Hello"),
+                          std::string(buf, peer->LastReadCount()) );
+
+    peer->ReadMsg(buf, sizeof(buf));
+    CPPUNIT_ASSERT( !peer->Error() );
+    CPPUNIT_ASSERT_EQUAL( 0, (int)peer->LastReadCount() );
+
+    // The part of the message not fitting into the buffer is discarded.
+    peer->ReadMsg(buf, sizeof(buf));
+    CPPUNIT_ASSERT( !peer->Error() );
+    CPPUNIT_ASSERT_EQUAL( std::string("01234567"),
+                          std::string(buf, peer->LastReadCount()) );
+}
+
+void SocketTestCase::WriteBuffering()
+{
+    wxIPV4address addr;
+    addr.LocalHost();
+    addr.Service(0);
+
+    wxSocketServer server(addr, wxSOCKET_BLOCK | wxSOCKET_REUSEADDR);
+    wxSocketClient client(wxSOCKET_BLOCK);
+    const std::auto_ptr<wxSocketBase> peer(ConnectLocal(server, client));
+    CPPUNIT_ASSERT( peer.get() );
+
+    client.SetWriteBuffering(true);
+    CPPUNIT_ASSERT( client.IsWriteBuffering() );
+
+    client.Write("abc", 3);
+    CPPUNIT_ASSERT_EQUAL( 3, (int)client.LastWriteCount() );
+
+    // Nothing should have been sent yet.
+    CPPUNIT_ASSERT( !peer->WaitForRead(0, 100) );
+
+    // Write more than fits into the buffer to check that it's sent too.
+    std::string big(100000, 'x');
+    client.Write(big.data(), big.length());
+    CPPUNIT_ASSERT_EQUAL( big.length(), (size_t)client.LastWriteCount() );
+
+    client.Write("def", 3);
+    CPPUNIT_ASSERT( client.Flush() );
+
+    std::string received(3 + big.length() + 3, '\0');
+    peer->Read(&received[0], received.length());
+    CPPUNIT_ASSERT_EQUAL( received.length(), (size_t)peer->LastReadCount() );
+    CPPUNIT_ASSERT_EQUAL( "abc" + big + "def", received );
+
+    client.SetWriteBuffering(false);
+    CPPUNIT_ASSERT( !client.IsWriteBuffering() );
+}
+
 #endif // wxUSE_SOCKETS
@@ -61,6 +61,7 @@ private:
         CPPUNIT_TEST( CStrDataImplicitConversion );
         CPPUNIT_TEST( ExplicitConversion );
         CPPUNIT_TEST( IndexedAccess );
+        CPPUNIT_TEST( IndexAfterChange );
         CPPUNIT_TEST( BeforeAndAfter );
         CPPUNIT_TEST( ScopedBuffers );
     CPPUNIT_TEST_SUITE_END();
@@ -96,6 +97,7 @@ private:
     void CStrDataImplicitConversion();
     void ExplicitConversion();
     void IndexedAccess();
+    void IndexAfterChange();
     void BeforeAndAfter();
     void ScopedBuffers();
 
@@ -1058,6 +1060,66 @@ void StringTestCase::IndexedAccess()
     CPPUNIT_ASSERT_EQUAL( 'r', (char)s[2] );
 }
 
+void StringTestCase::IndexAfterChange()
+{
+#if wxUSE_UNICODE
+    // These tests check that the positions of the characters cached by the
+    // UTF-8 based wxString implementation are updated when it changes, they
+    // use both short strings and long ones, for which an index of positions is
+    // built, and access a character before changing the string to fill the
+    // cache.
+
+    // resize() must not truncate non-ASCII strings when making them longer
+    wxString s(L"\xe9t\xe9");
+    s.resize(5, 'x');
+    CPPUNIT_ASSERT_EQUAL( 5, s.length() );
+    CPPUNIT_ASSERT_EQUAL( L"\xe9t\xe9xx", s );
+    CPPUNIT_ASSERT_EQUAL( 'x', (char)s[4] );
+
+    s.resize(7, L'\xe0');
+    CPPUNIT_ASSERT_EQUAL( L"\xe9t\xe9xx\xe0\xe0", s );
+
+    // this string has 2000 characters but 3000 bytes in UTF-8
+    wxString longStr;
+    for ( int n = 0; n < 1000; n++ )
+        longStr << wxUniChar(0x430 + n % 32) << 'a';
+
+    CPPUNIT_ASSERT( longStr[1998] == wxUniChar(0x430 + 999 % 32) );
+    longStr.resize(2100, 'z');
+    CPPUNIT_ASSERT_EQUAL( 2100, longStr.length() );
+    CPPUNIT_ASSERT( longStr[1998] == wxUniChar(0x430 + 999 % 32) );
+    CPPUNIT_ASSERT_EQUAL( 'z', (char)longStr[2099] );
+
+    // assigning a new value must reset the cached positions
+    s = L"\xe9\xe9\xe9" L"abc";
+    CPPUNIT_ASSERT_EQUAL( 'b', (char)s[4] );
+    s.assign("abcdef");
+    CPPUNIT_ASSERT_EQUAL( 'e', (char)s[4] );
+
+    CPPUNIT_ASSERT_EQUAL( 'a', (char)longStr[1501] );
+    longStr.assign(wxString('b', 2000));
+    CPPUNIT_ASSERT_EQUAL( 'b', (char)longStr[1501] );
+    longStr.assign(wxString(L'\xe9', 2000) + "c");
+    CPPUNIT_ASSERT_EQUAL( 'c', (char)longStr[2000] );
+
+    // and so must changing the string using wxUTF8StringBuffer
+    s = "abcdef";
+    CPPUNIT_ASSERT_EQUAL( 'e', (char)s[4] );
+    wxStrcpy(wxUTF8StringBuffer(s, 10), "\xc3\xa9\xc3\xa9xyz");
+    CPPUNIT_ASSERT_EQUAL( 5, s.length() );
+    CPPUNIT_ASSERT_EQUAL( 'z', (char)s[4] );
+
+    CPPUNIT_ASSERT_EQUAL( L'\xe9', (wchar_t)longStr[1500] );
+    {
+        wxUTF8StringBufferLength buf(longStr, 3000);
+        memset(buf, 'd', 3000);
+        buf.SetLength(3000);
+    }
+    CPPUNIT_ASSERT_EQUAL( 3000, longStr.length() );
+    CPPUNIT_ASSERT_EQUAL( 'd', (char)longStr[2999] );
+#endif // wxUSE_UNICODE
+}
+
 void StringTestCase::BeforeAndAfter()
 {
     // Construct a string with 2 equal signs in it by concatenating its three
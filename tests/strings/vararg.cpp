@@ -46,6 +46,7 @@ private:
         CPPUNIT_TEST( Sscanf );
         CPPUNIT_TEST( RepeatedPrintf );
         CPPUNIT_TEST( ArgsValidation );
+        CPPUNIT_TEST( ParsedFormat );
     CPPUNIT_TEST_SUITE_END();
 
     void StringPrintf();
@@ -60,6 +61,7 @@ private:
     void Sscanf();
     void RepeatedPrintf();
     void ArgsValidation();
+    void ParsedFormat();
 
     wxDECLARE_NO_COPY_CLASS(VarArgTestCase);
 };
@@ -295,3 +297,37 @@ void VarArgTestCase::ArgsValidation()
     wxString::Format("%zu", len);
 #endif
 }
+
+void VarArgTestCase::ParsedFormat()
+{
+    // the same object can be used many times and with different arguments
+    const wxParsedFormatString fmtChar("%s=%d");
+    CPPUNIT_ASSERT_EQUAL( "%s=%d", fmtChar.GetFormat() );
+    CPPUNIT_ASSERT_EQUAL( "x=1", wxString::Format(fmtChar, "x", 1) );
+    CPPUNIT_ASSERT_EQUAL( "yy=-2", wxString::Format(fmtChar, wxString("yy"), -2) );
+
+    wxString s;
+    s.Printf(fmtChar, L"z", 3);
+    CPPUNIT_ASSERT_EQUAL( "z=3", s );
+
+    const wxParsedFormatString fmtWChar(L"%s=%d");
+    CPPUNIT_ASSERT_EQUAL( "x=1", wxString::Format(fmtWChar, "x", 1) );
+
+    const wxParsedFormatString fmtString(wxString("%s=%d"));
+    CPPUNIT_ASSERT_EQUAL( "x=1", wxString::Format(fmtString, "x", 1) );
+
+    // check that positional parameters are handled correctly
+    const wxParsedFormatString fmtPos("%2$s-%1$d-%2$s");
+    CPPUNIT_ASSERT_EQUAL( "ab-17-ab", wxString::Format(fmtPos, 17, "ab") );
+
+    // and so are the escaped percent signs
+    const wxParsedFormatString fmtPercent("%d%% of %zu");
+    CPPUNIT_ASSERT_EQUAL( "50% of 8", wxString::Format(fmtPercent, 50, size_t(8)) );
+
+    const wxParsedFormatString fmtNoArgs("100%%");
+    CPPUNIT_ASSERT_EQUAL( "100%", wxString::Format(fmtNoArgs) );
+
+    // the arguments types are still checked
+    WX_ASSERT_FAILS_WITH_ASSERT( wxString::Format(fmtChar, 1, "x") );
+    WX_ASSERT_FAILS_WITH_ASSERT( wxString::Format(fmtPos, "ab", 17) );
+}
@@ -20,7 +20,9 @@
 #endif // WX_PRECOMP
 
 #include "wx/thread.h"
+#include "wx/threadpool.h"
 #include "wx/utils.h"
+#include "wx/vector.h"
 
 // ----------------------------------------------------------------------------
 // globals
@@ -194,6 +196,76 @@ private:
 
 WX_DEFINE_ARRAY_PTR(wxThread *, ArrayThreads);
 
+// ----------------------------------------------------------------------------
+// wxThreadPool tasks
+// ----------------------------------------------------------------------------
+
+static wxAtomicInt gs_tasksRun;
+
+class MyCountingTask : public wxThreadPoolTask
+{
+public:
+    MyCountingTask() { SetNotifyDone(false); }
+
+    virtual void Run() wxOVERRIDE { wxAtomicInc(gs_tasksRun); }
+};
+
+// Task blocking until the given semaphore is posted.
+class MyBlockingTask : public wxThreadPoolTask
+{
+public:
+    explicit MyBlockingTask(wxSemaphore& sem) : m_sem(sem)
+    {
+        SetNotifyDone(false);
+    }
+
+    virtual void Run() wxOVERRIDE { m_sem.Wait(); }
+
+private:
+    wxSemaphore& m_sem;
+};
+
+// Task queuing more tasks from inside itself, recursively.
+class MySpawningTask : public wxThreadPoolTask
+{
+public:
+    explicit MySpawningTask(int depth) : m_depth(depth)
+    {
+        SetNotifyDone(false);
+    }
+
+    virtual void Run() wxOVERRIDE
+    {
+        wxAtomicInc(gs_tasksRun);
+
+        if ( m_depth > 0 )
+        {
+            wxTaskGroup group;
+            group.Run(new MySpawningTask(m_depth - 1));
+            group.Run(new MySpawningTask(m_depth - 1));
+            group.Wait();
+        }
+    }
+
+private:
+    const int m_depth;
+};
+
+class MySumRange
+{
+public:
+    explicit MySumRange(wxVector<int>& values) : m_values(values) { }
+
+    void operator()(int from, int to) const
+    {
+        for ( int n = from; n < to; n++ )
+            m_values[n] += n;
+    }
+
+private:
+    wxVector<int>& m_values;
+};
+
 // ----------------------------------------------------------------------------
 // test class
 // ----------------------------------------------------------------------------
@@ -212,6 +284,10 @@ private:
         CPPUNIT_TEST( TestThreadRun );
         CPPUNIT_TEST( TestThreadConditions );
         CPPUNIT_TEST( TestSemaphore );
+        CPPUNIT_TEST( TestThreadPool );
+        CPPUNIT_TEST( TestThreadPoolNested );
+        CPPUNIT_TEST( TestTaskGroupCancel );
+        CPPUNIT_TEST( TestParallelFor );
     CPPUNIT_TEST_SUITE_END();
 
     void TestJoinable();
@@ -223,6 +299,11 @@ private:
     void TestThreadRun();
     void TestThreadConditions();
 
+    void TestThreadPool();
+    void TestThreadPoolNested();
+    void TestTaskGroupCancel();
+    void TestParallelFor();
+
     wxDECLARE_NO_COPY_CLASS(MiscThreadTestCase);
 };
 
@@ -419,3 +500,80 @@ void MiscThreadTestCase::TestThreadConditions()
     // give them time to terminate (dirty!)
     wxMilliSleep(500);
 }
+
+void MiscThreadTestCase::TestThreadPool()
+{
+    gs_tasksRun = 0;
+
+    wxThreadPool pool(2);
+    CPPUNIT_ASSERT_EQUAL( 2, pool.GetThreadCount() );
+
+    wxTaskGroup group(pool);
+    for ( int n = 0; n < 100; n++ )
+        group.Run(new MyCountingTask);
+
+    wxThreadPoolTaskPtr task = pool.Queue(new MyCountingTask);
+
+    group.Wait();
+    CPPUNIT_ASSERT( group.IsDone() );
+
+    task->Wait();
+    CPPUNIT_ASSERT( task->IsDone() );
+
+    CPPUNIT_ASSERT_EQUAL( 101, (int)gs_tasksRun );
+}
+
+void MiscThreadTestCase::TestThreadPoolNested()
+{
+    gs_tasksRun = 0;
+
+    // Waiting for the tasks from inside another task must not deadlock, even
+    // when there are more nested tasks than threads in the pool.
+    wxThreadPoolTaskPtr task = wxThreadPool::Get().Queue(new MySpawningTask(6));
+    task->Wait();
+
+    CPPUNIT_ASSERT_EQUAL( (1 << 7) - 1, (int)gs_tasksRun );
+}
+
+void MiscThreadTestCase::TestTaskGroupCancel()
+{
+    gs_tasksRun = 0;
+
+    wxThreadPool pool(1);
+    wxSemaphore sem;
+
+    // Block the only pool thread to ensure that the other tasks don't start.
+    wxThreadPoolTaskPtr blocker = pool.Queue(new MyBlockingTask(sem));
+
+    wxTaskGroup group(pool);
+    for ( int n = 0; n < 10; n++ )
+        group.Run(new MyCountingTask);
+
+    wxThreadPoolTaskPtr task = group.Run(new MyCountingTask);
+
+    group.Cancel();
+    CPPUNIT_ASSERT( group.IsCancelled() );
+    CPPUNIT_ASSERT( task->IsCancelled() );
+
+    sem.Post();
+    blocker->Wait();
+    group.Wait();
+
+    CPPUNIT_ASSERT( task->IsDone() );
+    CPPUNIT_ASSERT_EQUAL( 0, (int)gs_tasksRun );
+}
+
+void MiscThreadTestCase::TestParallelFor()
+{
+    wxVector<int> values;
+    values.resize(10000, 1);
+
+    wxThreadPool::Get().ParallelFor(0, values.size(), MySumRange(values), 7);
+
+    for ( size_t n = 0; n < values.size(); n++ )
+        CPPUNIT_ASSERT_EQUAL( (int)n + 1, values[n] );
+
+    // Empty range must not call the function at all.
+    wxThreadPool::Get().ParallelFor(10, 10, MySumRange(values));
+    CPPUNIT_ASSERT_EQUAL( 11, values[10] );
+}
@@ -84,6 +84,7 @@ private:
         CPPUNIT_TEST( CopyNode );
         CPPUNIT_TEST( CopyDocument );
         CPPUNIT_TEST( Doctype );
+        CPPUNIT_TEST( Reader );
     CPPUNIT_TEST_SUITE_END();
 
     void InsertChild();
@@ -98,6 +99,7 @@ private:
     void CopyNode();
     void CopyDocument();
     void Doctype();
+    void Reader();
 
     wxDECLARE_NO_COPY_CLASS(XmlTestCase);
 };
@@ -612,3 +614,78 @@ void XmlTestCase::Doctype()
     dt = wxXmlDoctype( "root", "O'Reilly (\"editor\")", "Public-ID" );
     CPPUNIT_ASSERT( !dt.IsValid() );
 }
+
+void XmlTestCase::Reader()
+{
+    const char *xmlText =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<root>\n"
+        "  <item id=\"1\" name=\"one\">first &amp; only</item>\n"
+        "  <!-- comment -->\n"
+        "  <empty/>\n"
+        "  <data><![CDATA[<raw>]]></data>\n"
+        "</root>\n"
+    ;
+
+    wxStringInputStream sis(xmlText);
+    wxXmlReader reader(sis);
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END, reader.GetType() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "root", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 0, reader.GetAttributesCount() );
+    CPPUNIT_ASSERT_EQUAL( 2, reader.GetLineNumber() );
+
+    // white space only text is skipped by default
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "item", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 2, reader.GetAttributesCount() );
+    CPPUNIT_ASSERT_EQUAL( "id", reader.GetAttributeName(0) );
+    CPPUNIT_ASSERT_EQUAL( "1", reader.GetAttributeValue(0) );
+    CPPUNIT_ASSERT_EQUAL( "one", reader.GetAttribute("name") );
+    CPPUNIT_ASSERT( !reader.GetAttribute("nonexistent") );
+
+    // the text is returned as a single item even if it contains entities
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_TEXT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "first & only", reader.GetText() );
+    CPPUNIT_ASSERT_EQUAL( 12, reader.GetTextLength() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "item", reader.GetName() );
+
+    // comments are skipped and empty elements have both start and end tags
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "empty", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "empty", reader.GetName() );
+
+    // CDATA sections are returned as text
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_TEXT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "<raw>", reader.GetText() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "root", reader.GetName() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END, reader.Next() );
+    CPPUNIT_ASSERT( reader.IsOk() );
+
+
+    // check that white space is preserved if requested
+    wxStringInputStream sis2("<root> <a/></root>");
+    wxXmlReader reader2(sis2, wxXMLDOC_KEEP_WHITESPACE_NODES);
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader2.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_TEXT, reader2.Next() );
+    CPPUNIT_ASSERT_EQUAL( " ", reader2.GetText() );
+
+
+    // and that errors are detected
+    wxStringInputStream sis3("<root><a></root>");
+    wxXmlReader reader3(sis3);
+    wxLogNull noLog;
+    while ( reader3.Next() != wxXML_READER_END )
+        ;
+    CPPUNIT_ASSERT( !reader3.IsOk() );
+}